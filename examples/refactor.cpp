@@ -4,7 +4,9 @@
 #include <lunar/core/component.hpp>
 #include <lunar/core/gameobject.hpp>
 #include <lunar/core/scene.hpp>
+#include <lunar/core/frame_runner.hpp>
 #include <lunar/core/time.hpp>
+#include <lunar/core/jobs.hpp>
 
 using namespace lunar;
 using namespace lunar::Render;
@@ -34,6 +36,8 @@ class SimpleMovement : public Component_T
 
 int main()
 {
+	Jobs::Initialize();
+
 	RenderContext context = std::make_shared<RenderContext_T>();
 	Window        window  = WindowBuilder()
 		.size(800, 600)
@@ -73,17 +77,23 @@ int main()
 	renderer.program = context->getProgram(GpuDefaultPrograms::eBasicPbrShader);
 
 
+	auto runner = FrameRunner(scene)
+		.useFixedRate(60.0)
+		.useMaxSubsteps(4);
+
 	while (window->isActive())
 	{
 		if (window->getActionDown("toggle_menu"))
 			window->toggleCursorLocked();
 
-		scene.update();
+		Jobs::RunMainThreadJobs();
+		runner.tick();
 
 		context->begin(&window.get());
 		context->clear(1.f, 1.f, 1.f, 1.f);
 
 		context->useCamera(camera);
+		context->useInterpolation(&runner.getInterpolation());
 		context->draw(cubemap);
 		context->draw(scene);
 
@@ -93,6 +103,6 @@ int main()
 		window->pollEvents();
 	}
 
-
+	Jobs::Shutdown();
 	return 1;
 }
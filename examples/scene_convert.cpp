@@ -0,0 +1,38 @@
+#include <lunar/core/scene.hpp>
+#include <lunar/debug/log.hpp>
+#include <cstdio>
+
+using namespace lunar;
+
+/*
+	Converts a JSON scene into the binary .lscene format.
+
+	Usage:
+		scene_convert <input.json> [output.lscene]
+*/
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::fprintf(stderr, "usage: %s <input.json> [output.lscene]\n", argv[0]);
+		return 1;
+	}
+
+	auto input  = Fs::Path(argv[1]);
+	auto output = argc > 2
+		? Fs::Path(argv[2])
+		: Fs::Path(input).replace_extension(".lscene");
+
+	if (!Fs::fileExists(input))
+	{
+		std::fprintf(stderr, "'%s' does not exist\n", input.string().c_str());
+		return 1;
+	}
+
+	if (!SceneWriter().fromJsonFile(input).toFile(output))
+		return 1;
+
+	DEBUG_LOG("Wrote '{}'", output.string());
+	return 0;
+}
@@ -0,0 +1,122 @@
+#include <lunar/core/transform_batch.hpp>
+#include <lunar/debug/log.hpp>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+using namespace lunar;
+
+/*
+	Compares the per-object glm path GameObject_T used before the batch kernel
+	against imp::TransformBatch on a synthetic hierarchy of 100k transforms.
+*/
+
+static constexpr size_t OBJECT_COUNT = 100'000;
+static constexpr int    ITERATIONS   = 50;
+
+struct BenchScene
+{
+	vector<Transform> locals  = {};
+	vector<int32_t>   parents = {};
+};
+
+static BenchScene MakeScene()
+{
+	auto rng   = std::mt19937(1337);
+	auto value = std::uniform_real_distribution<float>(-10.f, 10.f);
+	auto scene = BenchScene();
+
+	scene.locals.resize(OBJECT_COUNT);
+	scene.parents.resize(OBJECT_COUNT);
+
+	// Parents always come before their children, i.e. the order is valid for the batch
+	for (size_t i = 0; i < OBJECT_COUNT; i++)
+	{
+		scene.locals[i].position = { value(rng), value(rng), value(rng) };
+		scene.locals[i].rotation = { value(rng) * 9.f, value(rng) * 9.f, value(rng) * 9.f };
+		scene.locals[i].scale    = glm::vec3(1.f + value(rng) * .01f);
+		scene.parents[i]         = (i % 16 == 0) ? -1 : static_cast<int32_t>(i - 1 - rng() % std::min<size_t>(i, 64));
+	}
+
+	return scene;
+}
+
+static void RunLegacy(const BenchScene& scene, vector<glm::mat4>& world)
+{
+	for (size_t i = 0; i < OBJECT_COUNT; i++)
+	{
+		const auto& transform   = scene.locals[i];
+		auto        scale_mat   = glm::scale(glm::mat4(1.f), transform.scale);
+		auto        translation = glm::translate(glm::mat4(1.f), transform.position);
+		auto        rot_mat     = glm::mat4(glm::quat(glm::radians(transform.rotation)));
+		auto        local       = translation * rot_mat * scale_mat;
+
+		world[i] = scene.parents[i] < 0 ? local : world[scene.parents[i]] * local;
+	}
+}
+
+static void RunBatch(const BenchScene& scene, vector<glm::mat4>& world, imp::TransformBatch& batch, TransformKernel kernel)
+{
+	batch.clear();
+	for (size_t i = 0; i < OBJECT_COUNT; i++)
+		batch.push(scene.locals[i], scene.parents[i] < 0 ? nullptr : &world[scene.parents[i]], &world[i]);
+
+	batch.run(kernel);
+}
+
+template<typename Fn>
+static double Measure(Fn&& fn)
+{
+	fn(); // warm-up
+
+	auto begin = std::chrono::steady_clock::now();
+	for (int i = 0; i < ITERATIONS; i++)
+		fn();
+	auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::milli>(end - begin).count() / ITERATIONS;
+}
+
+static float MaxDifference(const vector<glm::mat4>& a, const vector<glm::mat4>& b)
+{
+	float max_diff = 0.f;
+	for (size_t i = 0; i < a.size(); i++)
+		for (int c = 0; c < 4; c++)
+			for (int r = 0; r < 4; r++)
+				max_diff = std::max(max_diff, std::abs(a[i][c][r] - b[i][c][r]));
+
+	return max_diff;
+}
+
+int main()
+{
+	auto scene     = MakeScene();
+	auto reference = vector<glm::mat4>(OBJECT_COUNT);
+	auto world     = vector<glm::mat4>(OBJECT_COUNT);
+	auto batch     = imp::TransformBatch();
+	batch.reserve(OBJECT_COUNT);
+
+	double legacy_ms = Measure([&]() { RunLegacy(scene, reference); });
+	DEBUG_LOG("{} transforms, per-object glm: {:.3f} ms", OBJECT_COUNT, legacy_ms);
+
+	auto best = GetTransformKernel();
+	for (auto kernel : { TransformKernel::eScalar, TransformKernel::eSSE4, TransformKernel::eAVX2 })
+	{
+		if (kernel > best)
+			break;
+
+		double batch_ms = Measure([&]() { RunBatch(scene, world, batch, kernel); });
+		DEBUG_LOG(
+			"{} transforms, batch ({}): {:.3f} ms ({:.2f}x), max error {}",
+			OBJECT_COUNT, GetTransformKernelName(kernel), batch_ms, legacy_ms / batch_ms, MaxDifference(reference, world)
+		);
+	}
+
+	return 0;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <glm/glm.hpp>
+#include <cfloat>
+
+namespace lunar
+{
+	/* Axis-aligned bounding box. A default-constructed box is empty (min > max). */
+	struct LUNAR_API Aabb
+	{
+		glm::vec3 min = glm::vec3(FLT_MAX);
+		glm::vec3 max = glm::vec3(-FLT_MAX);
+
+		bool      isEmpty()     const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+		glm::vec3 getCenter()   const { return (min + max) * 0.5f; }
+		glm::vec3 getExtents()  const { return (max - min) * 0.5f; }
+
+		float getSurfaceArea() const
+		{
+			glm::vec3 size = max - min;
+			return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		bool contains(const Aabb& other) const
+		{
+			return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z
+				&& max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+		}
+
+		bool overlaps(const Aabb& other) const
+		{
+			return min.x <= other.max.x && max.x >= other.min.x
+				&& min.y <= other.max.y && max.y >= other.min.y
+				&& min.z <= other.max.z && max.z >= other.min.z;
+		}
+
+		/* Squared distance from the point to the box, zero if the point lies inside. */
+		float getDistance2(const glm::vec3& point) const
+		{
+			glm::vec3 delta = glm::max(glm::max(min - point, point - max), glm::vec3(0.f));
+			return glm::dot(delta, delta);
+		}
+
+		void expand(const glm::vec3& point)
+		{
+			min = glm::min(min, point);
+			max = glm::max(max, point);
+		}
+
+		void expand(const Aabb& other)
+		{
+			min = glm::min(min, other.min);
+			max = glm::max(max, other.max);
+		}
+
+		/* Bounds of the box after transforming it, i.e. of its eight transformed corners. */
+		Aabb transformed(const glm::mat4& matrix) const;
+
+		static Aabb Union(const Aabb& a, const Aabb& b)
+		{
+			return Aabb{ glm::min(a.min, b.min), glm::max(a.max, b.max) };
+		}
+
+		bool operator==(const Aabb& other) const = default;
+	};
+
+	/* Bounding sphere. A negative radius marks an empty (or unknown) volume. */
+	struct LUNAR_API BoundingSphere
+	{
+		glm::vec3 center = {};
+		float     radius = -1.f;
+
+		bool isEmpty() const { return radius < 0.f; }
+
+		/* Conservative under non-uniform scale: the radius grows by the largest axis scale. */
+		BoundingSphere transformed(const glm::mat4& matrix) const;
+	};
+
+	struct LUNAR_API Ray
+	{
+		glm::vec3 origin    = {};
+		glm::vec3 direction = { 0.f, 0.f, -1.f }; // does not need to be normalized; distances are in units of its length
+	};
+
+	/*
+		Six inward-facing planes (a, b, c, d with ax + by + cz + d >= 0 inside),
+		ordered left, right, bottom, top, near, far.
+	*/
+	struct LUNAR_API Frustum
+	{
+		glm::vec4 planes[6] = {};
+
+		/* Extracts the planes of a projection * view matrix (Gribb/Hartmann). */
+		static Frustum FromMatrix(const glm::mat4& viewProjection);
+	};
+
+	/* Distance along the ray to the box, or a negative value if the ray misses it. */
+	LUNAR_API float IntersectRay(const Ray& ray, const glm::vec3& inverseDirection, const Aabb& box, float maxDistance);
+}
@@ -3,8 +3,11 @@
 #include <lunar/core/common.hpp>
 #include <lunar/core/handle.hpp>
 #include <lunar/utils/identifiable.hpp>
+#include <lunar/utils/collections.hpp>
 #include <glm/glm.hpp>
 #include <string_view>
+#include <typeinfo>
+#include <cstdint>
 #include <string>
 #include <jni.h>
 
@@ -19,6 +22,8 @@ namespace lunar
 		glm::vec3 scale      = { 1, 1, 1 };
 	};
 
+	struct LUNAR_API ComponentAccess;
+
 	class LUNAR_API Component_T
 	{
 	public:
@@ -28,6 +33,7 @@ namespace lunar
 
 		virtual void     start()                {};
 		virtual void     update()               {};
+		virtual ComponentAccess getAccess() const;
 		const char*      getClassName()  const;
 		const GameObject getGameObject() const;
 		GameObject       getGameObject();
@@ -45,6 +51,76 @@ namespace lunar
 	
 	template<typename T>
 	concept IsComponentType = std::derived_from<T, Component_T> && !std::is_same_v<T, Component_T>;
+
+	/*
+		Every component class is assigned a small, dense identifier the first time it
+		is used. Identifiers are handed out in registration order and never reused,
+		which makes them suitable as indices into per-scene and per-object tables.
+	*/
+	using ComponentTypeId = uint32_t;
+
+	LUNAR_API ComponentTypeId GetComponentTypeId(const std::type_info& type);
+	LUNAR_API size_t          GetComponentTypeCount();
+
+	template<typename T> requires IsComponentType<T>
+	inline ComponentTypeId GetComponentTypeId()
+	{
+		static const ComponentTypeId id = GetComponentTypeId(typeid(T));
+		return id;
+	}
+
+	enum class ComponentAccessFlagBits : uint8_t
+	{
+		eNone           = 0,
+		eThreadSafe     = 1 << 0, // update() may run on a worker thread, concurrently with other objects
+		eReadTransform  = 1 << 1,
+		eWriteTransform = 1 << 2,
+	};
+
+	LUNAR_FLAGS(ComponentAccessFlags, ComponentAccessFlagBits);
+
+	/*
+		Declares what a component class touches inside update(), for the parallel
+		update mode of the scene. Every class implicitly writes its own type.
+		Classes that keep the default (not thread-safe) always run on the main
+		thread, in pool order, exactly as in the sequential mode. Thread-safe
+		classes must not create or destroy objects/components from update().
+
+		World matrices are flushed before every parallel phase and stay frozen
+		while it runs: world-space reads see the state at the start of the phase
+		and setWorldPos() only writes the local transform. A class declaring both
+		readTransform() and writeTransform() has its own instances updated one
+		after the other, since one may read the transform another one writes.
+
+		Usage:
+			ComponentAccess getAccess() const override
+			{
+				return ComponentAccess(ComponentAccessFlagBits::eThreadSafe)
+					.read<Camera>()
+					.writeTransform();
+			}
+	*/
+	struct LUNAR_API ComponentAccess
+	{
+		ComponentAccessFlags    flags  = ComponentAccessFlagBits::eNone;
+		vector<ComponentTypeId> reads  = {};
+		vector<ComponentTypeId> writes = {};
+
+		ComponentAccess() noexcept = default;
+		ComponentAccess(ComponentAccessFlags flags) noexcept : flags(flags) {}
+
+		template<typename... Ts> requires (IsComponentType<Ts> && ...)
+		ComponentAccess& read()           { (reads.push_back(GetComponentTypeId<Ts>()), ...); return *this; }
+
+		template<typename... Ts> requires (IsComponentType<Ts> && ...)
+		ComponentAccess& write()          { (writes.push_back(GetComponentTypeId<Ts>()), ...); return *this; }
+
+		ComponentAccess& readTransform()  { flags = flags | ComponentAccessFlagBits::eReadTransform; return *this; }
+		ComponentAccess& writeTransform() { flags = flags | ComponentAccessFlagBits::eWriteTransform; return *this; }
+
+		bool isThreadSafe()                              const;
+		bool conflictsWith(const ComponentAccess& other) const;
+	};
 }
 
 //namespace Core
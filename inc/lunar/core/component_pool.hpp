@@ -0,0 +1,118 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/core/common.hpp>
+#include <lunar/core/component.hpp>
+#include <lunar/utils/collections.hpp>
+#include <lunar/debug/assert.hpp>
+#include <typeinfo>
+#include <memory>
+#include <mutex>
+#include <span>
+
+namespace lunar
+{
+	namespace imp
+	{
+		/*
+			Fixed-size block allocator used as the backing storage of a single
+			component class. Blocks are carved out of large chunks, so components
+			of the same type end up next to each other in memory instead of being
+			scattered all over the heap by std::make_shared.
+
+			The block size is fixed by the first allocation; every component
+			class gets its own arena, so all requests have the same size anyway.
+		*/
+		class LUNAR_API BlockArena
+		{
+		public:
+			BlockArena(size_t blocksPerChunk = 64) noexcept;
+			~BlockArena() noexcept;
+
+			void* allocate(size_t size, size_t align);
+			void  deallocate(void* block);
+
+			BlockArena(const BlockArena&)            = delete;
+			BlockArena& operator=(const BlockArena&) = delete;
+
+		private:
+			struct FreeBlock { FreeBlock* next; };
+
+			std::mutex    lock           = {};
+			vector<void*> chunks         = {};
+			FreeBlock*    freeList       = nullptr;
+			size_t        blockSize      = 0;
+			size_t        blockAlign     = 0;
+			size_t        blocksPerChunk = 0;
+			size_t        chunkUsed      = 0;
+		};
+
+		/*
+			Standard allocator adapter over a BlockArena. Meant to be used with
+			std::allocate_shared, which places the control block and the component
+			itself inside a single arena block.
+		*/
+		template<typename T>
+		struct PoolAllocator
+		{
+			using value_type = T;
+
+			PoolAllocator(std::shared_ptr<BlockArena> arena) noexcept : arena(std::move(arena)) {}
+
+			template<typename U>
+			PoolAllocator(const PoolAllocator<U>& other) noexcept : arena(other.arena) {}
+
+			T*   allocate(size_t n)           { DEBUG_ASSERT(n == 1); return static_cast<T*>(arena->allocate(sizeof(T), alignof(T))); }
+			void deallocate(T* ptr, size_t)   { arena->deallocate(ptr); }
+
+			template<typename U>
+			bool operator==(const PoolAllocator<U>& other) const { return arena == other.arena; }
+
+			std::shared_ptr<BlockArena> arena;
+		};
+	}
+
+	/*
+		Sparse set holding every component of a single (dynamic) type inside a scene.
+		Components are keyed by the index of the GameObject that owns them; the dense
+		arrays can be walked linearly without any type checks.
+	*/
+	class LUNAR_API ComponentPool
+	{
+	public:
+		static constexpr size_t npos = SIZE_MAX;
+
+		ComponentPool(ComponentTypeId typeId, const std::type_info& type) noexcept;
+		~ComponentPool() noexcept = default;
+
+		ComponentTypeId                getTypeId()                const;
+		const std::type_info&          getType()                  const;
+		size_t                         size()                     const;
+		bool                           contains(size_t object)    const;
+		Component_T*                   get(size_t object);
+		Component                      getRef(size_t object);
+		Component_T*                   at(size_t denseIndex);
+		size_t                         ownerAt(size_t denseIndex) const;
+		std::span<Component_T* const>  getComponents()            const;
+		std::span<const size_t>        getOwners()                const;
+		const ComponentAccess&         getAccess()                const;
+		void                           insert(size_t object, Component component);
+		void                           erase(size_t object);
+
+		template<typename T> requires IsComponentType<T>
+		imp::PoolAllocator<T>          getAllocator()             { return imp::PoolAllocator<T>(arena); }
+
+		ComponentPool(const ComponentPool&)            = delete;
+		ComponentPool& operator=(const ComponentPool&) = delete;
+
+	private:
+		ComponentTypeId                  typeId    = 0;
+		const std::type_info*            type      = nullptr;
+		vector<size_t>                   sparse    = {};
+		vector<size_t>                   owners    = {};
+		vector<Component_T*>             items     = {};
+		vector<Component>                refs      = {};
+		std::shared_ptr<imp::BlockArena> arena     = nullptr;
+		ComponentAccess                  access    = {};
+		bool                             hasAccess = false;
+	};
+}
@@ -1,38 +1,188 @@
 #pragma once
 #include <lunar/api.hpp>
-#include <unordered_map>
-#include <functional>
+#include <lunar/utils/collections.hpp>
+#include <lunar/utils/inplace_function.hpp>
+#include <typeinfo>
 #include <concepts>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace lunar
 {
 	struct LUNAR_API Event {};
 
+	template<typename T>
+	concept EventClass = std::derived_from<T, Event> && std::copy_constructible<T>;
+
+	/*
+		Event classes get dense identifiers on first use, the same way component
+		classes do, so listener tables can be plain arrays.
+	*/
+	using EventTypeId = uint32_t;
+
+	LUNAR_API EventTypeId GetEventTypeId(const std::type_info& type);
+
+	template<typename T> requires EventClass<T>
+	inline EventTypeId GetEventTypeId()
+	{
+		static const EventTypeId id = GetEventTypeId(typeid(T));
+		return id;
+	}
+
 	template<typename T = Event> requires std::derived_from<T, Event>
-	using EventListener_T = std::function<void(T&)>;
+	using EventListener_T = InplaceFunction<void(T&)>;
 
 	using EventListener = EventListener_T<>;
 
+	struct LUNAR_API ListenerId
+	{
+		EventTypeId type   = 0;
+		uint32_t    serial = 0; // 0 is never handed out
+
+		bool operator==(const ListenerId& other) const = default;
+	};
+
+	class LUNAR_API EventBus;
+
 	namespace imp
 	{
-		constexpr size_t MAX_LISTENERS = 10;
+		/* Listeners are stored type-erased; the buffer is large enough to wrap an EventListener_T<T>. */
+		using StoredListener = InplaceFunction<void(Event&), sizeof(EventListener_T<>)>;
 
-		struct LUNAR_API EventListeners
+		struct LUNAR_API EventQueueBase
 		{
-			EventListener callbacks[MAX_LISTENERS] = {};
+			virtual ~EventQueueBase() = default;
+			virtual void dispatchAll(EventBus& bus) = 0;
 		};
+
+		template<typename T>
+		struct EventQueue;
 	}
 
-	class LUNAR_API EventHandler
+	/*
+		Typed event dispatcher. Listeners live in one array per event type and are
+		stored in small inline buffers, so neither adding a capturing lambda nor
+		firing an event touches the heap once the arrays have grown.
+
+		Event types can be switched to deferred mode, in which fireEvent() only
+		queues a copy of the event; queued events are dispatched in a batch by
+		flushEvents(), typically once per frame.
+
+		Usage:
+			ListenerId id = bus.addEventListener<Events::SceneObjectCreated>([](auto& e) { ... });
+			bus.removeEventListener(id);
+
+		Callables passed directly may be up to sizeof(EventListener_T<>) bytes.
+	*/
+	class LUNAR_API EventBus
 	{
 	public:
-		void addEventListener(size_t type, EventListener listener);
-		void removeEventListener(size_t type, EventListener listener);
+		EventBus()  noexcept = default;
+		~EventBus() noexcept = default;
+
+		template<typename T, typename F>
+			requires EventClass<T> && std::invocable<F&, T&> && (!std::same_as<std::decay_t<F>, EventListener_T<T>>)
+		ListenerId addEventListener(F&& listener)
+		{
+			return addListener(GetEventTypeId<T>(), [callback = std::forward<F>(listener)](Event& e) mutable {
+				callback(static_cast<T&>(e));
+			});
+		}
+
+		template<typename T> requires EventClass<T>
+		ListenerId addEventListener(EventListener_T<T> listener)
+		{
+			return addListener(GetEventTypeId<T>(), [callback = std::move(listener)](Event& e) {
+				callback(static_cast<T&>(e));
+			});
+		}
+
+		template<typename T> requires EventClass<T>
+		void fireEvent(T& event)
+		{
+			auto& list = getList(GetEventTypeId<T>());
+			if (list.deferred)
+				queueEvent(T(event));
+			else
+				dispatch(list, event);
+		}
+
+		template<typename T> requires EventClass<T>
+		void queueEvent(T event)
+		{
+			auto& list = getList(GetEventTypeId<T>());
+			if (list.queue == nullptr)
+				list.queue = std::make_unique<imp::EventQueue<T>>();
+
+			static_cast<imp::EventQueue<T>*>(list.queue.get())->events.push_back(std::move(event));
+		}
+
+		template<typename T> requires EventClass<T>
+		void setEventDeferred(bool deferred)
+		{
+			getList(GetEventTypeId<T>()).deferred = deferred;
+		}
+
+		void removeEventListener(ListenerId id);
+		void flushEvents();
+
+		EventBus(const EventBus&)            = delete;
+		EventBus& operator=(const EventBus&) = delete;
+
+	private:
+		struct Listener
+		{
+			ListenerId          id       = {};
+			imp::StoredListener callback = nullptr;
+			bool                removed  = false;
+		};
+
+		struct ListenerList
+		{
+			vector<Listener>                     listeners   = {};
+			vector<Listener>                     added       = {}; // added while dispatching
+			std::unique_ptr<imp::EventQueueBase> queue       = nullptr;
+			uint32_t                             dispatching = 0;
+			bool                                 hasRemoved  = false;
+			bool                                 deferred    = false;
+		};
+
+		ListenerId    addListener(EventTypeId type, imp::StoredListener listener);
+		ListenerList& getList(EventTypeId type);
+		void          dispatch(ListenerList& list, Event& e);
+		void          compact(ListenerList& list);
+
+		// Boxed, so a list being dispatched stays put if a listener registers a new event type
+		vector<std::unique_ptr<ListenerList>> lists      = {};
+		uint32_t                              nextSerial = 1;
 
-	protected:
-		void fireEvent(size_t type, Event& e);
-			
-		std::unordered_map<size_t, imp::EventListeners> listeners;
+		template<typename T>
+		friend struct imp::EventQueue;
 	};
+
+	namespace imp
+	{
+		template<typename T>
+		struct EventQueue : EventQueueBase
+		{
+			vector<T> events  = {};
+			vector<T> pending = {};
+
+			/*
+				Events queued by listeners during the flush end up in the fresh
+				`events` vector and wait for the next flush. Both vectors keep their
+				capacity, so steady-state flushing does not allocate.
+			*/
+			void dispatchAll(EventBus& bus) override
+			{
+				pending.swap(events);
+				auto& list = bus.getList(GetEventTypeId<T>());
+				for (auto& event : pending)
+					bus.dispatch(list, event);
+
+				pending.clear();
+			}
+		};
+	}
 }
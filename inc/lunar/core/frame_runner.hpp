@@ -0,0 +1,113 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/core/gameobject.hpp>
+#include <lunar/utils/collections.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+
+namespace lunar
+{
+	class LUNAR_API Scene;
+
+	namespace imp
+	{
+		/*
+			Local position/rotation/scale and parent of every object at the end of
+			a simulation step, indexed by slot. The object id stored next to each
+			entry tells apart objects that reused the slot of a deleted one.
+
+			Local transforms are stored rather than world matrices: they carry no
+			shear and need no division by the scale, so any world matrix the
+			hierarchy produces (sheared, or flattened by a zero scale) is
+			interpolated exactly by recomposing it from the interpolated locals.
+		*/
+		struct LUNAR_API TransformSnapshot
+		{
+			static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+			vector<glm::vec3> positions = {};
+			vector<glm::quat> rotations = {};
+			vector<glm::vec3> scales    = {};
+			vector<uint32_t>  parents   = {}; // slot of the parent, NO_PARENT for roots
+			vector<size_t>    ids       = {}; // 0 marks an empty slot
+
+			void capture(Scene& scene);
+			bool contains(const GameObject_T& object) const;
+		};
+	}
+
+	/*
+		What the renderer needs to draw a frame in between two simulation steps:
+		the state after the last two steps and how far the display time has
+		advanced from the older towards the newer one.
+	*/
+	class LUNAR_API FrameInterpolation
+	{
+	public:
+		FrameInterpolation()  noexcept = default;
+		~FrameInterpolation() noexcept = default;
+
+		float     getAlpha() const;
+		glm::mat4 getWorldTransform(const GameObject_T& object) const;
+
+	private:
+		bool      interpolate(uint32_t slot, glm::mat4& world) const;
+
+		imp::TransformSnapshot previous = {};
+		imp::TransformSnapshot current  = {};
+		float                  alpha    = 1.f;
+
+		friend class FrameRunner;
+	};
+
+	/*
+		Drives a scene at a fixed simulation rate, independently of the display
+		rate. Every tick adds the elapsed frame time to an accumulator and runs as
+		many fixed steps (Scene::update() followed by Scene::physicsUpdate()) as
+		fit into it; Time::DeltaTime() returns the step length while they run.
+
+		To avoid the spiral of death, where a slow step makes the next frame run
+		even more steps, the frame time is clamped and the step count is capped;
+		simulation time that does not fit is dropped, i.e. the game slows down
+		instead of freezing.
+
+		Usage:
+			auto runner = FrameRunner(scene).useFixedRate(60.0);
+			while (window->isActive())
+			{
+				runner.tick();
+				context->useInterpolation(&runner.getInterpolation());
+				context->draw(scene);
+			}
+	*/
+	class LUNAR_API FrameRunner
+	{
+	public:
+		FrameRunner(Scene& scene) noexcept;
+		~FrameRunner()            noexcept = default;
+
+		FrameRunner&              useFixedRate(double stepsPerSecond);
+		FrameRunner&              useMaxSubsteps(uint32_t count);
+		FrameRunner&              useMaxFrameTime(double seconds);
+		uint32_t                  tick();
+		uint32_t                  advance(double frameTime);
+		double                    getFixedDeltaTime() const;
+		double                    getDroppedTime()    const;
+		uint32_t                  getLastStepCount()  const;
+		const FrameInterpolation& getInterpolation()  const;
+
+	private:
+		void step();
+
+		Scene*             scene          = nullptr;
+		FrameInterpolation interpolation  = {};
+		double             fixedDelta     = 1.0 / 60.0;
+		double             maxFrameTime   = 0.25;
+		double             accumulator    = 0.0;
+		double             droppedTime    = 0.0; // total simulation time skipped by the spiral-of-death guard
+		uint32_t           maxSubsteps    = 8;
+		uint32_t           lastStepCount  = 0;
+		bool               hasSnapshot    = false;
+	};
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <lunar/core/common.hpp>
 #include <lunar/core/component.hpp>
+#include <lunar/core/component_pool.hpp>
 #include <lunar/core/handle.hpp>
 #include <lunar/file/json_file.hpp>
 #include <lunar/utils/identifiable.hpp>
@@ -10,58 +11,228 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <span>
 
 namespace lunar
 {
 	class LUNAR_API GameObject_T
 	{
 	public:
+		/*
+			Allocation-free iteration over the hierarchy. Iterators hold object handles
+			rather than raw pointers, so they stay valid if the scene's object storage
+			grows while iterating.
+		*/
+		class ChildIterator
+		{
+		public:
+			ChildIterator(GameObject current) noexcept : current(current) {}
+
+			GameObject_T&  operator*()  { return current.get(); }
+			GameObject_T*  operator->() { return current.pointer(); }
+			ChildIterator& operator++();
+			bool           operator==(const ChildIterator& other) const;
+
+		private:
+			GameObject current = nullptr;
+		};
+
+		class DescendantIterator
+		{
+		public:
+			DescendantIterator(GameObject root, GameObject current) noexcept : root(root), current(current) {}
+
+			GameObject_T&       operator*()  { return current.get(); }
+			GameObject_T*       operator->() { return current.pointer(); }
+			DescendantIterator& operator++();
+			bool                operator==(const DescendantIterator& other) const;
+
+		private:
+			GameObject root    = nullptr;
+			GameObject current = nullptr;
+		};
+
+		template<typename Iterator>
+		struct Range
+		{
+			Iterator first;
+			Iterator last;
+
+			Iterator begin() const { return first; }
+			Iterator end()   const { return last; }
+		};
+
+		using ChildRange      = Range<ChildIterator>;
+		using DescendantRange = Range<DescendantIterator>;
+
 		GameObject_T(Scene* scene, const std::string_view& name, GameObject parent = nullptr) noexcept;
 		GameObject_T()  noexcept = default;
 		~GameObject_T() noexcept = default;
 
 		void                   update();
 		size_t                 getId()             const;
+		SlotId                 getSlotId()         const;
+		uint64_t               getStableId()       const;
+		void                   setStableId(uint64_t stableId);
 		std::string_view       getName()           const;
 		Scene*                 getScene();
 		GameObject             getParent();
 		std::vector<Component> getComponents();
+		std::span<Component_T* const> getComponentList() const;
 		Component              getComponent(const std::type_info& ty);
+		Component_T*           getComponent(ComponentTypeId typeId) const;
 		const Transform&       getTransform()      const;
 		Transform&             getTransform();
 		glm::vec3              getWorldPos()       const;
 		glm::quat              getWorldRotation()  const;
 		glm::vec3              getWorldScale()     const;
-		glm::mat4              getWorldTransform() const;
+		const glm::mat4&       getWorldTransform() const;
+		glm::mat4              getLocalTransform() const;
 		glm::vec3              getLocalPos()       const;
 		glm::vec3              getLocalRotation()  const;
 		glm::vec3              getLocalScale()     const;
 		void                   setWorldPos(glm::vec3 pos);
 		void                   setLocalPos(glm::vec3 pos);
+		void                   markTransformDirty();
+		void                   markBoundsDirty();
 
 		template<typename T> requires IsComponentType<T>
-		T*                     getComponent() { return static_cast<T*>(getComponent(typeid(T)).get()); }
+		T*                     getComponent() { return static_cast<T*>(getComponent(GetComponentTypeId<T>())); }
 
 		Component_T*           addComponent(Component created);
 		template <typename T, class... _Valty> requires IsComponentType<T>
 		T*                     addComponent(_Valty&&... ctor_values)
 		{
 			DEBUG_ASSERT(getComponent<T>() == nullptr, "There can exist only one component of type <T> on a single gameobject.");
-			auto new_component = std::make_shared<T>(std::forward<_Valty>(ctor_values)...);
+			auto& pool          = getComponentPool(GetComponentTypeId<T>(), typeid(T));
+			auto  new_component = std::allocate_shared<T>(pool.template getAllocator<T>(), std::forward<_Valty>(ctor_values)...);
 			addComponent(new_component);
 			return new_component.get();
 		}
 
-		std::vector<GameObject> getChildren();
+		void                   removeComponent(ComponentTypeId typeId);
+		template<typename T> requires IsComponentType<T>
+		void                   removeComponent() { removeComponent(GetComponentTypeId<T>()); }
+
+		ChildRange              getChildren();
+		DescendantRange         getDescendants();
+		size_t                  getChildCount()      const;
+		uint32_t                getDepth()           const;
+		bool                    isDescendantOf(const GameObject_T* object) const;
+		bool                    isPendingDelete()    const;
+		void                    addTag(const std::string_view& tag);
+		void                    removeTag(const std::string_view& tag);
+		bool                    hasTag(const std::string_view& tag) const;
+		void                    setParent(GameObject newParent);
 		GameObject              createChildObject(const std::string_view& name);
+		GameObject              getHandle();
 	private:
-		size_t      id        = 0;
-		Scene*      scene     = nullptr;
-		GameObject  parent    = nullptr;
-		std::string name      = "GameObject";
-		size_t      nameHash  = 0;
-		Transform   transform = {};
+		void                    linkToParent();
+		void                    unlinkFromParent();
+		void                    refreshDepth();
+		bool                    isTransformStale()      const;
+		void                    updateWorldTransform();
+
+		size_t                  getSlot() const;
+		size_t                  findTag(const std::string_view& tag) const;
+		ComponentPool&          getComponentPool(ComponentTypeId typeId, const std::type_info& ty);
+
+		/*
+			Per-object component index: `components` lists the object's components in
+			insertion order, `componentIndex[typeId]` holds the position of the component
+			of that type inside the list (+1, zero meaning "not present").
+		*/
+		size_t                  id             = 0;
+		SlotId                  slotId         = {};
+		Scene*                  scene          = nullptr;
+		GameObject              parent         = nullptr;
+		std::string             name           = "GameObject";
+		size_t                  nameHash       = 0;
+		uint64_t                stableId       = 0; // identity in the scene file it was loaded from, 0 if none
+		Transform               transform      = {};
+		vector<Component_T*>    components     = {};
+		vector<uint32_t>        componentIndex = {};
+
+		/*
+			Tags the object carries: the tag hash (for a quick reject), the scene
+			bucket holding the tag string, and the position inside that bucket,
+			which makes removal from it O(1).
+		*/
+		struct TagEntry
+		{
+			size_t   hash     = 0;
+			uint32_t bucket   = 0;
+			uint32_t position = 0;
+		};
+
+		vector<TagEntry>        tags           = {};
+
+		/*
+			Intrusive hierarchy links. Children form a doubly linked list owned by
+			the parent, which keeps insertion order and makes (un)linking O(1).
+		*/
+		GameObject              firstChild     = nullptr;
+		GameObject              lastChild      = nullptr;
+		GameObject              prevSibling    = nullptr;
+		GameObject              nextSibling    = nullptr;
+		uint32_t                childCount     = 0;
+		uint32_t                depth          = 0;
+		bool                    pendingDelete  = false;
+
+		/*
+			Cached local-to-world matrix, only written by Scene::updateTransforms().
+			`appliedTransform` is the local transform it was computed from and
+			`transformDirty` forces a recompute (e.g. after reparenting);
+			`worldVersion` is bumped on every recompute so children can tell that
+			their parent moved without having to be visited.
+		*/
+		glm::mat4               worldMatrix      = glm::mat4(1.f);
+		Transform               appliedTransform = {};
+		uint32_t                worldVersion     = 0;
+		uint32_t                parentVersion    = 0;
+		bool                    transformDirty   = true;
+
+		friend class Scene;
 	};
+
+	inline GameObject_T::ChildIterator& GameObject_T::ChildIterator::operator++()
+	{
+		current = current->nextSibling;
+		return *this;
+	}
+
+	inline bool GameObject_T::ChildIterator::operator==(const ChildIterator& other) const
+	{
+		return current == other.current;
+	}
+
+	inline GameObject_T::DescendantIterator& GameObject_T::DescendantIterator::operator++()
+	{
+		if (current->firstChild != nullptr)
+		{
+			current = current->firstChild;
+			return *this;
+		}
+
+		while (current != root)
+		{
+			if (current->nextSibling != nullptr)
+			{
+				current = current->nextSibling;
+				return *this;
+			}
+
+			current = current->parent;
+		}
+
+		current = nullptr;
+		return *this;
+	}
+
+	inline bool GameObject_T::DescendantIterator::operator==(const DescendantIterator& other) const
+	{
+		return current == other.current;
+	}
 }
 
 //namespace Core
@@ -2,6 +2,7 @@
 #include <lunar/api.hpp>
 #include <lunar/utils/collections.hpp>
 #include <lunar/utils/identifiable.hpp>
+#include <lunar/utils/slot_map.hpp>
 #include <concepts>
 
 namespace lunar
@@ -20,32 +21,39 @@ namespace lunar
 	/*
 		A Handle<T> object acts like a normal raw pointer, except it guarantees that it 
 		will not be invalidated in the future due to something out of the API caller's 
-		control (e.g.: vector resizing).
+		control (e.g.: the backing storage growing or elements being removed).
+		Handles to removed elements are detected: valid() turns false, and
+		dereferencing them asserts in debug builds. A handle is nothing but the
+		SlotId; the owning map is found through the tag stored in the id.
 	*/
 	template<typename T>
 	class LUNAR_API Handle
 	{
 	public:
-		Handle(std::nullptr_t)                      noexcept : ref(nullptr), idx(0) {}
-		Handle(vector<T>& collection, size_t index) noexcept : ref(&collection), idx(index) {}
-		Handle(vector<T>& collection, T* object)    noexcept : ref(&collection), idx((size_t)(object - collection.data())) {}
-		Handle()                                    noexcept = default;
-		~Handle()                                   noexcept = default;
-
-		T* operator->()                           { return &(ref->operator[](idx)); }
-		const T* operator->()               const { return &(ref->operator[](idx)); }
-		T& get()                                  { return ref->operator[](idx); }
-		const T& get()                      const { return ref->operator[](idx); }
-		T*       pointer()                        { if (ref == nullptr) return nullptr; return &(get()); }
-		bool     operator==(T* pointer)     const { return pointer == (ref->data() + idx); }
-		bool     operator==(std::nullptr_t) const { return ref == nullptr; }
-
-		template<typename = typename std::enable_if<HasValidCheck<T>>::type>
-		bool     valid()     const { return get().valid(); }
+		Handle(std::nullptr_t)                    noexcept : id() {}
+		Handle(SlotMap<T>& collection, SlotId id) noexcept : id(id)
+		{
+			DEBUG_ASSERT(id.isNull() || SlotMap<T>::FromId(id) == &collection, "Slot id was issued by another map.");
+		}
+		Handle()                                  noexcept = default;
+		~Handle()                                 noexcept = default;
+
+		T*       operator->()                          { return &getMap()[id]; }
+		const T* operator->()                    const { return &getMap()[id]; }
+		T&       get()                                 { return getMap()[id]; }
+		const T& get()                           const { return getMap()[id]; }
+		T*       pointer()                             { SlotMap<T>* map = findMap(); return map != nullptr ? map->find(id) : nullptr; }
+		SlotId   getId()                         const { return id; }
+		bool     valid()                         const { const SlotMap<T>* map = findMap(); return map != nullptr && map->contains(id); }
+		bool     operator==(const T* pointer)    const { const SlotMap<T>* map = findMap(); return map != nullptr && map->find(id) == pointer; }
+		bool     operator==(std::nullptr_t)      const { return id.isNull(); }
+		bool     operator==(const Handle& other) const { return id == other.id; }
 
 	protected:
-		vector<T>* ref = nullptr;
-		size_t     idx = 0;
+		SlotMap<T>* findMap()                    const { return id.isNull() ? nullptr : SlotMap<T>::FromId(id); }
+		SlotMap<T>& getMap()                     const { return *SlotMap<T>::FromId(id); }
+
+		SlotId id = {};
 	};
 
 	/*
@@ -145,21 +153,9 @@ namespace lunar
 	};
 
 	template<typename T>
-	inline Handle<T> make_handle(vector<T>& collection, size_t index)
-	{
-		return Handle<T>(collection, index);
-	}
-
-	template<typename T>
-	inline Handle<T> make_handle(vector<T>& collection)
-	{
-		return Handle<T>(collection, collection.size() - 1);
-	}
-
-	template<typename T>
-	inline Handle<T> make_handle(vector<T>& collection, T* object)
+	inline Handle<T> make_handle(SlotMap<T>& collection, SlotId id)
 	{
-		return Handle<T>(collection, object);
+		return Handle<T>(collection, id);
 	}
 }
 
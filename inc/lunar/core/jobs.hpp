@@ -0,0 +1,90 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/core/handle.hpp>
+#include <lunar/utils/collections.hpp>
+#include <functional>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+
+namespace lunar::Jobs
+{
+	using JobFunction   = std::function<void()>;
+	using RangeFunction = std::function<void(size_t begin, size_t end)>;
+
+	enum class JobAffinity : uint8_t
+	{
+		eAny        = 0,
+		eMainThread = 1, // only ever executed by the thread that called Initialize()
+	};
+
+	struct LUNAR_API JobsConfig
+	{
+		uint32_t workerCount = 0;     // 0 = one worker per hardware thread, minus the main thread
+		bool     pinThreads  = false; // pin worker N to core N + 1, leaving core 0 for the main thread
+	};
+
+	class LUNAR_API Counter_T;
+	LUNAR_SHARED_HANDLE(Counter);
+
+	namespace imp
+	{
+		struct Scheduler;
+
+		struct LUNAR_API Job
+		{
+			JobFunction function = {};
+			JobAffinity affinity = JobAffinity::eAny;
+			Counter     signal   = nullptr;
+		};
+	}
+
+	/*
+		Tracks a group of outstanding jobs. Reaches zero once every job it was
+		handed to has finished; jobs scheduled with the counter as a dependency
+		are released at that point.
+	*/
+	class LUNAR_API Counter_T
+	{
+	public:
+		Counter_T(uint32_t pending = 0) noexcept : pending(pending) {}
+		~Counter_T() noexcept = default;
+
+		bool     isDone()     const { return pending.load(std::memory_order_acquire) == 0; }
+		uint32_t getPending() const { return pending.load(std::memory_order_acquire); }
+
+		Counter_T(const Counter_T&)            = delete;
+		Counter_T& operator=(const Counter_T&) = delete;
+
+	private:
+		void decrement();
+
+		std::atomic<uint32_t> pending       = 0;
+		std::mutex            lock          = {};
+		vector<imp::Job>      continuations = {};
+
+		friend struct imp::Scheduler;
+	};
+
+	/*
+		Starts the worker threads. Jobs may be scheduled without calling this;
+		they then only run inside Wait() / RunMainThreadJobs() on the calling thread.
+	*/
+	LUNAR_API void     Initialize(const JobsConfig& config = {});
+	LUNAR_API void     Shutdown();
+	LUNAR_API uint32_t GetWorkerCount();
+	LUNAR_API int32_t  GetWorkerIndex(); // index of the calling worker thread, -1 on any other thread
+	LUNAR_API bool     IsMainThread();
+
+	LUNAR_API Counter  Schedule(JobFunction job, JobAffinity affinity = JobAffinity::eAny);
+	LUNAR_API Counter  Schedule(JobFunction job, const Counter& dependency, JobAffinity affinity = JobAffinity::eAny);
+	LUNAR_API Counter  ParallelFor(size_t count, size_t grainSize, RangeFunction function);
+
+	/*
+		Blocks until the counter reaches zero. The waiting thread keeps executing
+		other jobs in the meantime (including main-thread jobs when called from the
+		main thread), so waiting from inside a job cannot deadlock the pool.
+	*/
+	LUNAR_API void     Wait(const Counter& counter);
+	LUNAR_API void     RunMainThreadJobs();
+}
@@ -0,0 +1,193 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/core/component.hpp>
+#include <lunar/core/bounds.hpp>
+#include <lunar/utils/collections.hpp>
+#include <lunar/utils/inplace_function.hpp>
+#include <lunar/utils/slot_map.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+
+#include <reactphysics3d/reactphysics3d.h>
+
+namespace lunar
+{
+	enum class RigidBodyType : uint8_t
+	{
+		eStatic    = 0,
+		eKinematic = 1, // moved by its transform, pushes dynamic bodies around
+		eDynamic   = 2, // moved by the solver
+	};
+
+	enum class ColliderShape : uint8_t
+	{
+		eBox     = 0,
+		eSphere  = 1,
+		eCapsule = 2,
+	};
+
+	class LUNAR_API Collider;
+
+	namespace imp
+	{
+		/*
+			Deferred call into rp3d. With a physics thread, the world may only be
+			touched while the thread is idle, so gameplay calls are queued and run
+			at the next sync point (see Scene::physicsUpdate()).
+		*/
+		using PhysicsCommand = InplaceFunction<void(), 48>;
+
+		/* State of one body after a step, as published to the main thread. */
+		struct PhysicsPose
+		{
+			SlotId           object   = {};
+			rp3d::RigidBody* body     = nullptr;
+			glm::vec3        position = {};
+			glm::quat        rotation = {};
+			glm::vec3        velocity = {};
+			uint32_t         sync     = 0; // sync point at which the step started
+			bool             dynamic  = false;
+			bool             sleeping = false;
+		};
+
+		/* Fills in everything but `object`, `body`, `sync` and `dynamic` from the rp3d bodies. */
+		void CapturePhysicsPoses(vector<PhysicsPose>& poses);
+
+		/*
+			Steps a physics world on a dedicated thread, one step at a time:
+			kick() hands over a step and returns immediately, wait() blocks until
+			the step (and the pose capture that follows it) is done.
+		*/
+		class LUNAR_API PhysicsThread
+		{
+		public:
+			PhysicsThread(rp3d::PhysicsWorld* world) noexcept;
+			~PhysicsThread() noexcept;
+
+			void kick(double dt, vector<PhysicsPose>* poses);
+			void wait();
+
+			PhysicsThread(const PhysicsThread&)            = delete;
+			PhysicsThread& operator=(const PhysicsThread&) = delete;
+
+		private:
+			void run();
+
+			rp3d::PhysicsWorld*     world  = nullptr;
+			vector<PhysicsPose>*    poses  = nullptr;
+			double                  dt     = 0.0;
+			bool                    busy   = false;
+			bool                    stop   = false;
+			std::mutex              lock   = {};
+			std::condition_variable kicked = {};
+			std::condition_variable done   = {};
+			std::thread             thread = {};
+		};
+	}
+
+	/*
+		Connects a GameObject to a ReactPhysics3D body. The rp3d body is created
+		lazily by Scene::physicsUpdate(), which also keeps it in sync with the
+		object's transform: transforms edited since the last step are pushed to
+		rp3d before the world is stepped, and the poses of awake dynamic bodies
+		are copied back afterwards. Both passes walk the RigidBody pool linearly;
+		bodies that neither moved nor were moved cost a single compare.
+
+		Velocity and sleep state are cached at every sync, and forces, impulses
+		and velocity changes are queued until the next sync, so all members can
+		be used from gameplay code whether or not a physics thread is stepping. Before the
+		rp3d body exists, forces and torques are accumulated and impulses go
+		into the cached velocity; all of them reach the body's first step.
+	*/
+	class LUNAR_API RigidBody : public Component_T
+	{
+	public:
+		RigidBody(RigidBodyType type = RigidBodyType::eDynamic) noexcept;
+		~RigidBody() noexcept;
+
+		RigidBodyType getType()  const;
+		void          setType(RigidBodyType type);
+		bool          isSleeping() const;
+		glm::vec3     getLinearVelocity() const;
+		void          setLinearVelocity(const glm::vec3& velocity);
+		void          applyForce(const glm::vec3& force);
+		void          applyTorque(const glm::vec3& torque);
+		void          applyImpulse(const glm::vec3& impulse);
+
+		RigidBody(const RigidBody&)            = delete;
+		RigidBody& operator=(const RigidBody&) = delete;
+
+	public:
+		float mass          = 1.f;
+		bool  enableGravity = true;
+
+	private:
+		void  create(rp3d::PhysicsWorld* world);
+		void  submit(imp::PhysicsCommand command);
+
+		glm::vec3           velocity       = {}; // as of the last sync, or as set since
+		glm::vec3           pendingForce   = {}; // applied before the body was created
+		glm::vec3           pendingTorque  = {};
+		bool                sleeping       = false;
+		RigidBodyType       type           = RigidBodyType::eDynamic;
+		rp3d::RigidBody*    body           = nullptr;
+		rp3d::PhysicsWorld* world          = nullptr;
+		Collider*           collider       = nullptr;
+		glm::vec3           syncedPosition = {}; // world pose as of the last sync with rp3d
+		glm::quat           syncedRotation = {};
+		uint32_t            pushedSync     = 0; // last sync point that pushed a pose to rp3d
+
+		friend class Scene;
+		friend class Collider;
+	};
+
+	/*
+		Collision shape of the RigidBody on the same object (objects that only
+		block others use a static body). Shape parameters are read when the
+		collider gets attached, i.e. on the first physics step after both
+		components exist. The kind of shape is fixed at construction, since the
+		rp3d shape is destroyed according to it.
+	*/
+	class LUNAR_API Collider : public Component_T
+	{
+	public:
+		Collider(ColliderShape shape = ColliderShape::eBox) noexcept;
+		~Collider() noexcept;
+
+		static Collider Box(const glm::vec3& halfExtents);
+		static Collider Sphere(float radius);
+		static Collider Capsule(float radius, float height);
+
+		ColliderShape getShape() const;
+
+		/* Bounds of the shape in the object's local space. */
+		Aabb getLocalBounds() const;
+
+		Collider(Collider&& other)      noexcept;
+		Collider(const Collider&)            = delete;
+		Collider& operator=(const Collider&) = delete;
+
+	public:
+		glm::vec3     halfExtents = { 0.5f, 0.5f, 0.5f };
+		float         radius      = 0.5f;
+		float         height      = 1.f;
+		glm::vec3     offset      = { 0.f, 0.f, 0.f };
+		bool          isTrigger   = false;
+
+	private:
+		void  attach(RigidBody& owner);
+		void  release();
+
+		ColliderShape         shape      = ColliderShape::eBox;
+		RigidBody*            owner      = nullptr;
+		rp3d::Collider*       rpCollider = nullptr;
+		rp3d::CollisionShape* rpShape    = nullptr;
+
+		friend class Scene;
+		friend class RigidBody;
+	};
+}
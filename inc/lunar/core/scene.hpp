@@ -1,13 +1,29 @@
 #pragma once
 #include <lunar/core/gameobject.hpp>
+#include <lunar/core/component_pool.hpp>
+#include <lunar/core/scene_view.hpp>
+#include <lunar/core/transform_batch.hpp>
+#include <lunar/core/scene_command_buffer.hpp>
+#include <lunar/core/scene_file.hpp>
+#include <lunar/core/scene_stream.hpp>
 #include <lunar/core/scene_event.hpp>
+#include <lunar/core/physics.hpp>
+#include <lunar/core/spatial_index.hpp>
 #include <lunar/core/event.hpp>
 #include <lunar/render/common.hpp>
 #include <lunar/file/json_file.hpp>
+#include <lunar/file/file_tracker.hpp>
 #include <lunar/utils/collections.hpp>
+#include <lunar/utils/stopwatch.hpp>
 #include <nlohmann/json.hpp>
 #include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <set>
 #include <functional>
+#include <mutex>
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -20,8 +36,74 @@ namespace lunar
 {
 	using PhysicsWorld = reactphysics3d::PhysicsWorld;
 
+	namespace imp
+	{
+		/* For keys that already are hashes (e.g. fnv1a_hash results). */
+		struct PrecomputedHash
+		{
+			size_t operator()(size_t hash) const { return hash; }
+		};
+
+		template<typename T>
+		using HashMap      = std::unordered_map<size_t, T, PrecomputedHash>;
+
+		template<typename T>
+		using HashMultiMap = std::unordered_multimap<size_t, T, PrecomputedHash>;
+
+		/*
+			Orders object ids by the name of the object they refer to (ties broken
+			by id), so the prefix index needs no copy of the names. Transparent, so
+			the set can be searched with a plain string_view.
+		*/
+		struct PrefixOrder
+		{
+			using is_transparent = void;
+
+			const SlotMap<GameObject_T>* objects = nullptr;
+
+			std::string_view nameOf(SlotId id) const { return (*objects)[id].getName(); }
+
+			bool operator()(SlotId a, SlotId b) const
+			{
+				if (int order = nameOf(a).compare(nameOf(b)); order != 0)
+					return order < 0;
+
+				return a.index != b.index ? a.index < b.index : a.generation < b.generation;
+			}
+
+			bool operator()(SlotId a, std::string_view b) const { return nameOf(a) < b; }
+			bool operator()(std::string_view a, SlotId b) const { return a < nameOf(b); }
+		};
+
+		using PrefixIndex  = std::set<SlotId, PrefixOrder>;
+
+		/* Objects carrying one tag; the tag string is stored once, here. */
+		struct TagBucket
+		{
+			std::string    name    = {};
+			vector<SlotId> objects = {};
+		};
+
+		/* Spatial index state of the object living in one slot. */
+		struct SpatialEntry
+		{
+			size_t   object  = 0;     // id of the object the proxy belongs to, 0 if none
+			uint32_t proxy   = DynamicAabbTree::NULL_NODE;
+			bool     tracked = false; // the object has a mesh renderer or a collider
+			bool     queued  = false; // listed in the scene's spatial queue
+			Aabb     local   = {};
+			Aabb     world   = {};    // tight world bounds, the tree only keeps fat ones
+		};
+	}
+
+	enum class SceneUpdateMode : uint8_t
+	{
+		eSequential = 0,
+		eParallel   = 1, // thread-safe component classes are updated on the job system
+	};
+
 	class LUNAR_API Camera;
-	class LUNAR_API Scene : public EventHandler
+	class LUNAR_API Scene : public EventBus
 	{
 	public:
 		Scene(const std::string_view& name) noexcept;
@@ -33,7 +115,13 @@ namespace lunar
 		~Scene()                            noexcept;
 
 		void                    update();
+		void                    updateTransforms();
+		SceneUpdateMode         getUpdateMode() const;
+		void                    setUpdateMode(SceneUpdateMode mode);
 		void                    physicsUpdate(double dt);
+		void                    usePhysicsThread(bool enabled = true);
+		bool                    isPhysicsThreaded() const;
+		void                    waitForPhysics();
 		PhysicsWorld*           getPhysicsWorld();
 		Camera*                 getMainCamera();
 		void                    setMainCamera(Camera* camera);
@@ -41,20 +129,38 @@ namespace lunar
 		void                    setName(const std::string_view& name);
 		GameObject              getGameObject(size_t number);
 		GameObject              getGameObject(const std::string_view& name);
-		std::span<GameObject_T> getGameObjects();
-		std::span<Component>    getComponents();
+		vector<GameObject>      getGameObjectsByPrefix(const std::string_view& prefix);
+		vector<GameObject>      getGameObjectsWithTag(const std::string_view& tag);
+		SlotMap<GameObject_T>&  getGameObjects();
+		void                    reserveGameObjects(size_t count);
+		ComponentPool&          getComponentPool(const std::type_info& type);
+		ComponentPool&          getComponentPool(ComponentTypeId typeId, const std::type_info& type);
+		ComponentPool*          findComponentPool(const std::type_info& type);
+		ComponentPool*          findComponentPool(ComponentTypeId typeId);
+		std::span<ComponentPool* const> getComponentPools();
+		vector<Component>       getComponents();
 		GameObject              createGameObject
 		(
 			const std::string_view& name,
 			GameObject_T*           parent = nullptr
 		);
+		void                    deleteGameObject(GameObject object);
+		void                    flushDeletions();
+		SceneCommandBuffer&     getCommandBuffer();
+		void                    playbackCommandBuffers();
+
+		void                    updateSpatialIndex();
+		const DynamicAabbTree&  getSpatialIndex() const;
+		vector<GameObject>      queryOverlap(const Aabb& box);
+		void                    queryOverlaps(std::span<const Aabb> boxes, vector<vector<GameObject>>& results);
+		vector<GameObject>      queryFrustum(const Frustum& frustum);
+		vector<GameObject>      queryNearest(const glm::vec3& point, size_t count);
+		GameObject              raycast(const Ray& ray, float maxDistance = FLT_MAX, float* hitDistance = nullptr);
 
-		template<SceneEventClass T>
-		inline void             addEventListener(EventListener_T<T> listener)
+		template<typename... Ts> requires (IsComponentType<Ts> && ...)
+		inline SceneView<Ts...> view()
 		{
-			EventHandler::addEventListener((size_t)T::getType(), [listener](Event& e) {
-				listener(static_cast<T&>(e)); 
-			});
+			return SceneView<Ts...>(objects, { findComponentPool(GetComponentTypeId<Ts>())... });
 		}
 
 		/*
@@ -69,24 +175,150 @@ namespace lunar
 		Scene& operator=(Scene&&)      = delete;
 
 	private:
-		std::string          name         = "Scene";
-		vector<GameObject_T> objects      = {};
-		vector<Component>    components   = {};
-		rp3d::PhysicsWorld*  physicsWorld = nullptr;
-		Camera*              mainCamera   = nullptr;
+		/*
+			Below this object count the plain hierarchy walk wins; above it, world
+			matrices are recomputed through the SIMD batch kernel instead.
+		*/
+		static constexpr size_t TRANSFORM_BATCH_THRESHOLD = 1024;
+		static constexpr size_t PARALLEL_UPDATE_GRAIN     = 64;
 
-		inline void fireEvent(SceneEventType type, Event& e)
-		{
-			EventHandler::fireEvent((size_t)type, e);
-		}
+		void                    updateSequential();
+		void                    updateParallel();
+		void                    runUpdatePhase();
+		void                    updateComponent(ComponentPool* pool, size_t index);
+		void                    markForDeletion(GameObject_T& object);
+		void                    updateTransformsBatched();
+		void                    pushPhysicsTransforms(vector<imp::PhysicsPose>& poses);
+		void                    pullPhysicsTransforms(const vector<imp::PhysicsPose>& poses);
+		void                    queuePhysicsCommand(imp::PhysicsCommand command);
+		void                    runPhysicsCommands();
+		GameObject              createObject(const std::string_view& name, GameObject_T* parent, bool queueCreatedEvent);
+		void                    playback(SceneCommandBuffer& buffer);
+		void                    addToNameIndex(const GameObject_T& object);
+		void                    removeFromNameIndex(const GameObject_T& object);
+		void                    addToTagIndex(GameObject_T& object, const std::string_view& tag);
+		void                    removeFromTagIndex(GameObject_T& object, size_t tagEntry);
+		uint32_t                findTagBucket(const std::string_view& tag, size_t hash) const;
+		void                    updateSpatialEntry(uint32_t slot);
+		void                    queueSpatialEntry(uint32_t slot);
+		void                    queueSpatialEntry(uint32_t slot, ComponentTypeId typeId);
+		void                    queueTrackedSpatialEntry(uint32_t slot);
+		GameObject              getSpatialObject(uint32_t slot);
+
+		std::string                            name            = "Scene";
+		SlotMap<GameObject_T>                  objects         = {};
+		vector<std::unique_ptr<ComponentPool>> pools           = {}; // indexed by type id, null if unused
+		vector<ComponentPool*>                 poolList        = {}; // existing pools only, in type id order
+		rp3d::PhysicsWorld*                    physicsWorld    = nullptr;
+		Camera*                                mainCamera      = nullptr;
+		SceneUpdateMode                        updateMode      = SceneUpdateMode::eSequential;
+		vector<ComponentPool*>                 updatePhase     = {};
+		vector<SlotId>                         deletionQueue   = {};
+
+		/*
+			Physics thread state. The thread steps the world one tick ahead of the
+			scene: it writes body poses into one buffer while the main thread
+			applies those of the previous step from the other one. Commands are
+			queued by gameplay code from any thread and run on the main thread at
+			the next sync point, with or without a physics thread.
+		*/
+		std::unique_ptr<imp::PhysicsThread>    physicsThread   = nullptr;
+		vector<imp::PhysicsPose>               physicsPoses[2] = {};
+		uint32_t                               physicsBuffer   = 0;
+		uint32_t                               physicsSync     = 0; // number of physicsUpdate() calls so far
+		std::mutex                             physicsLock     = {};
+		vector<imp::PhysicsCommand>            physicsCommands = {};
+		vector<imp::PhysicsCommand>            physicsRunning  = {};
+
+		/*
+			One command buffer slot for the main thread and one per job worker,
+			owned by the scene, so nothing outlives it on the recording threads.
+		*/
+		vector<std::unique_ptr<SceneCommandBuffer>> commandBuffers    = {};
+		SceneCommandBuffer                          playbackBuffer    = {};
+		vector<SlotId>                              playbackResolved  = {};
+
+		/*
+			Lookup indices. Names are keyed by the fnv1a hash every object already
+			carries (matches are verified against the actual name, so collisions are
+			harmless); the ordered index serves prefix queries. Tags are looked up
+			by hash too, every candidate bucket being checked against its string.
+		*/
+		imp::HashMultiMap<SlotId>              nameIndex       = {};
+		imp::PrefixIndex                       prefixIndex     = imp::PrefixIndex(imp::PrefixOrder{ &objects });
+		imp::HashMultiMap<uint32_t>            tagLookup       = {};
+		vector<imp::TagBucket>                 tagBuckets      = {};
+		imp::TransformBatch                    transformBatch  = {};
+		vector<uint32_t>                       transformOrder  = {};
+		vector<uint32_t>                       depthOffsets    = {};
+
+		/*
+			Bounds of every object with a mesh or a collider, indexed by slot and
+			refreshed at the end of update() (see updateSpatialIndex()). Only the
+			slots listed in the queue are looked at.
+		*/
+		DynamicAabbTree                        spatialIndex    = {};
+		vector<imp::SpatialEntry>              spatialEntries  = {};
+		vector<uint32_t>                       spatialQueue    = {};
 
 		friend class GameObject_T;
+		friend class RigidBody;
+		friend class Collider;
+	};
+
+	class LUNAR_API MeshRenderer;
+
+	/*
+		Progress of a scene load, shared between the loader's jobs and whoever
+		draws the loading screen. Totals grow while the file is being parsed, so
+		the ratio is only an estimate until parsing has finished. A load that
+		failed is done as well; `error` is only written before `finished` is set.
+	*/
+	struct LUNAR_API SceneLoadProgress
+	{
+		std::atomic<uint32_t> objectsTotal   = 0;
+		std::atomic<uint32_t> objectsLoaded  = 0;
+		std::atomic<uint32_t> meshesTotal    = 0;
+		std::atomic<uint32_t> meshesDecoded  = 0;
+		std::atomic<uint32_t> meshesUploaded = 0;
+		std::atomic<bool>     finished       = false;
+		std::string           error          = {};
+
+		float              getRatio()  const;
+		bool               isDone()    const { return finished.load(std::memory_order_acquire); }
+		bool               hasFailed() const { return isDone() && !error.empty(); }
+		const std::string& getError()  const { return error; }
 	};
 
+	/*
+		With async loading enabled, loadJsonFile() returns immediately. The file is
+		parsed on the job system (one job per top-level object subtree), objects
+		are created on the main thread, mesh files are decoded on worker threads and
+		uploaded on the main thread, one main-thread job per mesh. Progress is
+		made by Jobs::RunMainThreadJobs(), so the caller can keep rendering until
+		getProgress()->isDone(). Visitors must be thread-safe in this mode (they
+		run concurrently on worker threads), and the destination scene must
+		outlive the load. Parse errors do not escape the workers: no object is
+		created and the error is reported through getProgress()->getError().
+
+		Streaming splits a level into named regions, each stored in its own JSON
+		scene file. streamRegion() parses the file and decodes its meshes on the
+		job system; updateStreaming(), called once per frame on the main thread,
+		then uploads meshes and instantiates top-level subtrees ("chunks") until
+		the frame's time budget is spent. A chunk is always committed whole, so a
+		subtree never shows up half-built. unloadRegion() deletes the region's
+		objects, again within the budget.
+
+		watchFile() loads a JSON or binary scene file and reloads it whenever the
+		tracker reports a change. Objects are matched across versions by stable
+		id (an explicit "id" field, or parent + name + sibling index), and only
+		what differs from the previously applied version is created, updated or
+		deleted. The loader must outlive the tracker's callback.
+	*/
 	struct LUNAR_API SceneLoader
 	{
-		using ComponentJsonParser = std::function<Component(const nlohmann::json&)>;
-		using VisitorDict         = std::unordered_map<std::string, ComponentJsonParser>;
+		using ComponentJsonParser = imp::ComponentJsonParser;
+		using VisitorDict         = imp::ComponentVisitorDict;
 
 
 		SceneLoader()  noexcept = default;
@@ -94,9 +326,25 @@ namespace lunar
 	
 		SceneLoader& destination(Scene& scene);
 		SceneLoader& useRenderContext(Render::RenderContext context);
+		SceneLoader& useAsyncLoading(bool enabled = true);
 		SceneLoader& loadJsonFile(const Fs::Path& path);
+		SceneLoader& loadBinaryFile(const Fs::Path& path);
+
+		std::shared_ptr<const SceneLoadProgress> getProgress() const;
+
+		SceneLoader&    useStreamingBudget(double milliseconds);
+		SceneLoader&    streamRegion(const std::string& region, const Fs::Path& path);
+		SceneLoader&    unloadRegion(const std::string& region);
+		void            updateStreaming();
+		RegionResidency getResidency(const std::string& region) const;
+		StreamingStatus getStreamingStatus() const;
+
+		SceneLoader&    watchFile(const Fs::Path& path, Fs::FileTracker& tracker);
+		SceneLoader&    reloadFile(const Fs::Path& path);
 
 		SceneLoader& useCoreSerializers();
+
+		/* With async loading or streaming, parsers are called from several worker threads at once. */
 		SceneLoader& useCustomClassSerializer(
 			const std::string& componentName,
 			const ComponentJsonParser& parser
@@ -116,12 +364,111 @@ namespace lunar
 		void parseTransform(GameObject object, const nlohmann::json& json);
 		void parseGameObject(
 			const nlohmann::json& json, 
-			GameObject            parent = nullptr
+			GameObject            parent,
+			imp::SiblingNames&    siblings
 		);
+		void loadJsonFileAsync(const Fs::Path& path);
+		void collectMeshRenderer(const Component& component);
+		void loadPendingMeshes();
+		bool streamRegionStep(imp::StreamRegion& region, const Utils::Stopwatch& frameTime, bool& didWork);
+		void instantiateChunk(imp::StreamRegion& region, imp::LoadedSubtree& chunk);
+		void applyReload(imp::TrackedScene& tracked, const imp::SceneSnapshot& snapshot);
+
+		VisitorDict                           visitors      = {};
+		Scene*                                result        = nullptr;
+		Render::RenderContext                 renderContext = nullptr;
+		bool                                  asyncLoading  = false;
+		std::shared_ptr<SceneLoadProgress>    progress      = nullptr;
+		vector<std::shared_ptr<MeshRenderer>> pendingMeshes = {};
+
+		/*
+			Hot reload state: what every watched file produced the last time it was
+			applied, and all meshes the loader has uploaded so far, keyed by path,
+			so reloads never upload a mesh twice.
+		*/
+		std::unordered_map<std::string, std::shared_ptr<imp::TrackedScene>> trackedFiles = {};
+		std::unordered_map<std::string, Render::GpuMesh>                    meshCache    = {};
+
+		/*
+			`regions` maps names to the current state of every known region, while
+			`streamQueue` lists, in request order, the regions that still have
+			loading or unloading work left.
+		*/
+		std::unordered_map<std::string, std::shared_ptr<imp::StreamRegion>> regions         = {};
+		vector<std::shared_ptr<imp::StreamRegion>>                          streamQueue     = {};
+		StreamingStatus                                                     streamingStatus = {};
+		double                                                              streamingBudget = 2.0; // milliseconds per updateStreaming()
+	};
+
+	/*
+		Produces binary (.lscene) scene files, either from a live scene or from a
+		JSON scene file (the JSON -> binary converter). Components of a live scene
+		are only written if a serializer was registered for their class; JSON
+		components are carried over as they are.
+
+		Usage:
+			SceneWriter()
+				.fromJsonFile(Fs::fromData("main_scene.json"))
+				.toFile(Fs::fromData("main_scene.lscene"));
+	*/
+	struct LUNAR_API SceneWriter
+	{
+		using ComponentJsonWriter = std::function<nlohmann::json(const Component_T&)>;
+
+		SceneWriter()  noexcept = default;
+		~SceneWriter() noexcept = default;
+
+		SceneWriter& fromScene(Scene& scene);
+		SceneWriter& fromJsonFile(const Fs::Path& path);
+		bool         toFile(const Fs::Path& path) const;
+
+		SceneWriter& useCoreSerializers();
+		SceneWriter& useCustomClassSerializer(
+			const std::string&         componentName,
+			ComponentTypeId            typeId,
+			const ComponentJsonWriter& writer
+		);
+
+		template<typename T> requires IsComponentType<T>
+		SceneWriter& useCustomClassSerializer(const std::string& componentName, std::function<nlohmann::json(const T&)> writer)
+		{
+			return useCustomClassSerializer(componentName, GetComponentTypeId<T>(), [writer = std::move(writer)](const Component_T& component) {
+				return writer(static_cast<const T&>(component));
+			});
+		}
+
+		template<typename T> requires IsComponentType<T> && IsJsonSerializable<T>
+		SceneWriter& useClassSerializer(const std::string& componentName)
+		{
+			return useCustomClassSerializer<T>(componentName, [](const T& component) { return T::Serialize(component); });
+		}
+
+	private:
+		struct ClassWriter
+		{
+			std::string         name   = {};
+			ComponentJsonWriter writer = nullptr;
+		};
+
+		void                 clear();
+		void                 writeGameObject(GameObject_T& object, uint32_t parent, imp::SiblingNames& siblings);
+		void                 parseGameObject(const nlohmann::json& json, uint32_t parent, imp::SiblingNames& siblings);
+		void                 addComponent(const std::string_view& type, const nlohmann::json& json);
+		uint32_t             addType(const std::string_view& type);
+		imp::SceneFileString addString(const std::string_view& string);
 
-		VisitorDict           visitors      = {};
-		Scene*                result        = nullptr;
-		Render::RenderContext renderContext = nullptr;
+		std::unordered_map<ComponentTypeId, ClassWriter>      classWriters = {};
+		std::unordered_map<std::string, imp::SceneFileString> stringLookup = {};
+		std::unordered_map<std::string, uint32_t>             typeLookup   = {};
+		imp::SceneFileString                                  sceneName    = {};
+		vector<imp::SceneFileObject>                          objects      = {};
+		vector<Transform>                                     transforms   = {};
+		vector<imp::SceneFileComponent>                       components   = {};
+		vector<imp::SceneFileString>                          types        = {};
+		std::string                                           strings      = {};
+		vector<uint8_t>                                       blobs        = {};
+		std::unordered_set<uint64_t>                          reservedIds  = {}; // ids carried by the scene's objects
+		std::unordered_set<uint64_t>                          writtenIds   = {};
 	};
 }
 
@@ -0,0 +1,101 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/core/common.hpp>
+#include <lunar/core/component.hpp>
+#include <lunar/core/gameobject.hpp>
+#include <lunar/utils/collections.hpp>
+#include <lunar/utils/inplace_function.hpp>
+#include <string_view>
+#include <cstdint>
+#include <string>
+
+namespace lunar
+{
+	/*
+		Records structural scene changes so they can be issued from worker threads.
+		A buffer is owned by a single thread (see Scene::getCommandBuffer()), so
+		recording needs no synchronization at all; the scene plays every buffer
+		back at its sync point in Scene::update().
+
+		Objects created through a buffer do not exist until playback; the returned
+		ObjectRef can still be used as a parent or as the target of later commands
+		recorded into the same buffer.
+	*/
+	class LUNAR_API SceneCommandBuffer
+	{
+	public:
+		static constexpr size_t MAX_COMPONENT_ARGS_SIZE = 96;
+
+		struct LUNAR_API ObjectRef
+		{
+			static constexpr uint32_t NOT_PENDING = UINT32_MAX;
+
+			SlotId   id      = {};
+			uint32_t pending = NOT_PENDING; // ordinal of the create command within its buffer
+
+			ObjectRef()                  noexcept = default;
+			ObjectRef(std::nullptr_t)    noexcept {}
+			ObjectRef(GameObject object) noexcept : id(object == nullptr ? SlotId() : object.getId()) {}
+
+			bool isPending() const { return pending != NOT_PENDING; }
+			bool isNull()    const { return !isPending() && id.isNull(); }
+		};
+
+		SceneCommandBuffer()  noexcept = default;
+		~SceneCommandBuffer() noexcept = default;
+
+		ObjectRef createGameObject(const std::string_view& name, ObjectRef parent = nullptr);
+		void      deleteGameObject(ObjectRef object);
+		void      setTransform(ObjectRef object, const Transform& transform);
+		size_t    size()        const;
+		bool      empty()       const;
+		void      clear();
+
+		/*
+			The constructor arguments are stored inline with the command, and may
+			take up to MAX_COMPONENT_ARGS_SIZE bytes together (checked at compile
+			time). Pass larger data through a pointer or a shared_ptr.
+		*/
+		template<typename T, typename... Args> requires IsComponentType<T>
+		void addComponent(ObjectRef object, Args... args)
+		{
+			pushCommand(CommandType::eAddComponent, object, nullptr, static_cast<uint32_t>(factories.size()));
+			factories.emplace_back([... args = std::move(args)](GameObject_T& target) mutable {
+				target.addComponent<T>(std::move(args)...);
+			});
+		}
+
+		SceneCommandBuffer(const SceneCommandBuffer&)            = delete;
+		SceneCommandBuffer& operator=(const SceneCommandBuffer&) = delete;
+
+	private:
+		using ComponentFactory = InplaceFunction<void(GameObject_T&), MAX_COMPONENT_ARGS_SIZE>;
+
+		enum class CommandType : uint8_t
+		{
+			eCreate,
+			eDelete,
+			eAddComponent,
+			eSetTransform,
+		};
+
+		struct Command
+		{
+			CommandType type    = CommandType::eCreate;
+			ObjectRef   target  = {};
+			ObjectRef   parent  = {};
+			uint32_t    payload = 0; // index into names / transforms / factories
+		};
+
+		void pushCommand(CommandType type, ObjectRef target, ObjectRef parent, uint32_t payload);
+		void swap(SceneCommandBuffer& other) noexcept;
+
+		vector<Command>          commands    = {};
+		vector<std::string>      names       = {};
+		vector<Transform>        transforms  = {};
+		vector<ComponentFactory> factories   = {};
+		uint32_t                 createCount = 0;
+
+		friend class Scene;
+	};
+}
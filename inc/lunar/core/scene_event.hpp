@@ -6,13 +6,6 @@
 
 namespace lunar
 {
-	enum class LUNAR_API SceneEventType : size_t
-	{
-		eUnknown       = 0,
-		eObjectDeleted = 1,
-		eObjectCreated = 2,
-	};
-
 	struct LUNAR_API SceneEvent : Event 
 	{
 	public:
@@ -21,13 +14,6 @@ namespace lunar
 		Scene& scene;
 	};
 
-	template<typename T>
-	concept SceneEventClass = 
-		std::derived_from<T, SceneEvent> &&
-		requires(T t) {
-			{ T::getType() } -> std::same_as<SceneEventType>;
-		};
-
 	namespace Events
 	{
 		/*
@@ -44,8 +30,6 @@ namespace lunar
 			{}
 
 			GameObject gameObject;
-
-			static SceneEventType getType() { return SceneEventType::eObjectDeleted; }
 		};
 
 		/*
@@ -62,8 +46,6 @@ namespace lunar
 			{}
 
 			GameObject gameObject;
-
-			static SceneEventType getType() { return SceneEventType::eObjectCreated; }
 		};
 	}
 
@@ -0,0 +1,165 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/core/component.hpp>
+#include <nlohmann/json.hpp>
+#include <unordered_map>
+#include <string_view>
+#include <type_traits>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <bit>
+
+namespace lunar::imp
+{
+	/*
+		Layout of a binary scene (.lscene) file. Everything is little-endian and
+		each section starts at a 16-byte aligned offset, so a memory-mapped file
+		can be read in place:
+
+			SceneFileHeader
+			SceneFileObject[objectCount]        hierarchy in pre-order, parents first
+			Transform[objectCount]              local transforms, copied verbatim
+			SceneFileComponent[componentCount]  grouped by owner, see firstComponent
+			SceneFileString[typeCount]          distinct component type names
+			char[stringsSize]                   string table (not null-terminated)
+			byte[blobsSize]                     component data, MessagePack encoded
+
+		A component blob holds the same object its JSON counterpart would, so the
+		serializers registered with SceneLoader read both formats. Files are read
+		and written in place, so only little-endian hosts support the format.
+	*/
+	constexpr uint32_t SCENE_FILE_MAGIC     = 0x4E43534C; // "LSCN"
+	constexpr uint32_t SCENE_FILE_VERSION   = 2;
+	constexpr uint32_t SCENE_FILE_NO_PARENT = UINT32_MAX;
+	constexpr size_t   SCENE_FILE_ALIGNMENT = 16;
+
+	struct SceneFileString
+	{
+		uint32_t offset = 0;
+		uint32_t size   = 0;
+	};
+
+	struct SceneFileHeader
+	{
+		uint32_t        magic            = SCENE_FILE_MAGIC;
+		uint32_t        version          = SCENE_FILE_VERSION;
+		uint32_t        objectCount      = 0;
+		uint32_t        componentCount   = 0;
+		uint32_t        typeCount        = 0;
+		SceneFileString sceneName        = {};
+		uint32_t        reserved         = 0;
+		uint64_t        objectsOffset    = 0;
+		uint64_t        transformsOffset = 0;
+		uint64_t        componentsOffset = 0;
+		uint64_t        typesOffset      = 0;
+		uint64_t        stringsOffset    = 0;
+		uint64_t        stringsSize      = 0;
+		uint64_t        blobsOffset      = 0;
+		uint64_t        blobsSize        = 0;
+	};
+
+	struct SceneFileObject
+	{
+		uint64_t        stableId       = 0; // see MakeStableId()
+		SceneFileString name           = {};
+		uint32_t        parent         = SCENE_FILE_NO_PARENT; // index of an earlier object
+		uint32_t        firstComponent = 0;
+		uint32_t        componentCount = 0;
+		uint32_t        reserved       = 0;
+	};
+
+	struct SceneFileComponent
+	{
+		uint32_t type       = 0; // index into the type table
+		uint32_t blobSize   = 0;
+		uint64_t blobOffset = 0; // relative to the blob section
+	};
+
+	/*
+		Identity of an object across reloads of its scene file. Objects with an
+		explicit "id" field keep it wherever they are moved in the hierarchy;
+		all others are identified by their parent, their name and how many
+		siblings of the same name precede them.
+	*/
+	inline uint64_t MakeStableId(const std::string_view& explicitId)
+	{
+		return fnv1a_hash(explicitId) ^ 0x9e3779b97f4a7c15;
+	}
+
+	inline uint64_t MakeStableId(uint64_t parent, const std::string_view& name, uint32_t occurrence)
+	{
+		uint64_t hash = fnv1a_hash(name);
+		hash ^= parent     + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+		hash ^= occurrence + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+
+	/* Occurrence count of every name among the siblings visited so far. */
+	using SiblingNames = std::unordered_map<std::string, uint32_t>;
+
+	uint64_t GetStableId(const nlohmann::json& json, uint64_t parent, SiblingNames& siblings);
+
+	/* Reads a vector stored either as [x, y, z] or as { "x": .., "y": .., "z": .. }. */
+	void LoadVec3f(const nlohmann::json& json, const std::string_view& name, glm::vec3& out);
+
+	/*
+		Typed view over a mapped scene file. Every section is bounds-checked up
+		front so the loader can index the arrays directly.
+	*/
+	struct SceneFileView
+	{
+		const SceneFileHeader*    header     = nullptr;
+		const SceneFileObject*    objects    = nullptr;
+		const std::byte*          transforms = nullptr;
+		const SceneFileComponent* components = nullptr;
+		const SceneFileString*    types      = nullptr;
+		const char*               strings    = nullptr;
+		const uint8_t*            blobs      = nullptr;
+
+		bool open(std::span<const std::byte> bytes)
+		{
+			// Sections are reinterpreted in place: the host has to share the file's byte order and alignment
+			if constexpr (std::endian::native != std::endian::little)
+				return false;
+
+			if (bytes.size() < sizeof(SceneFileHeader) || reinterpret_cast<uintptr_t>(bytes.data()) % SCENE_FILE_ALIGNMENT != 0)
+				return false;
+
+			header = reinterpret_cast<const SceneFileHeader*>(bytes.data());
+			if (header->magic != SCENE_FILE_MAGIC || header->version != SCENE_FILE_VERSION)
+				return false;
+
+			auto section = [&](uint64_t offset, uint64_t size) -> const std::byte* {
+				bool valid = offset % SCENE_FILE_ALIGNMENT == 0 && offset <= bytes.size() && size <= bytes.size() - offset;
+				return valid ? bytes.data() + offset : nullptr;
+			};
+
+			objects    = reinterpret_cast<const SceneFileObject*>(section(header->objectsOffset, uint64_t(header->objectCount) * sizeof(SceneFileObject)));
+			transforms = section(header->transformsOffset, uint64_t(header->objectCount) * sizeof(Transform));
+			components = reinterpret_cast<const SceneFileComponent*>(section(header->componentsOffset, uint64_t(header->componentCount) * sizeof(SceneFileComponent)));
+			types      = reinterpret_cast<const SceneFileString*>(section(header->typesOffset, uint64_t(header->typeCount) * sizeof(SceneFileString)));
+			strings    = reinterpret_cast<const char*>(section(header->stringsOffset, header->stringsSize));
+			blobs      = reinterpret_cast<const uint8_t*>(section(header->blobsOffset, header->blobsSize));
+
+			return objects && transforms && components && types && strings && blobs && isString(header->sceneName);
+		}
+
+		bool isString(SceneFileString string) const
+		{
+			return uint64_t(string.offset) + string.size <= header->stringsSize;
+		}
+
+		std::string_view getString(SceneFileString string) const
+		{
+			return std::string_view(strings + string.offset, string.size);
+		}
+	};
+
+	static_assert(sizeof(Transform) == 9 * sizeof(float) && std::is_trivially_copyable_v<Transform>,
+		"Transform is stored verbatim in scene files, its layout must not change.");
+	static_assert(sizeof(SceneFileHeader) == 96);
+	static_assert(sizeof(SceneFileObject) == 32);
+	static_assert(sizeof(SceneFileComponent) == 16);
+}
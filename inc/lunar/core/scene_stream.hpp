@@ -0,0 +1,76 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/core/common.hpp>
+#include <lunar/core/component.hpp>
+#include <lunar/utils/collections.hpp>
+#include <nlohmann/json.hpp>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+#include <atomic>
+#include <string>
+
+namespace lunar
+{
+	enum class RegionResidency : uint8_t
+	{
+		eNotLoaded = 0,
+		eQueued    = 1, // file is being parsed and its meshes decoded on worker threads
+		eLoading   = 2, // meshes are being uploaded / objects instantiated
+		eResident  = 3,
+		eUnloading = 4,
+	};
+
+	/* Work the streamer still has to do, as of the end of the last update. */
+	struct LUNAR_API StreamingStatus
+	{
+		uint32_t regionsQueued    = 0;
+		uint32_t regionsResident  = 0;
+		uint32_t meshesRemaining  = 0;
+		uint32_t chunksRemaining  = 0;
+		uint32_t objectsRemaining = 0;
+		uint32_t objectsToUnload  = 0;
+		double   lastUpdateMs     = 0.0;
+
+		bool isIdle() const { return regionsQueued == 0 && meshesRemaining == 0 && chunksRemaining == 0 && objectsToUnload == 0; }
+	};
+
+	namespace imp
+	{
+		using ComponentJsonParser  = std::function<Component(const nlohmann::json&)>;
+		using ComponentVisitorDict = std::unordered_map<std::string, ComponentJsonParser>;
+
+		/* An object parsed off the main thread, waiting to be created in the scene. */
+		struct LoadedObject
+		{
+			std::string       name       = {};
+			uint64_t          stableId   = 0;
+			uint32_t          parent     = UINT32_MAX; // index within the same subtree
+			Transform         transform  = {};
+			vector<Component> components = {};
+		};
+
+		using LoadedSubtree = vector<LoadedObject>;
+
+		/* Runs the visitor registered for the component's "type"; nullptr if there is none. */
+		Component ParseComponent(const ComponentVisitorDict& visitors, const nlohmann::json& json);
+
+		/*
+			Flattens a JSON object and its descendants into `output` in pre-order.
+			Only calls the visitors, so it may run on any thread as long as they do.
+		*/
+		void ParseSubtree
+		(
+			const ComponentVisitorDict& visitors,
+			const nlohmann::json&       json,
+			uint32_t                    parent,
+			uint64_t                    stableId,
+			LoadedSubtree&              output,
+			std::atomic<uint32_t>*      parsedCounter = nullptr
+		);
+
+		struct StreamRegion;
+		struct TrackedScene;
+		struct SceneSnapshot;
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/core/common.hpp>
+#include <lunar/core/component.hpp>
+#include <lunar/core/component_pool.hpp>
+#include <lunar/utils/collections.hpp>
+#include <utility>
+#include <tuple>
+#include <array>
+
+namespace lunar
+{
+	/*
+		A SceneView<Ts...> iterates every GameObject that owns a component of each
+		of the given types. Iteration walks the dense array of the smallest pool
+		and probes the other pools through their sparse arrays, so no type checks
+		or virtual calls are involved.
+
+		Usage:
+			for (auto [object, renderer, camera] : scene.view<MeshRenderer, Camera>())
+				...
+	*/
+	template<typename... Ts> requires (IsComponentType<Ts> && ...)
+	class SceneView
+	{
+	public:
+		using PoolArray = std::array<ComponentPool*, sizeof...(Ts)>;
+		using ValueType = std::tuple<GameObject, Ts&...>;
+
+		class Iterator
+		{
+		public:
+			Iterator(const SceneView* view, size_t index) noexcept : view(view), index(index) { skipInvalid(); }
+
+			ValueType operator*() const { return view->fetch(view->lead->ownerAt(index)); }
+			Iterator& operator++()      { index++; skipInvalid(); return *this; }
+			bool      operator==(const Iterator& other) const { return index == other.index; }
+
+		private:
+			void skipInvalid()
+			{
+				while (index < view->leadSize && !view->accepts(view->lead->ownerAt(index)))
+					index++;
+			}
+
+			const SceneView* view  = nullptr;
+			size_t           index = 0;
+		};
+
+		SceneView(SlotMap<GameObject_T>& objects, PoolArray pools) noexcept
+			: objects(&objects),
+			pools(pools)
+		{
+			for (ComponentPool* pool : pools)
+			{
+				if (pool == nullptr)
+				{
+					lead = nullptr;
+					return;
+				}
+
+				if (lead == nullptr || pool->size() < lead->size())
+					lead = pool;
+			}
+
+			leadSize = lead->size();
+		}
+
+		Iterator begin() const { return Iterator(this, 0); }
+		Iterator end()   const { return Iterator(this, leadSize); }
+
+		template<typename Fn>
+		void each(Fn&& fn) const
+		{
+			for (auto&& entry : *this)
+				std::apply(fn, entry);
+		}
+
+	private:
+		bool accepts(size_t object) const
+		{
+			if ((*objects)[objects->getId(static_cast<uint32_t>(object))].isPendingDelete())
+				return false;
+
+			for (ComponentPool* pool : pools)
+				if (pool != lead && !pool->contains(object))
+					return false;
+
+			return true;
+		}
+
+		ValueType fetch(size_t object) const
+		{
+			return fetch(object, std::index_sequence_for<Ts...>{});
+		}
+
+		template<size_t... Is>
+		ValueType fetch(size_t object, std::index_sequence<Is...>) const
+		{
+			return ValueType(
+				make_handle(*objects, objects->getId(static_cast<uint32_t>(object))),
+				*static_cast<Ts*>(pools[Is]->get(object))...
+			);
+		}
+
+		SlotMap<GameObject_T>* objects  = nullptr;
+		PoolArray              pools    = {};
+		ComponentPool*         lead     = nullptr;
+		size_t                 leadSize = 0;
+	};
+}
@@ -0,0 +1,238 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/core/bounds.hpp>
+#include <lunar/utils/collections.hpp>
+#include <lunar/debug/assert.hpp>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <utility>
+
+namespace lunar
+{
+	enum class FrustumTest : uint8_t
+	{
+		eOutside   = 0,
+		eIntersect = 1,
+		eInside    = 2,
+	};
+
+	LUNAR_API FrustumTest TestFrustum(const Frustum& frustum, const Aabb& box);
+
+	/*
+		Dynamic AABB tree (bounding volume hierarchy) in the style of Box2D's
+		b2DynamicTree. Leaves store "fat" boxes, enlarged by a margin, so objects
+		that move a little do not need to be reinserted; inner nodes are kept
+		balanced with AVL-style rotations, which bounds the height to O(log n)
+		whatever the insertion order.
+
+		Each leaf (proxy) carries a 32-bit user value that the queries report.
+		All queries are const and may run concurrently with each other.
+	*/
+	class LUNAR_API DynamicAabbTree
+	{
+	public:
+		static constexpr uint32_t NULL_NODE = UINT32_MAX;
+
+		DynamicAabbTree(float margin = 0.1f) noexcept : margin(margin) {}
+		~DynamicAabbTree() noexcept = default;
+
+		uint32_t    insert(const Aabb& box, uint32_t userData);
+		void        remove(uint32_t proxy);
+		bool        update(uint32_t proxy, const Aabb& box);
+		void        clear();
+		const Aabb& getFatBounds(uint32_t proxy) const;
+		uint32_t    getUserData(uint32_t proxy)  const;
+		uint32_t    getHeight()                  const;
+		size_t      size()                       const;
+
+		/* callback(userData) -> bool, returning false stops the query. */
+		template<typename F>
+		void queryOverlap(const Aabb& box, F&& callback) const
+		{
+			Stack stack;
+			stack.push(root);
+			while (!stack.empty())
+			{
+				const uint32_t index = stack.pop();
+				if (index == NULL_NODE || !nodes[index].box.overlaps(box))
+					continue;
+
+				if (nodes[index].isLeaf())
+				{
+					if (!callback(nodes[index].userData))
+						return;
+				}
+				else
+				{
+					stack.push(nodes[index].left);
+					stack.push(nodes[index].right);
+				}
+			}
+		}
+
+		/*
+			callback(userData, distance) -> float, called for every leaf box the ray
+			enters within `maxDistance`. The returned value becomes the new maximum
+			distance: return `distance` (or the exact hit) to find the closest hit,
+			the current maximum to keep going, or 0 to stop.
+		*/
+		template<typename F>
+		void raycast(const Ray& ray, float maxDistance, F&& callback) const
+		{
+			const glm::vec3 inverse_direction = 1.f / ray.direction;
+
+			Stack stack;
+			stack.push(root);
+			while (!stack.empty() && maxDistance > 0.f)
+			{
+				const uint32_t index = stack.pop();
+				if (index == NULL_NODE)
+					continue;
+
+				float distance = IntersectRay(ray, inverse_direction, nodes[index].box, maxDistance);
+				if (distance < 0.f)
+					continue;
+
+				if (nodes[index].isLeaf())
+				{
+					maxDistance = callback(nodes[index].userData, distance);
+				}
+				else
+				{
+					stack.push(nodes[index].left);
+					stack.push(nodes[index].right);
+				}
+			}
+		}
+
+		/*
+			callback(userData) -> bool. Subtrees entirely inside the frustum are
+			reported without testing any further boxes.
+		*/
+		template<typename F>
+		void queryFrustum(const Frustum& frustum, F&& callback) const
+		{
+			Stack stack;
+			stack.push(root);
+			while (!stack.empty())
+			{
+				const uint32_t index = stack.pop();
+				if (index == NULL_NODE)
+					continue;
+
+				FrustumTest test = TestFrustum(frustum, nodes[index].box);
+				if (test == FrustumTest::eOutside)
+					continue;
+
+				if (test == FrustumTest::eInside)
+				{
+					if (!reportSubtree(index, callback))
+						return;
+				}
+				else if (nodes[index].isLeaf())
+				{
+					if (!callback(nodes[index].userData))
+						return;
+				}
+				else
+				{
+					stack.push(nodes[index].left);
+					stack.push(nodes[index].right);
+				}
+			}
+		}
+
+		/*
+			The `count` leaves closest to the point, nearest first, as (userData,
+			squared distance) pairs. Distances are measured to the fat boxes.
+		*/
+		void queryNearest(const glm::vec3& point, size_t count, vector<std::pair<uint32_t, float>>& output) const;
+
+		DynamicAabbTree(const DynamicAabbTree&)            = delete;
+		DynamicAabbTree& operator=(const DynamicAabbTree&) = delete;
+
+	private:
+		struct Node
+		{
+			Aabb     box      = {};
+			uint32_t parent   = NULL_NODE; // next free node while on the free list
+			uint32_t left     = NULL_NODE;
+			uint32_t right    = NULL_NODE;
+			uint32_t userData = 0;
+			int32_t  height   = -1;        // 0 for leaves, -1 for free nodes
+
+			bool isLeaf() const { return left == NULL_NODE; }
+		};
+
+		/*
+			Traversal stack. A balanced tree of 2^32 leaves stays far below the
+			inline capacity; should a degenerate tree exceed it anyway, the rest
+			spills into a heap-allocated overflow, which is only non-empty while
+			the inline part is full.
+		*/
+		struct Stack
+		{
+			static constexpr uint32_t CAPACITY = 128;
+
+			uint32_t         items[CAPACITY] = {};
+			uint32_t         count           = 0;
+			vector<uint32_t> overflow        = {};
+
+			void push(uint32_t node)
+			{
+				if (count < CAPACITY)
+					items[count++] = node;
+				else
+					overflow.push_back(node);
+			}
+
+			uint32_t pop()
+			{
+				if (overflow.empty())
+					return items[--count];
+
+				uint32_t node = overflow.back();
+				overflow.pop_back();
+				return node;
+			}
+
+			bool empty() const { return count == 0; }
+		};
+
+		template<typename F>
+		bool reportSubtree(uint32_t subtree, F& callback) const
+		{
+			Stack stack;
+			stack.push(subtree);
+			while (!stack.empty())
+			{
+				const Node& node = nodes[stack.pop()];
+				if (node.isLeaf())
+				{
+					if (!callback(node.userData))
+						return false;
+				}
+				else
+				{
+					stack.push(node.left);
+					stack.push(node.right);
+				}
+			}
+			return true;
+		}
+
+		uint32_t allocateNode();
+		void     freeNode(uint32_t index);
+		void     insertLeaf(uint32_t leaf);
+		void     removeLeaf(uint32_t leaf);
+		uint32_t balance(uint32_t index);
+		uint32_t rotate(uint32_t index, uint32_t child);
+		void     refitAncestors(uint32_t index);
+
+		vector<Node> nodes     = {};
+		uint32_t     root      = NULL_NODE;
+		uint32_t     freeList  = NULL_NODE;
+		size_t       leafCount = 0;
+		float        margin    = 0.1f;
+	};
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/core/component.hpp>
+#include <lunar/utils/collections.hpp>
+#include <glm/glm.hpp>
+#include <cstdint>
+
+namespace lunar
+{
+	enum class TransformKernel : uint8_t
+	{
+		eScalar = 0,
+		eSSE4   = 1,
+		eAVX2   = 2, // AVX2 with FMA
+	};
+
+	/*
+		Returns the widest kernel supported by the CPU the engine is running on.
+		Detection happens once; the result is cached for the rest of the process.
+	*/
+	LUNAR_API TransformKernel GetTransformKernel();
+	LUNAR_API const char*     GetTransformKernelName(TransformKernel kernel);
+
+	namespace imp
+	{
+		/*
+			Structure-of-arrays batch of local transforms that get turned into world
+			matrices in one go. Entries must be pushed parent-first (e.g. sorted by
+			hierarchy depth): when an entry is processed, the matrix its parent pointer
+			refers to has to be final already.
+
+			Rotations are stored as euler angles (degrees) and turned into quaternions
+			inside the kernels, whose half-angle sines and cosines are computed on
+			whole lanes like the rest of the matrix.
+		*/
+		class LUNAR_API TransformBatch
+		{
+		public:
+			TransformBatch() noexcept = default;
+			~TransformBatch() noexcept = default;
+
+			void   clear();
+			void   reserve(size_t count);
+			size_t size() const;
+			void   push(const Transform& local, const glm::mat4* parentWorld, glm::mat4* outWorld);
+			void   run(TransformKernel kernel = GetTransformKernel());
+
+		private:
+			void   composeScalar(size_t begin, size_t end);
+			void   composeSSE4(size_t begin, size_t end);
+			void   composeAVX2(size_t begin, size_t end);
+			void   propagateScalar();
+			void   propagateSSE4();
+			void   propagateAVX2();
+
+			vector<float>            px      = {};
+			vector<float>            py      = {};
+			vector<float>            pz      = {};
+			vector<float>            ex      = {};
+			vector<float>            ey      = {};
+			vector<float>            ez      = {};
+			vector<float>            sx      = {};
+			vector<float>            sy      = {};
+			vector<float>            sz      = {};
+			vector<const glm::mat4*> parents = {};
+			vector<glm::mat4*>       outputs = {};
+			vector<glm::mat4>        locals  = {};
+		};
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <lunar/file/filesystem.hpp>
+#include <lunar/api.hpp>
+#include <cstddef>
+#include <span>
+
+namespace Fs
+{
+	/*
+		Read-only memory mapping of a whole file. Pages are brought in by the OS on
+		first access, so opening is O(1) regardless of file size and nothing is
+		copied until the caller reads the data. The view stays valid until the
+		object is closed or destroyed.
+	*/
+	class LUNAR_API MappedFile
+	{
+	public:
+		MappedFile(const Path& path) { fromFile(path); }
+		MappedFile() noexcept = default;
+		~MappedFile() noexcept;
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		bool                       fromFile(const Path& path);
+		void                       close();
+		bool                       isOpen() const { return opened; }
+		const std::byte*           data()   const { return view; }
+		size_t                     size()   const { return viewSize; }
+		std::span<const std::byte> bytes()  const { return { view, viewSize }; }
+
+		MappedFile(const MappedFile&)            = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+	private:
+		const std::byte* view     = nullptr;
+		size_t           viewSize = 0;
+		bool             opened   = false; // also true for empty files, which have no view
+#if defined(WIN32)
+		void*            file     = nullptr;
+		void*            mapping  = nullptr;
+#endif
+	};
+}
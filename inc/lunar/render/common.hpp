@@ -2,6 +2,7 @@
 #include <lunar/api.hpp>
 #include <lunar/core/handle.hpp>
 #include <glm/glm.hpp>
+#include <cstdint>
 
 #ifdef LUNAR_VULKAN
 #	include <vulkan/vulkan.hpp>
@@ -18,6 +19,13 @@ namespace lunar::Render
 		glm::vec4 color;
 	};
 
+	/* A run of elements (vertices, indices, materials) inside the geometry pool. */
+	struct LUNAR_API GeometryRange
+	{
+		uint32_t first = 0;
+		uint32_t count = 0;
+	};
+
 	struct LUNAR_API UniformBufferData
 	{
 #		ifdef LUNAR_VULKAN
@@ -13,6 +13,7 @@ namespace lunar
 
 		void             start()  override;
 		void             update() override;
+		ComponentAccess  getAccess() const override;
 		glm::mat4        getViewMatrix() const;
 		glm::mat4        getProjectionMatrix(int renderWidth, int renderHeight) const;
 
@@ -31,7 +32,8 @@ namespace lunar
 
 		glm::mat4 getModelMatrix() const;
 
-		Render::GpuMesh    mesh    = nullptr;
-		Render::GpuProgram program = nullptr;
+		Render::GpuMesh    mesh     = nullptr;
+		Render::GpuProgram program  = nullptr;
+		std::string        meshPath = {}; // relative to the data directory, kept for serialization
 	};
 }
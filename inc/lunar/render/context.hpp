@@ -6,6 +6,8 @@
 #include <lunar/render/render_target.hpp>
 #include <lunar/render/program.hpp>
 #include <lunar/render/mesh.hpp>
+#include <lunar/render/culling.hpp>
+#include <lunar/render/render_queue.hpp>
 #include <lunar/render/window.hpp>
 #include <lunar/core/common.hpp>
 
@@ -13,7 +15,7 @@
 #include <vector>
 #include <span>
 
-namespace lunar { class LUNAR_API Camera; }
+namespace lunar { class LUNAR_API Camera; class LUNAR_API FrameInterpolation; }
 
 namespace lunar::Render
 {
@@ -32,6 +34,11 @@ namespace lunar::Render
 		void        draw(GpuCubemap cubemap);
 		void        useCamera(const Camera* camera);
 		void        useCamera(const Camera& camera);
+		void        useInterpolation(const FrameInterpolation* interpolation);
+		void        useFrustumCulling(bool enabled = true);
+		void        useInstancedVariant(GpuProgram program, GpuProgram instanced);
+
+		const CullingStats& getCullingStats() const;
 
 		void        end();
 
@@ -87,6 +94,19 @@ namespace lunar::Render
 			GpuBuffer                    materialsBuffer,
 			GpuTexture                   materialsAtlas
 		);
+		GpuMesh              createMesh
+		(
+			GeometryRange                vertices,
+			GeometryRange                indices,
+			MeshTopology                 topology,
+			GpuBuffer                    materialsBuffer,
+			GpuTexture                   materialsAtlas
+		);
+		void                 destroyMesh(GpuMesh mesh);
+		GeometryRange        uploadVertices(const std::span<const Vertex>& vertices);
+		GeometryRange        uploadIndices(const std::span<const uint32_t>& indices);
+		GeometryRange        uploadMaterials(const std::span<const imp::GpuMaterialData>& materials);
+		GeometryRange        uploadPrimitiveMaterials(const std::span<const uint32_t>& materialIndices);
 		GpuCubemap           createCubemap
 		(
 			int   width,
@@ -104,8 +124,8 @@ namespace lunar::Render
 		vector<GpuBuffer_T*>            buffers              = {};
 		vector<GpuProgram_T*>           programs             = {};
 		vector<GpuTexture_T*>           textures             = {};
-		vector<GpuMesh_T>               meshes               = {};
-		vector<GpuCubemap_T>            cubemaps             = {};
+		SlotMap<GpuMesh_T>              meshes               = {};
+		SlotMap<GpuCubemap_T>           cubemaps             = {};
 		vector<Window_T*>               windows              = {};
 		RenderTarget*                   target               = nullptr;
 		bool                            inFrameScope         = false;
@@ -114,16 +134,30 @@ namespace lunar::Render
 		int                             viewportWidth        = 0;
 		int                             viewportHeight       = 0;
 		const Camera*                   renderCamera         = nullptr;
+		const FrameInterpolation*       interpolation        = nullptr; // see FrameRunner
 		GpuCubemap                      cubemap              = nullptr;
+		GpuMesh                         primitiveMeshes[2]   = {}; // indexed by MeshPrimitive
+		bool                            frustumCulling       = true;
+		CullingStats                    cullingStats         = {};
+		imp::FrustumCuller              culler               = {};
+		vector<imp::DrawItem>           drawItems            = {};
+		imp::RenderQueue                renderQueue          = {};
+		vector<imp::DrawBatch>          drawBatches          = {};
+		vector<imp::GpuInstanceData>    instanceData         = {};
+		vector<std::pair<GpuProgram, GpuProgram>> instancedVariants = {};
 
+		void bindMesh(GpuMesh mesh);
+		GpuProgram_T* findInstancedVariant(const GpuProgram_T* program);
 		void loadDefaultMeshes();
 		void loadDefaultPrograms();
 		void setViewportSize(int width, int height);
 
 #		ifdef LUNAR_OPENGL
-		GLuint                         frameBuffer  = 0;
-		GLuint                         renderBuffer = 0;
-		GLFWwindow*                    headless     = nullptr;
+		GLuint                              frameBuffer      = 0;
+		GLuint                              renderBuffer     = 0;
+		GLFWwindow*                         headless         = nullptr;
+		imp::GeometryPool                   geometryPool     = {};
+		vector<DrawElementsIndirectCommand> indirectCommands = {};
 #		endif
 	};
 
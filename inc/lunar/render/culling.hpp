@@ -0,0 +1,84 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/core/bounds.hpp>
+#include <lunar/render/common.hpp>
+#include <lunar/core/transform_batch.hpp>
+#include <lunar/utils/collections.hpp>
+#include <glm/glm.hpp>
+#include <cstdint>
+
+namespace lunar { class LUNAR_API MeshRenderer; }
+
+namespace lunar::Render
+{
+	/* Counts of the last culling pass run by RenderContext_T::draw(Scene&). */
+	struct LUNAR_API CullingStats
+	{
+		uint32_t tested  = 0;
+		uint32_t visible = 0;
+		uint32_t culled  = 0;
+	};
+
+	namespace imp
+	{
+		struct DrawItem
+		{
+			MeshRenderer*  renderer = nullptr;
+			glm::mat4      model    = glm::mat4(1.f);
+			BoundingSphere bounds   = {}; // world space
+		};
+
+		/*
+			A run of sorted draw items sharing program, material and mesh. Runs whose
+			program has an instanced variant are drawn with one instanced call if
+			they are at least INSTANCING_THRESHOLD items long, or if their mesh lives
+			in the geometry pool; pooled runs additionally get an indirect command,
+			so adjacent runs with the same program and topology go out in one
+			multi-draw. Instanced runs read their materials from the geometry pool,
+			so they only qualify if their mesh's materials are pooled or it has none.
+		*/
+		struct DrawBatch
+		{
+			static constexpr uint32_t INSTANCING_THRESHOLD = 2;
+			static constexpr uint32_t NOT_INSTANCED        = UINT32_MAX;
+			static constexpr uint32_t NO_COMMAND           = UINT32_MAX;
+
+			uint32_t      first         = 0; // into the sorted queue
+			uint32_t      count         = 0;
+			uint32_t      firstInstance = NOT_INSTANCED;
+			uint32_t      command       = NO_COMMAND;
+			GpuProgram_T* program       = nullptr; // the instanced variant, if instanced
+		};
+
+		/*
+			Structure-of-arrays batch of world-space bounding spheres, tested against
+			the six planes of a frustum four (SSE) or eight (AVX2) spheres at a time.
+			Spheres pushed empty have no known bounds and are always kept. The CPU
+			feature detection is shared with the transform kernels.
+		*/
+		class LUNAR_API FrustumCuller
+		{
+		public:
+			FrustumCuller()  noexcept = default;
+			~FrustumCuller() noexcept = default;
+
+			void     clear();
+			void     reserve(size_t count);
+			size_t   size() const;
+			void     push(const BoundingSphere& sphere);
+			uint32_t run(const Frustum& frustum, TransformKernel kernel = GetTransformKernel());
+			bool     isVisible(size_t index) const;
+
+		private:
+			void     cullScalar(const Frustum& frustum, size_t begin, size_t end);
+			void     cullSSE4(const Frustum& frustum, size_t begin, size_t end);
+			void     cullAVX2(const Frustum& frustum, size_t begin, size_t end);
+
+			vector<float>   cx      = {};
+			vector<float>   cy      = {};
+			vector<float>   cz      = {};
+			vector<float>   radius  = {};
+			vector<uint8_t> visible = {};
+		};
+	}
+}
@@ -2,7 +2,9 @@
 #ifdef LUNAR_OPENGL
 #	include <lunar/render/imp/gl/base.hpp>
 #	include <lunar/render/imp/gl/buffer.hpp>
+#	include <lunar/render/imp/gl/geometry_pool.hpp>
 #	include <lunar/render/imp/gl/program.hpp>
+#	include <lunar/render/imp/gl/ring_buffer.hpp>
 #	include <lunar/render/imp/gl/texture.hpp>
 #	include <lunar/render/imp/gl/window.hpp>
 #	include <glad/gl.h>
@@ -13,6 +13,7 @@ namespace lunar::Render
 		eIndex         = GL_ELEMENT_ARRAY_BUFFER,
 		eUniform       = GL_UNIFORM_BUFFER,
 		eShaderStorage = GL_SHADER_STORAGE_BUFFER,
+		eDrawIndirect  = GL_DRAW_INDIRECT_BUFFER,
 	};
 
 	enum class LUNAR_API GpuBufferUsageFlagBits : GLenum
@@ -45,6 +46,7 @@ namespace lunar::Render
 		void                bind();
 		void                bind(size_t location);
 		void                upload(void* data, size_t size, size_t offset = 0);
+		void                resize(size_t size);
 
 		template<typename T>
 		inline void         upload(const T& object, size_t offset = 0) { upload((void*)(&object), sizeof(T), offset); }
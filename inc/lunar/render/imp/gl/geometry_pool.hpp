@@ -0,0 +1,96 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/render/common.hpp>
+#include <lunar/render/imp/gl/buffer.hpp>
+#include <lunar/utils/collections.hpp>
+
+#include <glad/gl.h>
+#include <cstdint>
+#include <span>
+
+namespace lunar::Render
+{
+	/* Layout of GL_DRAW_INDIRECT_BUFFER entries, as defined by the GL spec. */
+	struct LUNAR_API DrawElementsIndirectCommand
+	{
+		uint32_t count         = 0;
+		uint32_t instanceCount = 0;
+		uint32_t firstIndex    = 0;
+		int32_t  baseVertex    = 0;
+		uint32_t baseInstance  = 0;
+	};
+
+	namespace imp
+	{
+		struct GpuMaterialData;
+
+		/*
+			Shared vertex, index and material storage. Meshes built through
+			GpuMeshBuilder do not own buffers; they are a vertex range and an index
+			range in here, with indices relative to the mesh's first vertex (drawn
+			with a base vertex). Any number of meshes can thus be drawn without
+			rebinding buffers, which is what lets a whole scene go out through a few
+			glMultiDrawElementsIndirect calls.
+
+			Their materials live here as well, next to one material index per
+			triangle already offset to the mesh's first material, so batches of
+			different meshes do not need their own material bindings either.
+
+			Ranges are allocated first-fit from the holes left by destroyed meshes,
+			and appended otherwise; when a buffer is full it doubles in place (see
+			GpuBuffer_T::resize()), so handles to it stay valid.
+		*/
+		class LUNAR_API GeometryPool
+		{
+		public:
+			GeometryPool()  noexcept = default;
+			~GeometryPool() noexcept;
+
+			void          create(RenderContext_T* context);
+			void          release();
+
+			GeometryRange addVertices(const std::span<const Vertex>& vertices);
+			GeometryRange addIndices(const std::span<const uint32_t>& indices);
+			GeometryRange addMaterials(const std::span<const GpuMaterialData>& materials);
+			GeometryRange addPrimitives(const std::span<const uint32_t>& materialIndices);
+			void          freeVertices(GeometryRange range);
+			void          freeIndices(GeometryRange range);
+			void          freeMaterials(GeometryRange range);
+			void          freePrimitives(GeometryRange range);
+			uint32_t      getVertexCount() const;
+			uint32_t      getIndexCount()  const;
+
+			GpuBuffer     getVertexBuffer()    const;
+			GpuBuffer     getIndexBuffer()     const;
+			GpuBuffer     getMaterialBuffer()  const;
+			GpuBuffer     getPrimitiveBuffer() const;
+
+			GeometryPool(const GeometryPool&)            = delete;
+			GeometryPool& operator=(const GeometryPool&) = delete;
+
+		private:
+			static constexpr uint32_t INITIAL_VERTICES   = 1 << 16;
+			static constexpr uint32_t INITIAL_INDICES    = 1 << 18;
+			static constexpr uint32_t INITIAL_MATERIALS  = 1 << 10;
+			static constexpr uint32_t INITIAL_PRIMITIVES = 1 << 16;
+
+			struct Storage
+			{
+				GpuBuffer             buffer      = nullptr;
+				size_t                elementSize = 0;
+				uint32_t              size        = 0; // in elements
+				uint32_t              capacity    = 0;
+				vector<GeometryRange> holes       = {}; // free ranges below `size`, sorted and never adjacent
+			};
+
+			static void          Create(RenderContext_T* context, Storage& storage, GpuBufferType type, size_t elementSize, uint32_t capacity);
+			static GeometryRange Append(Storage& storage, const void* data, uint32_t count);
+			static void          Free(Storage& storage, GeometryRange range);
+
+			Storage vertices   = {};
+			Storage indices    = {};
+			Storage materials  = {};
+			Storage primitives = {};
+		};
+	}
+}
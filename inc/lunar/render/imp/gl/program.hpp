@@ -1,12 +1,14 @@
 #pragma once
 #include <lunar/api.hpp>
 #include <lunar/render/common.hpp>
+#include <lunar/utils/collections.hpp>
 
 #include <glad/gl.h>
 #include <glm/glm.hpp>
 #include <initializer_list>
 #include <string_view>
 #include <span>
+#include <string>
 
 namespace lunar::Render
 {
@@ -65,11 +67,20 @@ namespace lunar::Render
 		GpuProgramType getProgramType() const;
 
 		GLuint         glGetHandle();
+		GLint          getUniformLocation(const std::string_view& name);
 
 	public:
 		size_t         refCount    = 0;
 	private:
-		GLuint         handle      = 0;
-		GpuProgramType programType = GpuProgramType::eUnknown;
+		struct UniformLocation
+		{
+			size_t      hash     = 0;
+			std::string name     = {};
+			GLint       location = -1;
+		};
+
+		GLuint                  handle           = 0;
+		GpuProgramType          programType      = GpuProgramType::eUnknown;
+		vector<UniformLocation> uniformLocations = {}; // looked up once per name, see getUniformLocation()
 	};
 }
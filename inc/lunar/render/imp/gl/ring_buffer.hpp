@@ -0,0 +1,73 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/utils/collections.hpp>
+
+#include <glad/gl.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace lunar::Render::imp
+{
+	/* A piece of a RingBuffer, written through `data` and bound with glBindBufferRange. */
+	struct RingAllocation
+	{
+		GLuint buffer = 0;
+		size_t offset = 0;
+		size_t size   = 0;
+		void*  data   = nullptr;
+	};
+
+	/*
+		Per-frame streaming storage for data rewritten every frame (scene and mesh
+		uniforms, instance matrices, indirect commands). The buffer is created with
+		glBufferStorage and stays mapped persistent and coherent, so writing is a
+		plain memcpy and no call reaches the driver until the data is bound.
+
+		It is split into FRAMES segments, one per frame in flight. beginFrame()
+		moves to the next segment and waits on the fence endFrame() left there
+		FRAMES frames earlier; allocations within a frame are bump-allocated.
+
+		When a frame does not fit, the buffer is replaced by one twice the size.
+		The old one is only deleted at the next beginFrame(), so ranges already
+		bound this frame stay valid.
+	*/
+	class LUNAR_API RingBuffer
+	{
+	public:
+		static constexpr uint32_t FRAMES = 3;
+
+		RingBuffer()  noexcept = default;
+		~RingBuffer() noexcept;
+
+		void           create(size_t frameCapacity);
+		void           release();
+		void           beginFrame();
+		void           endFrame();
+		RingAllocation allocate(size_t size, GLenum target);
+
+		template<typename T>
+		inline RingAllocation push(const T& object, GLenum target)
+		{
+			RingAllocation allocation = allocate(sizeof(T), target);
+			std::memcpy(allocation.data, &object, sizeof(T));
+			return allocation;
+		}
+
+		RingBuffer(const RingBuffer&)            = delete;
+		RingBuffer& operator=(const RingBuffer&) = delete;
+
+	private:
+		void           grow(size_t required);
+
+		GLuint         buffer           = 0;
+		uint8_t*       mapped           = nullptr;
+		size_t         frameCapacity    = 0;
+		size_t         head             = 0; // within the current segment
+		uint32_t       frame            = 0;
+		GLsync         fences[FRAMES]   = {};
+		GLint          uniformAlignment = 256;
+		GLint          storageAlignment = 256;
+		vector<GLuint> retired          = {};
+	};
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <lunar/render/common.hpp>
 #include <lunar/render/imp.hpp>
+#include <lunar/render/imp/gl/ring_buffer.hpp>
 
 #include <glad/gl.h>
 
@@ -10,9 +11,23 @@ namespace lunar::Render
 	{
 		struct WindowBackendData
 		{
-			GLuint    globalVao        = 0;
-			GpuBuffer sceneDataUniform = nullptr;
-			GpuBuffer meshDataUniform  = nullptr;
+			static constexpr size_t FRAME_DATA_CAPACITY = 1 << 20; // per frame in flight
+
+			GLuint     globalVao        = 0;
+
+			/*
+				Scene and mesh uniforms, the instance data of instanced batches
+				(shader storage, binding 3) and the indirect commands of the frame.
+				Scenes are only drawn into windows, so nothing else needs one.
+			*/
+			RingBuffer frameData        = {};
+
+			/*
+				A 0, 1, 2... buffer feeding the per-instance `in_instance` attribute,
+				so base instances offset into the matrices without gl_BaseInstance.
+			*/
+			GpuBuffer  instanceIds      = nullptr;
+			size_t     instanceCapacity = 0;
 		};
 	}
 }
@@ -1,7 +1,9 @@
 #pragma once
 #include <lunar/render/common.hpp>
+#include <lunar/core/bounds.hpp>
 #include <lunar/file/filesystem.hpp>
 #include <lunar/api.hpp>
+#include <vector>
 #include <span>
 
 #ifdef LUNAR_OPENGL
@@ -35,6 +37,17 @@ namespace lunar::Render
 			GpuBuffer                    materialsBuffer,
 			GpuTexture                   materialsAtlas
 		) noexcept;
+		GpuMesh_T
+		(
+			RenderContext_T*             context,
+			GpuBuffer                    vertexBuffer,
+			GpuBuffer                    indexBuffer,
+			GeometryRange                vertices,
+			GeometryRange                indices,
+			MeshTopology                 topology,
+			GpuBuffer                    materialsBuffer,
+			GpuTexture                   materialsAtlas
+		) noexcept;
 		GpuMesh_T()  noexcept = default;
 		~GpuMesh_T() noexcept;
 
@@ -46,9 +59,16 @@ namespace lunar::Render
 		GpuBuffer             getIndexBuffer();
 		GpuBuffer             getMaterialsBuffer();
 		GpuTexture            getMaterialsAtlas();
+		const Aabb&           getBounds()           const;
+		const BoundingSphere& getBoundingSphere()   const;
+		bool                  isPooled()            const;
+		GeometryRange         getVertexRange()      const;
+		GeometryRange         getIndexRange()       const;
+		GeometryRange         getMaterialRange()    const;
+		GeometryRange         getPrimitiveRange()   const;
 	private:
 		//GpuVertexArrayObject vertexArray  = nullptr;
-		GpuBuffer            vertexBuffer    = nullptr;
+		GpuBuffer            vertexBuffer    = nullptr; // the geometry pool's buffers if pooled
 		GpuBuffer            indexBuffer     = nullptr;
 		GpuBuffer            materialsBuffer = nullptr;
 		GpuTexture           materialsAtlas  = nullptr;
@@ -56,6 +76,15 @@ namespace lunar::Render
 		size_t               vertexCount     = 0;
 		size_t               indexCount      = 0;
 		MeshTopology         meshTopology    = MeshTopology::eTriangles;
+		GeometryRange        vertexRange     = {}; // in the geometry pool if pooled, else in vertexBuffer
+		GeometryRange        indexRange      = {};
+		GeometryRange        materialRange   = {}; // in the geometry pool, empty if the materials are not pooled
+		GeometryRange        primitiveRange  = {}; // one material index per triangle
+		bool                 pooled          = false;
+		Aabb                 bounds          = {}; // object space, computed by GpuMeshBuilder
+		BoundingSphere       sphere          = {};
+
+		friend struct GpuMeshBuilder;
 	};
 
 	enum class LUNAR_API MeshPrimitive
@@ -64,6 +93,25 @@ namespace lunar::Render
 		eQuad = 1
 	};
 
+	/*
+		CPU-side contents of a mesh file. Decoding touches neither the GPU nor the
+		render context, so it may run on any thread; turning the data into a GpuMesh
+		(GpuMeshBuilder::fromMeshData) has to happen on the context thread.
+	*/
+	struct LUNAR_API MeshData
+	{
+		std::vector<Vertex>   vertices    = {};
+		std::vector<uint32_t> indices     = {};
+		std::vector<uint8_t>  materials   = {}; // contents of the materials storage buffer
+		std::vector<uint32_t> atlasPixels = {}; // RGBA8
+		int                   atlasWidth  = 0;
+		int                   atlasHeight = 0;
+
+		bool empty() const { return vertices.empty(); }
+	};
+
+	LUNAR_API bool DecodeMeshFile(const Fs::Path& path, MeshData& output);
+
 	struct LUNAR_API GpuMeshBuilder
 	{
 	public:
@@ -74,18 +122,24 @@ namespace lunar::Render
 		GpuMeshBuilder& fromVertexArray(const std::span<const Vertex>& vertices);
 		GpuMeshBuilder& fromIndexArray(const std::span<const uint32_t>& indices);
 		GpuMeshBuilder& fromMeshFile(const Fs::Path& path);
+		GpuMeshBuilder& fromMeshData(const MeshData& data);
 		GpuMesh         build();
 
 	private:
-		GpuBuffer            vertexBuffer    = nullptr;
-		GpuBuffer            indexBuffer     = nullptr;
+		void                 computeBounds(const std::span<const Vertex>& vertices);
+		void                 poolMaterials(const MeshData& data);
+
+		GeometryRange        vertexRange     = {};
+		GeometryRange        indexRange      = {};
+		GeometryRange        materialRange   = {};
+		GeometryRange        primitiveRange  = {};
 		GpuBuffer            materialsBuffer = nullptr;
 		GpuTexture           materialsAtlas  = nullptr;
 		RenderContext_T*     context         = nullptr;
 		size_t               vertexCount     = 0;
 		size_t               indicesCount    = 0;
-
-		void fromGltfFile(const Fs::Path& path);
+		Aabb                 bounds          = {};
+		BoundingSphere       sphere          = {};
 	};
 
 	namespace imp
@@ -101,5 +155,39 @@ namespace lunar::Render
 		{
 			glm::mat4 model;
 		};
+
+		/*
+			Material of the geometry pool, laid out as the std430 Material struct of
+			pbr_instanced.frag. `atlas` is the bindless handle of the owning mesh's
+			atlas, 0 if it has none.
+		*/
+		struct LUNAR_API GpuMaterialData
+		{
+			glm::vec2 atlasBegin = { 0, 0 };
+			glm::vec2 atlasEnd   = { 0, 0 };
+			float     metallic   = 0.1f;
+			float     roughness  = 0.1f;
+			float     ao         = 0.1f;
+			uint32_t  padding    = 0;
+			uint64_t  atlas      = 0;
+		};
+
+		static_assert(sizeof(GpuMaterialData) == 40, "GpuMaterialData must match the std430 layout.");
+
+		/*
+			Per-instance data of instanced and multi-drawn batches. `primitiveBase` is
+			where the mesh's per-triangle material indices start in the geometry
+			pool, NO_MATERIALS if it has none pooled.
+		*/
+		struct LUNAR_API GpuInstanceData
+		{
+			static constexpr uint32_t NO_MATERIALS = UINT32_MAX;
+
+			glm::mat4 model         = glm::mat4(1.f);
+			uint32_t  primitiveBase = NO_MATERIALS;
+			uint32_t  padding[3]    = {};
+		};
+
+		static_assert(sizeof(GpuInstanceData) == 80, "GpuInstanceData must match the std430 layout.");
 	}
 }
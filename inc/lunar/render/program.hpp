@@ -17,7 +17,8 @@ namespace lunar::Render
 		ePrefilterMapBuilder  = 3,
 		eBrdfBuilder          = 4,
 		eSkyboxShader         = 5,
-		eBasicPbrShader       = 6
+		eBasicPbrShader       = 6,
+		eInstancedPbrShader   = 7, // eBasicPbrShader reading its model matrices from the instance buffer and its materials from the geometry pool
 	};
 
 	struct LUNAR_API GpuProgramBuilder
@@ -0,0 +1,60 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/utils/collections.hpp>
+#include <cstdint>
+#include <span>
+
+namespace lunar::Render
+{
+	enum class RenderPass : uint8_t
+	{
+		eOpaque      = 0,
+		eTransparent = 1,
+	};
+
+	namespace imp
+	{
+		/*
+			Draw items are submitted in the order of a 64-bit key, most significant
+			field first, so state changes are grouped from the most to the least
+			expensive one:
+
+				63..62  pass
+				61..50  program
+				49..38  material (albedo atlas)
+				37..24  mesh
+				23..0   depth, front to back
+
+			Ids wider than their field are truncated. That can only make two groups
+			share a key prefix; the submission loop compares the actual objects
+			before changing any state.
+		*/
+		LUNAR_API uint64_t MakeSortKey(RenderPass pass, uint32_t program, uint32_t material, uint32_t mesh, float depth);
+
+		/*
+			Collects (key, item) pairs and sorts them with an LSD radix sort, one
+			8-bit digit per pass. Digits on which all keys agree (typically the pass
+			and, in small scenes, the program) are skipped.
+		*/
+		class LUNAR_API RenderQueue
+		{
+		public:
+			RenderQueue()  noexcept = default;
+			~RenderQueue() noexcept = default;
+
+			void                      clear();
+			void                      reserve(size_t count);
+			size_t                    size() const;
+			void                      push(uint64_t key, uint32_t item);
+			void                      sort();
+			std::span<const uint32_t> getItems() const;
+			std::span<const uint64_t> getKeys()  const;
+
+		private:
+			vector<uint64_t> keys         = {};
+			vector<uint32_t> items        = {};
+			vector<uint64_t> keysScratch  = {};
+			vector<uint32_t> itemsScratch = {};
+		};
+	}
+}
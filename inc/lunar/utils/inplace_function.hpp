@@ -0,0 +1,116 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <type_traits>
+#include <functional>
+#include <concepts>
+#include <cstddef>
+#include <utility>
+#include <new>
+
+namespace lunar
+{
+	template<typename Signature, size_t Capacity = 48>
+	class InplaceFunction;
+
+	/*
+		Move-only std::function replacement that never allocates: the callable is
+		stored in an inline buffer, and anything that does not fit is rejected at
+		compile time instead of silently spilling onto the heap.
+	*/
+	template<typename R, typename... Args, size_t Capacity>
+	class InplaceFunction<R(Args...), Capacity>
+	{
+	public:
+		InplaceFunction()               noexcept = default;
+		InplaceFunction(std::nullptr_t) noexcept {}
+
+		template<typename F>
+			requires (!std::same_as<std::decay_t<F>, InplaceFunction> && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+		InplaceFunction(F&& callable) noexcept(std::is_nothrow_constructible_v<std::decay_t<F>, F&&>)
+		{
+			using Fn = std::decay_t<F>;
+			static_assert(sizeof(Fn) <= Capacity, "Callable does not fit into the InplaceFunction buffer.");
+			static_assert(alignof(Fn) <= alignof(std::max_align_t), "Callable is over-aligned.");
+			static_assert(std::is_nothrow_move_constructible_v<Fn>, "Callable must be nothrow move constructible.");
+
+			new (storage) Fn(std::forward<F>(callable));
+			invoker = [](void* self, Args... args) -> R {
+				return std::invoke(*static_cast<Fn*>(self), std::forward<Args>(args)...);
+			};
+			manager = [](Operation operation, void* self, void* other) {
+				if (operation == Operation::eMove)
+					new (self) Fn(std::move(*static_cast<Fn*>(other)));
+
+				static_cast<Fn*>(operation == Operation::eMove ? other : self)->~Fn();
+			};
+		}
+
+		InplaceFunction(InplaceFunction&& other) noexcept
+		{
+			moveFrom(other);
+		}
+
+		InplaceFunction& operator=(InplaceFunction&& other) noexcept
+		{
+			if (this != &other)
+			{
+				reset();
+				moveFrom(other);
+			}
+			return *this;
+		}
+
+		InplaceFunction& operator=(std::nullptr_t) noexcept
+		{
+			reset();
+			return *this;
+		}
+
+		~InplaceFunction() noexcept
+		{
+			reset();
+		}
+
+		R operator()(Args... args) const
+		{
+			return invoker(storage, std::forward<Args>(args)...);
+		}
+
+		explicit operator bool() const { return invoker != nullptr; }
+
+		InplaceFunction(const InplaceFunction&)            = delete;
+		InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+	private:
+		enum class Operation
+		{
+			eMove,    // move-construct into `self` from `other`, then destroy `other`
+			eDestroy, // destroy `self`
+		};
+
+		void reset()
+		{
+			if (manager != nullptr)
+				manager(Operation::eDestroy, storage, nullptr);
+
+			invoker = nullptr;
+			manager = nullptr;
+		}
+
+		void moveFrom(InplaceFunction& other)
+		{
+			if (other.manager == nullptr)
+				return;
+
+			other.manager(Operation::eMove, storage, other.storage);
+			invoker       = other.invoker;
+			manager       = other.manager;
+			other.invoker = nullptr;
+			other.manager = nullptr;
+		}
+
+		alignas(std::max_align_t) mutable std::byte storage[Capacity] = {};
+		R    (*invoker)(void*, Args...)          = nullptr;
+		void (*manager)(Operation, void*, void*) = nullptr;
+	};
+}
@@ -0,0 +1,264 @@
+#pragma once
+#include <lunar/api.hpp>
+#include <lunar/utils/collections.hpp>
+#include <lunar/debug/assert.hpp>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <iterator>
+#include <mutex>
+#include <atomic>
+
+namespace lunar
+{
+	/*
+		Identifier of an element inside a SlotMap. The index selects a slot, the
+		generation tells apart the different elements that lived in that slot
+		over time, so an id to an erased element never aliases a newer one. The
+		map field names the SlotMap that issued the id: its low bits are the
+		registry tag a Handle finds the map through, the high bits an epoch that
+		is never handed out twice, so ids of a destroyed map stay dead even once
+		its tag goes to a new map.
+	*/
+	struct LUNAR_API SlotId
+	{
+		static constexpr uint32_t INVALID_INDEX      = UINT32_MAX;
+		static constexpr uint32_t RETIRED_GENERATION = UINT32_MAX;
+		static constexpr uint32_t TAG_BITS           = 8;
+		static constexpr uint32_t TAG_MASK           = (1u << TAG_BITS) - 1;
+
+		uint32_t index      = INVALID_INDEX;
+		uint32_t generation = 0;
+		uint32_t map        = 0; // epoch << TAG_BITS | tag, 0 for null ids
+
+		bool     isNull() const { return index == INVALID_INDEX; }
+		uint32_t getTag() const { return map & TAG_MASK; }
+		bool operator==(const SlotId& other) const = default;
+	};
+
+	static_assert(sizeof(SlotId) == 12);
+
+	/*
+		Generational slot map. Every value lives inside its slot, so resolving an
+		id is a single lookup, and erasing leaves the other elements where they
+		are. Insertion and removal are O(1); freed slots are reused first, which
+		keeps iteration (slot order, skipping the free ones) close to dense.
+
+		Every map registers itself under a small tag, stored in the ids it hands
+		out together with the map's epoch; up to MAX_MAPS maps of the same type
+		may be alive at once. A slot whose generation would reach
+		RETIRED_GENERATION is never reused, so generations do not wrap.
+	*/
+	template<typename T>
+	class SlotMap
+	{
+		struct Slot
+		{
+			std::optional<T> value      = {};
+			uint32_t         generation = 0;
+			uint32_t         nextFree   = SlotId::INVALID_INDEX;
+		};
+
+		template<typename SlotT, typename ValueT>
+		class Iterator
+		{
+		public:
+			using value_type      = T;
+			using difference_type = std::ptrdiff_t;
+
+			Iterator() noexcept = default;
+			Iterator(SlotT* slot, SlotT* last) noexcept : slot(slot), last(last) { skipFree(); }
+
+			ValueT&   operator*()  const { return *slot->value; }
+			ValueT*   operator->() const { return &*slot->value; }
+			Iterator& operator++()       { slot++; skipFree(); return *this; }
+			Iterator  operator++(int)    { Iterator copy = *this; ++*this; return copy; }
+			bool      operator==(const Iterator& other) const { return slot == other.slot; }
+
+		private:
+			void skipFree()
+			{
+				while (slot != last && !slot->value.has_value())
+					slot++;
+			}
+
+			SlotT* slot = nullptr;
+			SlotT* last = nullptr;
+		};
+
+	public:
+		using ValueType      = T;
+		using iterator       = Iterator<Slot, T>;
+		using const_iterator = Iterator<const Slot, const T>;
+
+		static constexpr uint32_t MAX_MAPS   = 1u << SlotId::TAG_BITS;
+		static constexpr uint32_t MAX_EPOCHS = UINT32_MAX >> SlotId::TAG_BITS;
+
+		SlotMap() noexcept
+		{
+			std::lock_guard lock(RegistryMutex);
+
+			uint32_t tag = 0;
+			while (tag < MAX_MAPS && Registry[tag].map.load(std::memory_order_relaxed) != nullptr)
+				tag++;
+
+			DEBUG_ASSERT(tag < MAX_MAPS, "Too many slot maps of the same type are alive at once.");
+			DEBUG_ASSERT(NextEpoch <= MAX_EPOCHS, "Ran out of slot map epochs.");
+
+			identity = (NextEpoch++ << SlotId::TAG_BITS) | tag;
+			Registry[tag].map.store(this, std::memory_order_relaxed);
+			Registry[tag].identity.store(identity, std::memory_order_release);
+		}
+
+		~SlotMap() noexcept
+		{
+			std::lock_guard lock(RegistryMutex);
+
+			Entry& entry = Registry[identity & SlotId::TAG_MASK];
+			entry.identity.store(0, std::memory_order_relaxed);
+			entry.map.store(nullptr, std::memory_order_release);
+		}
+
+		SlotMap(const SlotMap&)            = delete;
+		SlotMap& operator=(const SlotMap&) = delete;
+
+		/*
+			The map that issued the id, or null if it has been destroyed since.
+			Lock-free; the identity is read again after the pointer, so a tag
+			being handed to another map meanwhile is never mistaken for a match.
+		*/
+		static SlotMap* FromId(SlotId id)
+		{
+			const Entry& entry = Registry[id.getTag()];
+			if (id.map == 0 || entry.identity.load(std::memory_order_acquire) != id.map)
+				return nullptr;
+
+			SlotMap* map = entry.map.load(std::memory_order_acquire);
+			return entry.identity.load(std::memory_order_acquire) == id.map ? map : nullptr;
+		}
+
+		template<typename... Args>
+		SlotId emplace(Args&&... args)
+		{
+			uint32_t slot_index = 0;
+			if (freeHead != SlotId::INVALID_INDEX)
+			{
+				slot_index = freeHead;
+				freeHead   = slots[slot_index].nextFree;
+			}
+			else
+			{
+				slot_index = static_cast<uint32_t>(slots.size());
+				slots.push_back(Slot{});
+			}
+
+			slots[slot_index].value.emplace(std::forward<Args>(args)...);
+			count++;
+
+			return getId(slot_index);
+		}
+
+		SlotId insert(T value) { return emplace(std::move(value)); }
+
+		/*
+			Destroys the element and bumps the generation of its slot, invalidating
+			every id that still refers to it. No other element moves.
+		*/
+		void erase(SlotId id)
+		{
+			DEBUG_ASSERT(contains(id), "Erasing an element through a stale or null id.");
+			release(id.index);
+		}
+
+		void clear()
+		{
+			for (uint32_t i = 0; i < slots.size(); i++)
+				if (slots[i].value.has_value())
+					release(i);
+		}
+
+		bool contains(SlotId id) const
+		{
+			return id.map == identity && id.index < slots.size() && slots[id.index].generation == id.generation && slots[id.index].value.has_value();
+		}
+
+		T* find(SlotId id)
+		{
+			return contains(id) ? &*slots[id.index].value : nullptr;
+		}
+
+		const T* find(SlotId id) const
+		{
+			return contains(id) ? &*slots[id.index].value : nullptr;
+		}
+
+		/* Unchecked access; stale ids are only caught in debug builds. */
+		T& operator[](SlotId id)
+		{
+#if LUNAR_DEBUG_BUILD
+			DEBUG_ASSERT(contains(id), "Dereferenced a stale or null slot map id.");
+#endif
+			return *slots[id.index].value;
+		}
+
+		const T& operator[](SlotId id) const
+		{
+#if LUNAR_DEBUG_BUILD
+			DEBUG_ASSERT(contains(id), "Dereferenced a stale or null slot map id.");
+#endif
+			return *slots[id.index].value;
+		}
+
+		/* Id of the element currently living in the given slot (stale if the slot is free). */
+		SlotId getId(uint32_t slotIndex) const
+		{
+			DEBUG_ASSERT(slotIndex < slots.size());
+			return SlotId{ slotIndex, slots[slotIndex].generation, identity };
+		}
+
+		size_t size()      const { return count; }
+		bool   empty()     const { return count == 0; }
+		size_t slotCount() const { return slots.size(); }
+
+		iterator       begin()       { return iterator(slots.data(), slots.data() + slots.size()); }
+		iterator       end()         { return iterator(slots.data() + slots.size(), slots.data() + slots.size()); }
+		const_iterator begin() const { return const_iterator(slots.data(), slots.data() + slots.size()); }
+		const_iterator end()   const { return const_iterator(slots.data() + slots.size(), slots.data() + slots.size()); }
+
+		void reserve(size_t capacity)
+		{
+			slots.reserve(capacity);
+		}
+
+	private:
+		void release(uint32_t slotIndex)
+		{
+			Slot& slot = slots[slotIndex];
+			slot.value.reset();
+			count--;
+
+			// A saturated slot stays out of the free list for good rather than wrap
+			if (++slot.generation == SlotId::RETIRED_GENERATION)
+				return;
+
+			slot.nextFree = freeHead;
+			freeHead      = slotIndex;
+		}
+
+		/* Written under RegistryMutex, read lock-free by FromId(). */
+		struct Entry
+		{
+			std::atomic<SlotMap*> map      = nullptr;
+			std::atomic<uint32_t> identity = 0;
+		};
+
+		static inline Entry      Registry[MAX_MAPS] = {};
+		static inline uint32_t   NextEpoch          = 1;
+		static inline std::mutex RegistryMutex;
+
+		vector<Slot> slots    = {};
+		size_t       count    = 0;
+		uint32_t     freeHead = SlotId::INVALID_INDEX;
+		uint32_t     identity = 0;
+	};
+}
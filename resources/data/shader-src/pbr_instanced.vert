@@ -0,0 +1,40 @@
+#version 450 core
+layout (location = 0) in vec3 in_pos;
+layout (location = 1) in vec3 in_normal;
+layout (location = 2) in vec4 in_color;
+layout (location = 3) in float in_uv_x;
+layout (location = 4) in float in_uv_y;
+layout (location = 5) in uint  in_instance; // per-instance attribute, offset by the draw's base instance
+
+layout (std140, binding = 0) uniform SceneData
+{
+	mat4 projection;
+	mat4 view;
+	vec3 camera_pos;
+};
+
+struct Instance
+{
+	mat4 model;
+	uint primitiveBase; // where the mesh's per-triangle material indices start in the geometry pool
+};
+
+layout (std430, binding = 3) readonly buffer InstanceData
+{
+	Instance instances[];
+};
+
+layout (location = 0) out vec2 out_uv;
+layout (location = 1) out vec3 out_world;
+layout (location = 2) out vec3 out_normal;
+layout (location = 3) flat out uint out_primitive_base;
+
+void main()
+{
+	mat4 model  = instances[in_instance].model;
+	out_uv      = vec2(in_uv_x, in_uv_y);
+	out_world   = vec3(model * vec4(in_pos, 1.0));
+	out_normal  = in_normal;
+	out_primitive_base = instances[in_instance].primitiveBase;
+	gl_Position = projection * view * model * vec4(in_pos.xyz, 1);
+}
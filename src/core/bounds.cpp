@@ -0,0 +1,85 @@
+#include <lunar/core/bounds.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace lunar
+{
+	/* Arvo's method: transform the center, and project the extents onto the world axes. */
+	Aabb Aabb::transformed(const glm::mat4& matrix) const
+	{
+		if (isEmpty())
+			return *this;
+
+		glm::vec3 center  = glm::vec3(matrix * glm::vec4(getCenter(), 1.f));
+		glm::vec3 extents = getExtents();
+		glm::vec3 world   = glm::abs(glm::vec3(matrix[0])) * extents.x
+			+ glm::abs(glm::vec3(matrix[1])) * extents.y
+			+ glm::abs(glm::vec3(matrix[2])) * extents.z;
+
+		return Aabb{ center - world, center + world };
+	}
+
+	BoundingSphere BoundingSphere::transformed(const glm::mat4& matrix) const
+	{
+		if (isEmpty())
+			return *this;
+
+		float scale2 = std::max({
+			glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0])),
+			glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1])),
+			glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2]))
+		});
+
+		return BoundingSphere{ glm::vec3(matrix * glm::vec4(center, 1.f)), radius * std::sqrt(scale2) };
+	}
+
+	Frustum Frustum::FromMatrix(const glm::mat4& viewProjection)
+	{
+		const auto& m   = viewProjection;
+		auto        row = [&](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+
+		auto frustum      = Frustum();
+		frustum.planes[0] = row(3) + row(0);
+		frustum.planes[1] = row(3) - row(0);
+		frustum.planes[2] = row(3) + row(1);
+		frustum.planes[3] = row(3) - row(1);
+		frustum.planes[4] = row(3) + row(2);
+		frustum.planes[5] = row(3) - row(2);
+
+		for (auto& plane : frustum.planes)
+			plane = plane * (1.f / glm::length(glm::vec3(plane)));
+
+		return frustum;
+	}
+
+	/* Slab test. Returns the entry distance (0 if the origin is inside the box). */
+	float IntersectRay(const Ray& ray, const glm::vec3& inverseDirection, const Aabb& box, float maxDistance)
+	{
+		float entry = -FLT_MAX;
+		float exit  = FLT_MAX;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			// A ray parallel to the slab is inside it everywhere or nowhere; on its plane, 0 * inf would give NaN
+			if (ray.direction[axis] == 0.f)
+			{
+				if (ray.origin[axis] < box.min[axis] || ray.origin[axis] > box.max[axis])
+					return -1.f;
+
+				continue;
+			}
+
+			float t1 = (box.min[axis] - ray.origin[axis]) * inverseDirection[axis];
+			float t2 = (box.max[axis] - ray.origin[axis]) * inverseDirection[axis];
+
+			entry = std::max(entry, std::min(t1, t2));
+			exit  = std::min(exit,  std::max(t1, t2));
+		}
+
+		if (exit < std::max(entry, 0.f) || entry > maxDistance)
+			return -1.f;
+
+		return std::max(entry, 0.f);
+	}
+}
@@ -2,9 +2,89 @@
 #include <lunar/core/gameobject.hpp>
 #include <lunar/core/component.hpp>
 #include <lunar/script/script_vm.hpp>
+#include <unordered_map>
+#include <typeindex>
+#include <algorithm>
+#include <mutex>
 
 namespace lunar
 {
+	namespace imp
+	{
+		struct ComponentTypeRegistry
+		{
+			std::mutex                                           lock  = {};
+			std::unordered_map<std::type_index, ComponentTypeId> types = {};
+		};
+
+		ComponentTypeRegistry& GetComponentTypeRegistry()
+		{
+			static ComponentTypeRegistry registry = {};
+			return registry;
+		}
+	}
+
+	/*
+		Ids never change once assigned, so every thread keeps its own copy of the
+		ones it has asked for; the registry lock is only taken on a thread's first
+		lookup of a given class.
+	*/
+	ComponentTypeId GetComponentTypeId(const std::type_info& type)
+	{
+		thread_local std::unordered_map<std::type_index, ComponentTypeId> THREAD_TYPES = {};
+
+		auto cached = THREAD_TYPES.find(type);
+		if (cached != THREAD_TYPES.end())
+			return cached->second;
+
+		auto& registry = imp::GetComponentTypeRegistry();
+		auto  guard    = std::lock_guard(registry.lock);
+
+		auto [it, inserted] = registry.types.try_emplace(type, static_cast<ComponentTypeId>(registry.types.size()));
+		THREAD_TYPES.emplace(type, it->second);
+		return it->second;
+	}
+
+	size_t GetComponentTypeCount()
+	{
+		auto& registry = imp::GetComponentTypeRegistry();
+		auto  guard    = std::lock_guard(registry.lock);
+		return registry.types.size();
+	}
+
+	bool ComponentAccess::isThreadSafe() const
+	{
+		return flags & ComponentAccessFlagBits::eThreadSafe;
+	}
+
+	/*
+		Two classes conflict when one of them writes something the other reads or
+		writes. Conflicting classes are never updated concurrently.
+	*/
+	bool ComponentAccess::conflictsWith(const ComponentAccess& other) const
+	{
+		auto overlaps = [](const vector<ComponentTypeId>& a, const vector<ComponentTypeId>& b) {
+			return std::ranges::any_of(a, [&b](ComponentTypeId id) { return std::ranges::find(b, id) != b.end(); });
+		};
+
+		bool this_writes_transform  = flags & ComponentAccessFlagBits::eWriteTransform;
+		bool other_writes_transform = other.flags & ComponentAccessFlagBits::eWriteTransform;
+		bool this_uses_transform    = this_writes_transform || (flags & ComponentAccessFlagBits::eReadTransform);
+		bool other_uses_transform   = other_writes_transform || (other.flags & ComponentAccessFlagBits::eReadTransform);
+
+		if ((this_writes_transform && other_uses_transform) || (other_writes_transform && this_uses_transform))
+			return true;
+
+		return overlaps(writes, other.reads)
+			|| overlaps(writes, other.writes)
+			|| overlaps(other.writes, reads);
+	}
+
+	ComponentAccess Component_T::getAccess() const
+	{
+		return {};
+	}
+
 	Component_T::Component_T(GameObject parent) noexcept
 		: gameObject(parent),
 		scene(parent->getScene())
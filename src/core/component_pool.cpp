@@ -0,0 +1,175 @@
+#include <lunar/core/component_pool.hpp>
+#include <lunar/debug/assert.hpp>
+#include <algorithm>
+#include <new>
+
+namespace lunar
+{
+	namespace imp
+	{
+		BlockArena::BlockArena(size_t blocksPerChunk) noexcept
+			: blocksPerChunk(blocksPerChunk),
+			chunkUsed(blocksPerChunk)
+		{
+		}
+
+		BlockArena::~BlockArena() noexcept
+		{
+			for (void* chunk : chunks)
+				::operator delete(chunk, std::align_val_t(blockAlign));
+		}
+
+		void* BlockArena::allocate(size_t size, size_t align)
+		{
+			auto guard = std::lock_guard(lock);
+
+			if (blockSize == 0)
+			{
+				blockAlign = std::max(align, alignof(FreeBlock));
+				blockSize  = std::max(size, sizeof(FreeBlock));
+				blockSize  = (blockSize + blockAlign - 1) / blockAlign * blockAlign;
+			}
+
+			DEBUG_ASSERT(size <= blockSize && align <= blockAlign, "BlockArena used with more than one object size.");
+
+			if (freeList != nullptr)
+			{
+				FreeBlock* block = freeList;
+				freeList = block->next;
+				return block;
+			}
+
+			if (chunkUsed == blocksPerChunk)
+			{
+				chunks.push_back(::operator new(blockSize * blocksPerChunk, std::align_val_t(blockAlign)));
+				chunkUsed = 0;
+			}
+
+			auto* chunk = static_cast<std::byte*>(chunks.back());
+			return chunk + blockSize * chunkUsed++;
+		}
+
+		void BlockArena::deallocate(void* block)
+		{
+			auto guard = std::lock_guard(lock);
+
+			auto* free_block = static_cast<FreeBlock*>(block);
+			free_block->next = freeList;
+			freeList         = free_block;
+		}
+	}
+
+	ComponentPool::ComponentPool(ComponentTypeId typeId, const std::type_info& type) noexcept
+		: typeId(typeId),
+		type(&type),
+		arena(std::make_shared<imp::BlockArena>())
+	{
+	}
+
+	ComponentTypeId ComponentPool::getTypeId() const
+	{
+		return typeId;
+	}
+
+	const std::type_info& ComponentPool::getType() const
+	{
+		return *type;
+	}
+
+	size_t ComponentPool::size() const
+	{
+		return items.size();
+	}
+
+	bool ComponentPool::contains(size_t object) const
+	{
+		return object < sparse.size() && sparse[object] != npos;
+	}
+
+	Component_T* ComponentPool::get(size_t object)
+	{
+		if (!contains(object))
+			return nullptr;
+
+		return items[sparse[object]];
+	}
+
+	Component ComponentPool::getRef(size_t object)
+	{
+		if (!contains(object))
+			return nullptr;
+
+		return refs[sparse[object]];
+	}
+
+	Component_T* ComponentPool::at(size_t denseIndex)
+	{
+		return items[denseIndex];
+	}
+
+	size_t ComponentPool::ownerAt(size_t denseIndex) const
+	{
+		return owners[denseIndex];
+	}
+
+	std::span<Component_T* const> ComponentPool::getComponents() const
+	{
+		return items;
+	}
+
+	std::span<const size_t> ComponentPool::getOwners() const
+	{
+		return owners;
+	}
+
+	/*
+		Resolved from the first component that enters the pool; every component
+		in a pool has the same class, so they all declare the same access.
+	*/
+	const ComponentAccess& ComponentPool::getAccess() const
+	{
+		return access;
+	}
+
+	void ComponentPool::insert(size_t object, Component component)
+	{
+		DEBUG_ASSERT(!contains(object), "There can exist only one component of a given type on a single gameobject.");
+		DEBUG_ASSERT(typeid(*component) == *type);
+
+		if (!hasAccess)
+		{
+			access = component->getAccess();
+			access.writes.push_back(typeId);
+			hasAccess = true;
+		}
+
+		if (object >= sparse.size())
+			sparse.resize(object + 1, npos);
+
+		sparse[object] = items.size();
+		owners.push_back(object);
+		items.push_back(component.get());
+		refs.push_back(std::move(component));
+	}
+
+	void ComponentPool::erase(size_t object)
+	{
+		DEBUG_ASSERT(contains(object));
+
+		size_t removed = sparse[object];
+		size_t last    = items.size() - 1;
+
+		if (removed != last)
+		{
+			owners[removed]         = owners[last];
+			items[removed]          = items[last];
+			refs[removed]           = std::move(refs[last]);
+			sparse[owners[removed]] = removed;
+		}
+
+		sparse[object] = npos;
+		owners.pop_back();
+		items.pop_back();
+		refs.pop_back();
+	}
+}
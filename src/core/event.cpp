@@ -1,63 +1,125 @@
 #include <lunar/core/event.hpp>
 #include <lunar/debug.hpp>
+#include <unordered_map>
+#include <typeindex>
+#include <mutex>
 
 namespace lunar
 {
-	void EventHandler::addEventListener(size_t type, EventListener listener)
+	namespace imp
 	{
-		auto& e_type_data = listeners[type];
-		for (size_t i = 0; i < imp::MAX_LISTENERS; i++)
+		struct EventTypeRegistry
 		{
-			auto& cb = e_type_data.callbacks[i];
-			if (!cb)
-			{
-				cb = listener;
-				return;
-			}
+			std::mutex                                       lock  = {};
+			std::unordered_map<std::type_index, EventTypeId> types = {};
+		};
+
+		EventTypeRegistry& GetEventTypeRegistry()
+		{
+			static EventTypeRegistry registry = {};
+			return registry;
 		}
+	}
+
+	EventTypeId GetEventTypeId(const std::type_info& type)
+	{
+		auto& registry = imp::GetEventTypeRegistry();
+		auto  guard    = std::lock_guard(registry.lock);
 
-		DEBUG_ASSERT(true, "Too many callbacks added to event!");
-		throw;
+		auto [it, inserted] = registry.types.try_emplace(type, static_cast<EventTypeId>(registry.types.size()));
+		return it->second;
 	}
 
-	template<typename T, typename... U>
-	size_t getAddress(std::function<T(U...)>& f)
+	EventBus::ListenerList& EventBus::getList(EventTypeId type)
 	{
-		typedef T(fnType)(U...);
-		fnType** fn_ptr = f.template target<fnType*>();
-		return (size_t)*fn_ptr;
+		if (type >= lists.size())
+			lists.resize(type + 1);
+
+		if (lists[type] == nullptr)
+			lists[type] = std::make_unique<ListenerList>();
+
+		return *lists[type];
+	}
+
+	ListenerId EventBus::addListener(EventTypeId type, imp::StoredListener listener)
+	{
+		auto& list = getList(type);
+		auto  id   = ListenerId{ type, nextSerial++ };
+
+		// Growing the array mid-dispatch would move the callable that is currently running
+		if (list.dispatching > 0)
+			list.added.push_back(Listener{ id, std::move(listener) });
+		else
+			list.listeners.push_back(Listener{ id, std::move(listener) });
+
+		return id;
 	}
 
-	void EventHandler::removeEventListener(size_t type, EventListener listener)
+	void EventBus::removeEventListener(ListenerId id)
 	{
-		size_t address = getAddress(listener);
+		if (id.type >= lists.size() || lists[id.type] == nullptr)
+			return;
 
-		auto& e_type_data = listeners[type];
-		for (size_t i = 0; i < imp::MAX_LISTENERS; i++)
+		auto& list = *lists[id.type];
+		for (auto* listeners : { &list.listeners, &list.added })
 		{
-			auto& cb = e_type_data.callbacks[i];
-			if (getAddress(cb) == address)
+			for (size_t i = 0; i < listeners->size(); i++)
 			{
-				cb = nullptr;
+				auto& listener = (*listeners)[i];
+				if (listener.id != id)
+					continue;
+
+				if (list.dispatching > 0)
+				{
+					// The callable may be the one currently running; it is dropped once the dispatch unwinds
+					listener.removed = true;
+					list.hasRemoved  = true;
+				}
+				else
+					listeners->erase(listeners->begin() + i);
+
 				return;
 			}
 		}
 
-		DEBUG_ASSERT(true, "removeEventListener called on invalid function");
+		DEBUG_WARN("removeEventListener called with an unknown listener id.");
 	}
 
-	void EventHandler::fireEvent(size_t type, Event& e)
+	void EventBus::dispatch(ListenerList& list, Event& e)
 	{
-		auto it = listeners.find(type);
-		if (it == listeners.end())
-			return;
+		list.dispatching++;
 
-		auto& e_type_data = it->second;
-		for (size_t i = 0; i < imp::MAX_LISTENERS; i++)
+		size_t count = list.listeners.size();
+		for (size_t i = 0; i < count; i++)
 		{
-			auto& cb = e_type_data.callbacks[i];
-			if (cb)
-				cb(e);
+			auto& listener = list.listeners[i];
+			if (!listener.removed)
+				listener.callback(e);
 		}
+
+		if (--list.dispatching == 0)
+			compact(list);
+	}
+
+	void EventBus::compact(ListenerList& list)
+	{
+		if (list.hasRemoved)
+		{
+			std::erase_if(list.listeners, [](const Listener& listener) { return listener.removed; });
+			list.hasRemoved = false;
+		}
+
+		for (auto& listener : list.added)
+			if (!listener.removed)
+				list.listeners.push_back(std::move(listener));
+
+		list.added.clear();
+	}
+
+	void EventBus::flushEvents()
+	{
+		for (size_t i = 0; i < lists.size(); i++)
+			if (lists[i] != nullptr && lists[i]->queue != nullptr)
+				lists[i]->queue->dispatchAll(*this);
 	}
 }
@@ -0,0 +1,203 @@
+#include <lunar/core/frame_runner.hpp>
+#include <lunar/core/scene.hpp>
+#include <lunar/core/time.hpp>
+#include <lunar/debug/assert.hpp>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+namespace lunar
+{
+	void imp::TransformSnapshot::capture(Scene& scene)
+	{
+		std::fill(ids.begin(), ids.end(), 0);
+
+		for (auto& object : scene.getGameObjects())
+		{
+			if (object.isPendingDelete())
+				continue;
+
+			uint32_t slot = object.getSlotId().index;
+			if (slot >= ids.size())
+			{
+				positions.resize(slot + 1);
+				rotations.resize(slot + 1);
+				scales.resize(slot + 1);
+				parents.resize(slot + 1, NO_PARENT);
+				ids.resize(slot + 1, 0);
+			}
+
+			const auto& transform = std::as_const(object).getTransform();
+			GameObject  parent    = object.getParent();
+
+			positions[slot] = transform.position;
+			rotations[slot] = glm::quat(glm::radians(transform.rotation));
+			scales[slot]    = transform.scale;
+			parents[slot]   = parent == nullptr ? NO_PARENT : parent->getSlotId().index;
+			ids[slot]       = object.getId();
+		}
+	}
+
+	bool imp::TransformSnapshot::contains(const GameObject_T& object) const
+	{
+		uint32_t slot = object.getSlotId().index;
+		return slot < ids.size() && ids[slot] == object.getId();
+	}
+
+	float FrameInterpolation::getAlpha() const
+	{
+		return alpha;
+	}
+
+	/*
+		Objects that did not exist in both snapshots (created or deleted during the
+		last step), or whose ancestry changed in between, are drawn where they
+		currently are. Costs one matrix product per ancestor.
+	*/
+	glm::mat4 FrameInterpolation::getWorldTransform(const GameObject_T& object) const
+	{
+		auto world = glm::mat4(1.f);
+		if (!previous.contains(object) || !current.contains(object) || !interpolate(object.getSlotId().index, world))
+			return object.getWorldTransform();
+
+		return world;
+	}
+
+	/* Same composition as GameObject_T::getLocalTransform(), applied to the interpolated locals up the hierarchy. */
+	bool FrameInterpolation::interpolate(uint32_t slot, glm::mat4& world) const
+	{
+		uint32_t parent = current.parents[slot];
+		if (previous.parents[slot] != parent)
+			return false;
+
+		auto parent_world = glm::mat4(1.f);
+		if (parent != imp::TransformSnapshot::NO_PARENT)
+		{
+			bool same_parent = parent < previous.ids.size() && parent < current.ids.size()
+				&& current.ids[parent] != 0 && previous.ids[parent] == current.ids[parent];
+
+			if (!same_parent || !interpolate(parent, parent_world))
+				return false;
+		}
+
+		auto position = glm::mix(previous.positions[slot], current.positions[slot], alpha);
+		auto rotation = glm::slerp(previous.rotations[slot], current.rotations[slot], alpha);
+		auto scale    = glm::mix(previous.scales[slot], current.scales[slot], alpha);
+
+		auto local = glm::mat4_cast(rotation);
+		local[0]  *= scale.x;
+		local[1]  *= scale.y;
+		local[2]  *= scale.z;
+		local[3]   = glm::vec4(position, 1.f);
+
+		world = parent_world * local;
+		return true;
+	}
+
+	FrameRunner::FrameRunner(Scene& scene) noexcept
+		: scene(&scene)
+	{
+	}
+
+	FrameRunner& FrameRunner::useFixedRate(double stepsPerSecond)
+	{
+		DEBUG_ASSERT(stepsPerSecond > 0.0);
+		this->fixedDelta = 1.0 / stepsPerSecond;
+		return *this;
+	}
+
+	FrameRunner& FrameRunner::useMaxSubsteps(uint32_t count)
+	{
+		DEBUG_ASSERT(count > 0);
+		this->maxSubsteps = count;
+		return *this;
+	}
+
+	FrameRunner& FrameRunner::useMaxFrameTime(double seconds)
+	{
+		this->maxFrameTime = seconds;
+		return *this;
+	}
+
+	uint32_t FrameRunner::tick()
+	{
+		Time::Update();
+		return advance(Time::DeltaTime());
+	}
+
+	uint32_t FrameRunner::advance(double frameTime)
+	{
+		// Breakpoints and window drags would otherwise be caught up all at once
+		if (frameTime > maxFrameTime)
+		{
+			droppedTime += frameTime - maxFrameTime;
+			frameTime    = maxFrameTime;
+		}
+
+		accumulator  += std::max(frameTime, 0.0);
+		lastStepCount = 0;
+
+		auto   time        = Time::GetGlobalContext();
+		double frame_delta = time->deltaTime;
+		time->deltaTime    = fixedDelta;
+
+		while (accumulator >= fixedDelta && lastStepCount < maxSubsteps)
+		{
+			step();
+			accumulator -= fixedDelta;
+			lastStepCount++;
+		}
+
+		time->deltaTime = frame_delta;
+
+		// Whole steps left over after hitting the cap are dropped, the fraction is kept for interpolation
+		if (accumulator >= fixedDelta)
+		{
+			double excess = accumulator - std::fmod(accumulator, fixedDelta);
+			droppedTime  += excess;
+			accumulator  -= excess;
+		}
+
+		interpolation.alpha = hasSnapshot
+			? static_cast<float>(accumulator / fixedDelta)
+			: 1.f;
+
+		return lastStepCount;
+	}
+
+	void FrameRunner::step()
+	{
+		// The state before the very first step is what the first frame interpolates from
+		if (!hasSnapshot)
+		{
+			interpolation.current.capture(*scene);
+			hasSnapshot = true;
+		}
+
+		scene->update();
+		scene->physicsUpdate(fixedDelta);
+
+		std::swap(interpolation.previous, interpolation.current);
+		interpolation.current.capture(*scene);
+	}
+
+	double FrameRunner::getFixedDeltaTime() const
+	{
+		return fixedDelta;
+	}
+
+	double FrameRunner::getDroppedTime() const
+	{
+		return droppedTime;
+	}
+
+	uint32_t FrameRunner::getLastStepCount() const
+	{
+		return lastStepCount;
+	}
+
+	const FrameInterpolation& FrameRunner::getInterpolation() const
+	{
+		return interpolation;
+	}
+}
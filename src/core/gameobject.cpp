@@ -1,13 +1,17 @@
 #include <lunar/core/gameobject.hpp>
 #include <lunar/core/component.hpp>
 #include <lunar/core/scene.hpp>
+#include <lunar/render/components.hpp>
 #include <lunar/debug/log.hpp>
 #include <functional>
+#include <algorithm>
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <atomic>
+#include <cstring>
+#include <cmath>
 #include <map>
 
 namespace lunar
@@ -35,24 +39,66 @@ namespace lunar
 		return scene;
 	}
 
+	SlotId GameObject_T::getSlotId() const
+	{
+		return slotId;
+	}
+
+	uint64_t GameObject_T::getStableId() const
+	{
+		return stableId;
+	}
+
+	void GameObject_T::setStableId(uint64_t stableId)
+	{
+		this->stableId = stableId;
+	}
+
+	size_t GameObject_T::getSlot() const
+	{
+		return slotId.index;
+	}
+
+	ComponentPool& GameObject_T::getComponentPool(ComponentTypeId typeId, const std::type_info& ty)
+	{
+		return scene->getComponentPool(typeId, ty);
+	}
+
+	Component_T* GameObject_T::getComponent(ComponentTypeId typeId) const
+	{
+		if (typeId >= componentIndex.size() || componentIndex[typeId] == 0)
+			return nullptr;
+
+		return components[componentIndex[typeId] - 1];
+	}
+
 	Component GameObject_T::getComponent(const std::type_info& ty)
 	{
-		for (auto& component : scene->components)
+		ComponentTypeId type_id = GetComponentTypeId(ty);
+		if (getComponent(type_id) == nullptr)
+			return nullptr;
+
+		return scene
+			->findComponentPool(type_id)
+			->getRef(getSlot());
+	}
+
+	/* Allocates; getComponentList() is the allocation-free equivalent. */
+	std::vector<Component> GameObject_T::getComponents()
+	{
+		auto result = std::vector<Component>(components.size());
+		for (ComponentTypeId type_id = 0; type_id < componentIndex.size(); type_id++)
 		{
-			if (typeid(*component).hash_code() == ty.hash_code() && component->getGameObject()->getId() == id)
-				return component;
+			if (componentIndex[type_id] != 0)
+				result[componentIndex[type_id] - 1] = scene->findComponentPool(type_id)->getRef(getSlot());
 		}
 
-		return nullptr;
+		return result;
 	}
 
-	std::vector<Component> GameObject_T::getComponents()
+	std::span<Component_T* const> GameObject_T::getComponentList() const
 	{
-		auto list = std::vector<Component>();
-		for (auto& component : scene->components)
-			if (component->getGameObject() == this)
-				list.emplace_back(component);
-		return list;
+		return components;
 	}
 
 	std::string_view GameObject_T::getName() const
@@ -67,11 +113,53 @@ namespace lunar
 
 	Component_T* GameObject_T::addComponent(Component created)
 	{
-		auto& comp       = scene->components.emplace_back(created);
-		comp->gameObject = make_handle(scene->objects, this);
-		comp->scene      = scene;
+		Component_T*    comp    = created.get();
+		ComponentTypeId type_id = GetComponentTypeId(typeid(*comp));
+		comp->gameObject        = getHandle();
+		comp->scene             = scene;
+
+		DEBUG_ASSERT(getComponent(type_id) == nullptr, "There can exist only one component of a given type on a single gameobject.");
+
+		scene
+			->getComponentPool(type_id, typeid(*comp))
+			.insert(getSlot(), std::move(created));
+
+		if (type_id >= componentIndex.size())
+			componentIndex.resize(type_id + 1, 0);
+
+		components.push_back(comp);
+		componentIndex[type_id] = static_cast<uint32_t>(components.size());
+		scene->queueSpatialEntry(getSlot(), type_id);
+
 		comp->start();
-		return comp.get();
+		return comp;
+	}
+
+	/*
+		Destroys the component immediately. Must not be called while the scene is
+		iterating the component's pool (i.e. from inside Scene::update()).
+	*/
+	void GameObject_T::removeComponent(ComponentTypeId typeId)
+	{
+		Component_T* component = getComponent(typeId);
+		if (component == nullptr)
+			return;
+
+		if (scene->mainCamera != nullptr && static_cast<Component_T*>(scene->mainCamera) == component)
+			scene->mainCamera = nullptr;
+
+		uint32_t position = componentIndex[typeId] - 1;
+		components.erase(components.begin() + position);
+		componentIndex[typeId] = 0;
+
+		for (uint32_t& index : componentIndex)
+		{
+			if (index > position)
+				index--;
+		}
+
+		scene->findComponentPool(typeId)->erase(getSlot());
+		scene->queueSpatialEntry(getSlot(), typeId);
 	}
 
 	GameObject GameObject_T::createChildObject(const std::string_view& name)
@@ -79,58 +167,270 @@ namespace lunar
 		return getScene()->createGameObject(name, this);
 	}
 
-	std::vector<GameObject> GameObject_T::getChildren()
+	GameObject GameObject_T::getHandle()
 	{
-		auto  children = std::vector<GameObject>();
-		auto& objects  = getScene()->objects;
-		for (auto& object : objects)
-			if (object.parent == this)
-				children.push_back(make_handle(objects, &object));
-		return children;
+		return make_handle(scene->objects, slotId);
 	}
 
-	void GameObject_T::update()
+	GameObject_T::ChildRange GameObject_T::getChildren()
 	{
+		return ChildRange{ ChildIterator(firstChild), ChildIterator(nullptr) };
+	}
 
+	GameObject_T::DescendantRange GameObject_T::getDescendants()
+	{
+		GameObject self = getHandle();
+		return DescendantRange{ DescendantIterator(self, firstChild), DescendantIterator(self, nullptr) };
 	}
 
-	glm::mat4 GameObject_T::getWorldTransform() const
+	size_t GameObject_T::getChildCount() const
 	{
-		auto scale       = getWorldScale();
-		auto rotation    = getWorldRotation();
-		auto position    = getWorldPos();
-		auto scale_mat   = glm::scale(glm::mat4(1.f), scale);
-		auto translation = glm::translate(glm::mat4(1.f), position);
-		auto rot_mat     = glm::mat4(rotation);
-		return translation * rot_mat * scale_mat;
+		return childCount;
 	}
 
-	glm::vec3 GameObject_T::getWorldPos() const
+	uint32_t GameObject_T::getDepth() const
+	{
+		return depth;
+	}
+
+	bool GameObject_T::isDescendantOf(const GameObject_T* object) const
+	{
+		for (GameObject it = parent; it != nullptr; it = it->parent)
+			if (it.pointer() == object)
+				return true;
+
+		return false;
+	}
+
+	void GameObject_T::linkToParent()
 	{
 		if (parent == nullptr)
-			return transform.position;
+		{
+			depth = 0;
+			return;
+		}
+
+		GameObject self = getHandle();
+		prevSibling     = parent->lastChild;
+		nextSibling     = nullptr;
+
+		if (parent->lastChild != nullptr)
+			parent->lastChild->nextSibling = self;
 		else
-			return glm::vec3(
-				parent->getWorldTransform() * glm::vec4(transform.position, 1)
-			);
+			parent->firstChild = self;
+
+		parent->lastChild = self;
+		parent->childCount++;
+		depth = parent->depth + 1;
 	}
 
-	glm::quat GameObject_T::getWorldRotation() const
+	void GameObject_T::unlinkFromParent()
 	{
 		if (parent == nullptr)
-			return glm::quat(glm::radians(transform.rotation));
+			return;
+
+		if (prevSibling != nullptr)
+			prevSibling->nextSibling = nextSibling;
+		else
+			parent->firstChild = nextSibling;
+
+		if (nextSibling != nullptr)
+			nextSibling->prevSibling = prevSibling;
 		else
-			return glm::normalize(
-				parent->getWorldRotation() * glm::quat(glm::radians(transform.rotation))
-			);
+			parent->lastChild = prevSibling;
+
+		parent->childCount--;
+		parent      = nullptr;
+		prevSibling = nullptr;
+		nextSibling = nullptr;
 	}
 
-	glm::vec3 GameObject_T::getWorldScale() const
+	void GameObject_T::addTag(const std::string_view& tag)
+	{
+		if (hasTag(tag))
+			return;
+
+		scene->addToTagIndex(*this, tag);
+	}
+
+	void GameObject_T::removeTag(const std::string_view& tag)
+	{
+		size_t entry = findTag(tag);
+		if (entry != tags.size())
+			scene->removeFromTagIndex(*this, entry);
+	}
+
+	bool GameObject_T::hasTag(const std::string_view& tag) const
 	{
+		return findTag(tag) != tags.size();
+	}
+
+	/* Index of the matching entry in `tags`, or tags.size() if the object does not carry the tag. */
+	size_t GameObject_T::findTag(const std::string_view& tag) const
+	{
+		size_t hash = lunar::imp::fnv1a_hash(tag);
+		for (size_t i = 0; i < tags.size(); i++)
+			if (tags[i].hash == hash && scene->tagBuckets[tags[i].bucket].name == tag)
+				return i;
+
+		return tags.size();
+	}
+
+	bool GameObject_T::isPendingDelete() const
+	{
+		return pendingDelete;
+	}
+
+	void GameObject_T::refreshDepth()
+	{
+		for (auto& descendant : getDescendants())
+			descendant.depth = descendant.parent->depth + 1;
+	}
+
+	void GameObject_T::setParent(GameObject newParent)
+	{
+		DEBUG_ASSERT(newParent == nullptr || newParent->getScene() == scene);
+		DEBUG_ASSERT(newParent == nullptr || (newParent.pointer() != this && !newParent->isDescendantOf(this)), "Cannot parent an object to itself or to one of its descendants.");
+
+		unlinkFromParent();
+		parent = newParent;
+		linkToParent();
+		refreshDepth();
+
+		transformDirty = true;
+	}
+
+	void GameObject_T::update()
+	{
+
+	}
+
+	glm::mat4 GameObject_T::getLocalTransform() const
+	{
+		auto scale_mat   = glm::scale(glm::mat4(1.f), transform.scale);
+		auto translation = glm::translate(glm::mat4(1.f), transform.position);
+		auto rot_mat     = glm::mat4(glm::quat(glm::radians(transform.rotation)));
+		return translation * rot_mat * scale_mat;
+	}
+
+	void GameObject_T::markTransformDirty()
+	{
+		transformDirty = true;
+	}
+
+	/*
+		The scene's spatial index only refreshes objects that moved or gained or
+		lost a mesh renderer or a collider. Anything else that changes their local
+		bounds (assigning a mesh, resizing a collider) has to be reported here.
+	*/
+	void GameObject_T::markBoundsDirty()
+	{
+		scene->queueSpatialEntry(getSlot());
+	}
+
+	/*
+		Local transforms can also be edited in place through getTransform(), so a
+		changed transform is detected by comparing it with the one the cached
+		matrix was computed from.
+	*/
+	bool GameObject_T::isTransformStale() const
+	{
+		if (transformDirty || std::memcmp(&transform, &appliedTransform, sizeof(Transform)) != 0)
+			return true;
+
+		return parent != nullptr && parentVersion != parent->worldVersion;
+	}
+
+	/*
+		Recomputes the cached world matrix assuming the parent's cache is already
+		up to date. The object is stale if its own transform changed or if the
+		parent was recomputed since the last time this object was (detected through
+		the parent's version counter).
+	*/
+	void GameObject_T::updateWorldTransform()
+	{
+		if (!isTransformStale())
+			return;
+
 		if (parent == nullptr)
-			return transform.scale;
+			worldMatrix = getLocalTransform();
 		else
-			return transform.scale * parent->getWorldScale();
+		{
+			const GameObject_T& parent_object = parent.get();
+			worldMatrix   = parent_object.worldMatrix * getLocalTransform();
+			parentVersion = parent_object.worldVersion;
+		}
+
+		appliedTransform = transform;
+		transformDirty   = false;
+		worldVersion++;
+		scene->queueTrackedSpatialEntry(getSlot());
+	}
+
+	/*
+		The matrix computed by the last Scene::updateTransforms(), which runs at the
+		end of every Scene::update(). Changes made since then are not reflected.
+	*/
+	const glm::mat4& GameObject_T::getWorldTransform() const
+	{
+		return worldMatrix;
+	}
+
+	glm::vec3 GameObject_T::getWorldPos() const
+	{
+		return glm::vec3(getWorldTransform()[3]);
+	}
+
+	/*
+		Read off the cached matrix with the scale divided out. A zero scale on one
+		axis (e.g. an object hidden by scaling it flat) leaves that axis to be
+		rebuilt from the other two; with two or more such axes the rotation is
+		composed from the local rotations instead, as there is nothing left to
+		recover it from.
+	*/
+	glm::quat GameObject_T::getWorldRotation() const
+	{
+		constexpr float EPSILON = 1e-12f;
+
+		const auto& world = getWorldTransform();
+		glm::vec3   axes[3]    = { glm::vec3(world[0]), glm::vec3(world[1]), glm::vec3(world[2]) };
+		int         degenerate = -1;
+
+		for (int i = 0; i < 3; i++)
+		{
+			float length_sq = glm::dot(axes[i], axes[i]);
+			if (length_sq > EPSILON)
+			{
+				axes[i] /= std::sqrt(length_sq);
+				continue;
+			}
+
+			if (degenerate != -1)
+			{
+				auto rotation = glm::quat(glm::radians(transform.rotation));
+				for (GameObject it = parent; it != nullptr; it = it->parent)
+					rotation = glm::quat(glm::radians(it->transform.rotation)) * rotation;
+
+				return glm::normalize(rotation);
+			}
+
+			degenerate = i;
+		}
+
+		if (degenerate != -1)
+			axes[degenerate] = glm::normalize(glm::cross(axes[(degenerate + 1) % 3], axes[(degenerate + 2) % 3]));
+
+		return glm::normalize(glm::quat_cast(glm::mat3(axes[0], axes[1], axes[2])));
+	}
+
+	glm::vec3 GameObject_T::getWorldScale() const
+	{
+		const auto& world = getWorldTransform();
+		return glm::vec3(
+			glm::length(glm::vec3(world[0])),
+			glm::length(glm::vec3(world[1])),
+			glm::length(glm::vec3(world[2]))
+		);
 	}
 
 	glm::vec3 GameObject_T::getLocalPos() const
@@ -138,22 +438,34 @@ namespace lunar
 		return transform.position;
 	}
 
+	glm::vec3 GameObject_T::getLocalRotation() const
+	{
+		return transform.rotation;
+	}
+
+	glm::vec3 GameObject_T::getLocalScale() const
+	{
+		return transform.scale;
+	}
+
 	void GameObject_T::setWorldPos(glm::vec3 pos)
 	{
 		if (parent != nullptr)
 		{
-			auto parent_mat    = parent->getWorldTransform();
-			auto parent_inv    = glm::inverse(parent_mat);
+			auto parent_inv    = glm::inverse(parent->getWorldTransform());
 			auto local_pos     = parent_inv * glm::vec4(pos, 1.f);
 			transform.position = glm::vec3(local_pos);
 		}
 		else
 			transform.position = pos;
+
+		transformDirty = true;
 	}
 
 	void GameObject_T::setLocalPos(glm::vec3 pos)
 	{
 		transform.position = pos;
+		transformDirty     = true;
 	}
 
 	const Transform& GameObject_T::getTransform() const
@@ -161,6 +473,11 @@ namespace lunar
 		return transform;
 	}
 
+	/*
+		Writes through the returned reference are picked up by the next
+		Scene::updateTransforms(), which compares the transform with the one the
+		cached matrix was computed from; handing it out does not mark anything.
+	*/
 	Transform& GameObject_T::getTransform()
 	{
 		return transform;
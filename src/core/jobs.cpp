@@ -0,0 +1,336 @@
+#include <lunar/core/jobs.hpp>
+#include <lunar/debug.hpp>
+#include <condition_variable>
+#include <algorithm>
+#include <thread>
+#include <memory>
+#include <deque>
+
+#if defined(WIN32)
+#	include <Windows.h>
+#elif defined(__linux__)
+#	include <pthread.h>
+#	include <sched.h>
+#endif
+
+namespace lunar::Jobs::imp
+{
+	/*
+		Owner pushes and pops at the back (LIFO, keeps caches warm), thieves take
+		from the front. A plain mutex per deque is plenty at the job granularity
+		the engine schedules at.
+	*/
+	struct WorkQueue
+	{
+		std::mutex      lock  = {};
+		std::deque<Job> items = {};
+
+		void push(Job job)
+		{
+			auto guard = std::lock_guard(lock);
+			items.push_back(std::move(job));
+		}
+
+		bool pop(Job& out)
+		{
+			auto guard = std::lock_guard(lock);
+			if (items.empty())
+				return false;
+
+			out = std::move(items.back());
+			items.pop_back();
+			return true;
+		}
+
+		bool steal(Job& out)
+		{
+			auto guard = std::lock_guard(lock);
+			if (items.empty())
+				return false;
+
+			out = std::move(items.front());
+			items.pop_front();
+			return true;
+		}
+	};
+
+	struct Scheduler
+	{
+		vector<std::unique_ptr<WorkQueue>> workerQueues = {};
+		vector<std::thread>                threads      = {};
+		WorkQueue                          globalQueue  = {};
+		WorkQueue                          mainQueue    = {};
+		std::mutex                         sleepLock    = {};
+		std::condition_variable            sleepSignal  = {};
+		std::atomic<uint32_t>              queued       = 0;
+		std::atomic<bool>                  running      = false;
+		std::thread::id                    mainThread   = std::this_thread::get_id();
+
+		static Scheduler& Get();
+		static void       Push(Job job);
+		static bool       RunOne(bool allowMainThreadJobs);
+		static void       Execute(Job& job);
+		static void       AddContinuation(Counter_T& counter, Job job);
+		static void       WorkerLoop(uint32_t index);
+		static void       Pin(std::thread& thread, uint32_t core);
+	};
+
+	thread_local int32_t WORKER_INDEX = -1;
+
+	Scheduler& Scheduler::Get()
+	{
+		static Scheduler scheduler = {};
+		return scheduler;
+	}
+
+	void Scheduler::Push(Job job)
+	{
+		auto& scheduler = Get();
+
+		if (job.affinity == JobAffinity::eMainThread)
+		{
+			scheduler.mainQueue.push(std::move(job));
+			return;
+		}
+
+		// Jobs spawned from a worker stay on that worker's deque until someone steals them
+		if (WORKER_INDEX >= 0)
+			scheduler.workerQueues[WORKER_INDEX]->push(std::move(job));
+		else
+			scheduler.globalQueue.push(std::move(job));
+
+		scheduler.queued.fetch_add(1, std::memory_order_release);
+
+		// Taking the lock orders this against a worker that is about to go to sleep
+		{
+			auto guard = std::lock_guard(scheduler.sleepLock);
+		}
+		scheduler.sleepSignal.notify_one();
+	}
+
+	bool Scheduler::RunOne(bool allowMainThreadJobs)
+	{
+		auto& scheduler = Get();
+		Job   job       = {};
+		bool  found     = false;
+
+		if (allowMainThreadJobs && scheduler.mainQueue.steal(job))
+		{
+			Execute(job);
+			return true;
+		}
+
+		if (WORKER_INDEX >= 0)
+			found = scheduler.workerQueues[WORKER_INDEX]->pop(job);
+
+		if (!found)
+			found = scheduler.globalQueue.steal(job);
+
+		size_t worker_count = scheduler.workerQueues.size();
+		size_t first_victim = WORKER_INDEX >= 0 ? static_cast<size_t>(WORKER_INDEX) + 1 : 0;
+		for (size_t i = 0; !found && i < worker_count; i++)
+			found = scheduler.workerQueues[(first_victim + i) % worker_count]->steal(job);
+
+		if (!found)
+			return false;
+
+		scheduler.queued.fetch_sub(1, std::memory_order_acq_rel);
+		Execute(job);
+		return true;
+	}
+
+	void Scheduler::Execute(Job& job)
+	{
+		job.function();
+
+		if (job.signal != nullptr)
+			job.signal->decrement();
+	}
+
+	void Scheduler::AddContinuation(Counter_T& counter, Job job)
+	{
+		{
+			auto guard = std::lock_guard(counter.lock);
+			if (!counter.isDone())
+			{
+				counter.continuations.push_back(std::move(job));
+				return;
+			}
+		}
+
+		Push(std::move(job));
+	}
+
+	void Scheduler::WorkerLoop(uint32_t index)
+	{
+		auto& scheduler = Get();
+		WORKER_INDEX    = static_cast<int32_t>(index);
+
+		while (scheduler.running.load(std::memory_order_acquire))
+		{
+			if (RunOne(false))
+				continue;
+
+			auto lock = std::unique_lock(scheduler.sleepLock);
+			scheduler.sleepSignal.wait(lock, [&scheduler]() {
+				return scheduler.queued.load(std::memory_order_acquire) > 0 || !scheduler.running.load(std::memory_order_acquire);
+			});
+		}
+	}
+
+	void Scheduler::Pin(std::thread& thread, uint32_t core)
+	{
+#if defined(WIN32)
+		SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << core);
+#elif defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(core, &set);
+		if (pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &set) != 0)
+			DEBUG_WARN("Could not pin job worker to core {}.", core);
+#else
+		DEBUG_WARN("Thread pinning is not supported on this platform.");
+#endif
+	}
+}
+
+namespace lunar::Jobs
+{
+	void Counter_T::decrement()
+	{
+		if (pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+			return;
+
+		auto released = vector<imp::Job>();
+		{
+			auto guard = std::lock_guard(lock);
+			released.swap(continuations);
+		}
+
+		for (auto& job : released)
+			imp::Scheduler::Push(std::move(job));
+	}
+
+	void Initialize(const JobsConfig& config)
+	{
+		auto& scheduler = imp::Scheduler::Get();
+		DEBUG_ASSERT(!scheduler.running, "Job system is already initialized.");
+
+		uint32_t hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+		uint32_t worker_count     = config.workerCount != 0
+			? config.workerCount
+			: std::max(hardware_threads - 1, 1u);
+
+		scheduler.mainThread = std::this_thread::get_id();
+		scheduler.running    = true;
+		scheduler.workerQueues.clear();
+
+		for (uint32_t i = 0; i < worker_count; i++)
+			scheduler.workerQueues.push_back(std::make_unique<imp::WorkQueue>());
+
+		for (uint32_t i = 0; i < worker_count; i++)
+		{
+			scheduler.threads.emplace_back(imp::Scheduler::WorkerLoop, i);
+			if (config.pinThreads)
+				imp::Scheduler::Pin(scheduler.threads.back(), (i + 1) % hardware_threads);
+		}
+
+		DEBUG_LOG("Job system started with {} workers.", worker_count);
+	}
+
+	void Shutdown()
+	{
+		auto& scheduler = imp::Scheduler::Get();
+		if (!scheduler.running)
+			return;
+
+		{
+			auto guard = std::lock_guard(scheduler.sleepLock);
+			scheduler.running = false;
+		}
+		scheduler.sleepSignal.notify_all();
+
+		for (auto& thread : scheduler.threads)
+			thread.join();
+
+		scheduler.threads.clear();
+
+		// Whatever is left over is finished on the calling thread, so no counter is left hanging
+		while (imp::Scheduler::RunOne(true));
+
+		scheduler.workerQueues.clear();
+	}
+
+	uint32_t GetWorkerCount()
+	{
+		return static_cast<uint32_t>(imp::Scheduler::Get().threads.size());
+	}
+
+	int32_t GetWorkerIndex()
+	{
+		return imp::WORKER_INDEX;
+	}
+
+	bool IsMainThread()
+	{
+		return std::this_thread::get_id() == imp::Scheduler::Get().mainThread;
+	}
+
+	Counter Schedule(JobFunction job, JobAffinity affinity)
+	{
+		auto counter = std::make_shared<Counter_T>(1);
+		imp::Scheduler::Push(imp::Job{ std::move(job), affinity, counter });
+		return counter;
+	}
+
+	Counter Schedule(JobFunction job, const Counter& dependency, JobAffinity affinity)
+	{
+		if (dependency == nullptr)
+			return Schedule(std::move(job), affinity);
+
+		auto counter = std::make_shared<Counter_T>(1);
+		imp::Scheduler::AddContinuation(*dependency, imp::Job{ std::move(job), affinity, counter });
+		return counter;
+	}
+
+	Counter ParallelFor(size_t count, size_t grainSize, RangeFunction function)
+	{
+		grainSize = std::max<size_t>(grainSize, 1);
+
+		size_t chunk_count = (count + grainSize - 1) / grainSize;
+		auto   counter     = std::make_shared<Counter_T>(static_cast<uint32_t>(chunk_count));
+		auto   shared_fn   = std::make_shared<RangeFunction>(std::move(function));
+
+		for (size_t chunk = 0; chunk < chunk_count; chunk++)
+		{
+			size_t begin = chunk * grainSize;
+			size_t end   = std::min(begin + grainSize, count);
+			imp::Scheduler::Push(imp::Job{ [shared_fn, begin, end]() { (*shared_fn)(begin, end); }, JobAffinity::eAny, counter });
+		}
+
+		return counter;
+	}
+
+	void Wait(const Counter& counter)
+	{
+		if (counter == nullptr)
+			return;
+
+		bool main_thread = IsMainThread();
+		while (!counter->isDone())
+		{
+			if (!imp::Scheduler::RunOne(main_thread))
+				std::this_thread::yield();
+		}
+	}
+
+	void RunMainThreadJobs()
+	{
+		DEBUG_ASSERT(IsMainThread(), "Main-thread jobs can only be run from the main thread.");
+
+		auto& scheduler = imp::Scheduler::Get();
+		auto  job       = imp::Job();
+		while (scheduler.mainQueue.steal(job))
+			imp::Scheduler::Execute(job);
+	}
+}
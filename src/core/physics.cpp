@@ -0,0 +1,535 @@
+#include <lunar/core/physics.hpp>
+#include <lunar/core/scene.hpp>
+#include <lunar/debug/assert.hpp>
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/quaternion.hpp>
+
+namespace lunar
+{
+	extern reactphysics3d::PhysicsCommon PHYSICS_COMMON;
+
+	inline rp3d::Vector3 ToPhysics(const glm::vec3& vector)
+	{
+		return rp3d::Vector3(vector.x, vector.y, vector.z);
+	}
+
+	inline rp3d::BodyType ToPhysics(RigidBodyType type)
+	{
+		switch (type)
+		{
+		case RigidBodyType::eStatic:    return rp3d::BodyType::STATIC;
+		case RigidBodyType::eKinematic: return rp3d::BodyType::KINEMATIC;
+		default:                        return rp3d::BodyType::DYNAMIC;
+		}
+	}
+
+	/* rp3d bodies know nothing about the hierarchy, they are given world poses. */
+	inline rp3d::Transform ToPhysics(const glm::vec3& position, const glm::quat& rotation)
+	{
+		return rp3d::Transform(ToPhysics(position), rp3d::Quaternion(rotation.x, rotation.y, rotation.z, rotation.w));
+	}
+
+	/*
+		A pose pulled from rp3d comes back a few ulps off once it went through the
+		parent's inverse and the euler angles of the local transform; only larger
+		differences are edits that have to be pushed.
+	*/
+	inline bool IsSamePose(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& otherPosition, const glm::quat& otherRotation)
+	{
+		float tolerance = 1e-5f * std::max(1.f, glm::length(otherPosition));
+		return glm::length(position - otherPosition) <= tolerance
+			&& std::abs(glm::dot(rotation, otherRotation)) >= 1.f - 1e-6f;
+	}
+
+	RigidBody::RigidBody(RigidBodyType type) noexcept
+		: type(type)
+	{
+	}
+
+	RigidBody::~RigidBody() noexcept
+	{
+		if (collider != nullptr)
+			collider->release();
+
+		if (body != nullptr)
+		{
+			submit([world = world, body = body] {
+				world->destroyRigidBody(body);
+			});
+		}
+	}
+
+	/*
+		Calls into rp3d always go through the scene's queue, which is drained on
+		the main thread at the next sync point, while the world is known not to
+		be stepping. Only a body created by a scene ever submits anything.
+	*/
+	void RigidBody::submit(imp::PhysicsCommand command)
+	{
+		DEBUG_ASSERT(scene != nullptr, "RigidBody has no scene to submit physics commands to.");
+		scene->queuePhysicsCommand(std::move(command));
+	}
+
+	void RigidBody::create(rp3d::PhysicsWorld* world)
+	{
+		auto& object = getGameObject().get();
+
+		this->syncedPosition = object.getWorldPos();
+		this->syncedRotation = object.getWorldRotation();
+		this->world          = world;
+		this->body           = world->createRigidBody(ToPhysics(syncedPosition, syncedRotation));
+
+		body->setType(ToPhysics(type));
+		body->enableGravity(enableGravity);
+		body->setMass(mass);
+		body->setLinearVelocity(ToPhysics(velocity));
+		body->applyWorldForceAtCenterOfMass(ToPhysics(pendingForce));
+		body->applyWorldTorque(ToPhysics(pendingTorque));
+
+		pendingForce  = {};
+		pendingTorque = {};
+	}
+
+	RigidBodyType RigidBody::getType() const
+	{
+		return type;
+	}
+
+	void RigidBody::setType(RigidBodyType type)
+	{
+		this->type = type;
+		if (body != nullptr)
+		{
+			submit([body = body, type = ToPhysics(type)] {
+				body->setType(type);
+			});
+		}
+	}
+
+	bool RigidBody::isSleeping() const
+	{
+		return sleeping;
+	}
+
+	glm::vec3 RigidBody::getLinearVelocity() const
+	{
+		return velocity;
+	}
+
+	void RigidBody::setLinearVelocity(const glm::vec3& velocity)
+	{
+		this->velocity = velocity;
+		if (body != nullptr)
+		{
+			submit([body = body, velocity = ToPhysics(velocity)] {
+				body->setLinearVelocity(velocity);
+			});
+		}
+	}
+
+	void RigidBody::applyForce(const glm::vec3& force)
+	{
+		if (body == nullptr)
+		{
+			pendingForce += force;
+			return;
+		}
+
+		submit([body = body, force = ToPhysics(force)] {
+			body->applyWorldForceAtCenterOfMass(force);
+		});
+	}
+
+	void RigidBody::applyTorque(const glm::vec3& torque)
+	{
+		if (body == nullptr)
+		{
+			pendingTorque += torque;
+			return;
+		}
+
+		submit([body = body, torque = ToPhysics(torque)] {
+			body->applyWorldTorque(torque);
+		});
+	}
+
+	/* rp3d has no impulse API; an impulse is an instant velocity change of impulse / mass. */
+	void RigidBody::applyImpulse(const glm::vec3& impulse)
+	{
+		// The cached velocity is what a body gets created with
+		if (body == nullptr)
+		{
+			velocity += impulse / mass;
+			return;
+		}
+
+		submit([body = body, delta = ToPhysics(impulse / mass)] {
+			auto velocity = body->getLinearVelocity();
+			body->setLinearVelocity(rp3d::Vector3(velocity.x + delta.x, velocity.y + delta.y, velocity.z + delta.z));
+		});
+	}
+
+	Collider::Collider(ColliderShape shape) noexcept
+		: shape(shape)
+	{
+	}
+
+	Collider::Collider(Collider&& other) noexcept
+		: shape(other.shape),
+		halfExtents(other.halfExtents),
+		radius(other.radius),
+		height(other.height),
+		offset(other.offset),
+		isTrigger(other.isTrigger)
+	{
+		DEBUG_ASSERT(other.owner == nullptr, "An attached collider cannot be moved.");
+	}
+
+	Collider::~Collider() noexcept
+	{
+		release();
+	}
+
+	Collider Collider::Box(const glm::vec3& halfExtents)
+	{
+		auto collider        = Collider(ColliderShape::eBox);
+		collider.halfExtents = halfExtents;
+		return collider;
+	}
+
+	Collider Collider::Sphere(float radius)
+	{
+		auto collider   = Collider(ColliderShape::eSphere);
+		collider.radius = radius;
+		return collider;
+	}
+
+	Collider Collider::Capsule(float radius, float height)
+	{
+		auto collider   = Collider(ColliderShape::eCapsule);
+		collider.radius = radius;
+		collider.height = height;
+		return collider;
+	}
+
+	ColliderShape Collider::getShape() const
+	{
+		return shape;
+	}
+
+	Aabb Collider::getLocalBounds() const
+	{
+		glm::vec3 extents;
+		switch (shape)
+		{
+		case ColliderShape::eBox:     extents = halfExtents;                                       break;
+		case ColliderShape::eSphere:  extents = glm::vec3(radius);                                 break;
+		case ColliderShape::eCapsule: extents = glm::vec3(radius, height * 0.5f + radius, radius); break;
+		default:                      return {};
+		}
+
+		return Aabb{ offset - extents, offset + extents };
+	}
+
+	void Collider::attach(RigidBody& owner)
+	{
+		DEBUG_ASSERT(this->owner == nullptr && owner.body != nullptr);
+
+		switch (shape)
+		{
+		case ColliderShape::eBox:     rpShape = PHYSICS_COMMON.createBoxShape(ToPhysics(halfExtents)); break;
+		case ColliderShape::eSphere:  rpShape = PHYSICS_COMMON.createSphereShape(radius);              break;
+		case ColliderShape::eCapsule: rpShape = PHYSICS_COMMON.createCapsuleShape(radius, height);     break;
+		}
+
+		rpCollider = owner.body->addCollider(rpShape, rp3d::Transform(ToPhysics(offset), rp3d::Quaternion::identity()));
+		rpCollider->setIsTrigger(isTrigger);
+
+		// Keeps the configured mass, but derives the center of mass and inertia from the shape
+		owner.body->updateMassPropertiesFromColliders();
+		owner.body->setMass(owner.mass);
+
+		this->owner    = &owner;
+		owner.collider = this;
+	}
+
+	void Collider::release()
+	{
+		if (owner == nullptr)
+			return;
+
+		owner->submit([body = owner->body, collider = rpCollider, shape = rpShape, type = this->shape] {
+			body->removeCollider(collider);
+
+			switch (type)
+			{
+			case ColliderShape::eBox:     PHYSICS_COMMON.destroyBoxShape(static_cast<rp3d::BoxShape*>(shape));         break;
+			case ColliderShape::eSphere:  PHYSICS_COMMON.destroySphereShape(static_cast<rp3d::SphereShape*>(shape));   break;
+			case ColliderShape::eCapsule: PHYSICS_COMMON.destroyCapsuleShape(static_cast<rp3d::CapsuleShape*>(shape)); break;
+			}
+		});
+
+		owner->collider = nullptr;
+		owner           = nullptr;
+		rpCollider      = nullptr;
+		rpShape         = nullptr;
+	}
+
+	imp::PhysicsThread::PhysicsThread(rp3d::PhysicsWorld* world) noexcept
+		: world(world)
+	{
+		thread = std::thread([this] { run(); });
+	}
+
+	imp::PhysicsThread::~PhysicsThread() noexcept
+	{
+		{
+			auto guard = std::lock_guard(lock);
+			stop       = true;
+		}
+
+		kicked.notify_one();
+		thread.join();
+	}
+
+	void imp::PhysicsThread::kick(double dt, vector<PhysicsPose>* poses)
+	{
+		{
+			auto guard  = std::lock_guard(lock);
+			DEBUG_ASSERT(!busy, "A physics step is already in flight.");
+			this->dt    = dt;
+			this->poses = poses;
+			this->busy  = true;
+		}
+
+		kicked.notify_one();
+	}
+
+	void imp::PhysicsThread::wait()
+	{
+		auto guard = std::unique_lock(lock);
+		done.wait(guard, [this] { return !busy; });
+	}
+
+	void imp::PhysicsThread::run()
+	{
+		auto guard = std::unique_lock(lock);
+		while (true)
+		{
+			kicked.wait(guard, [this] { return busy || stop; });
+			if (stop)
+				return;
+
+			guard.unlock();
+			world->update(static_cast<rp3d::decimal>(dt));
+			CapturePhysicsPoses(*poses);
+			guard.lock();
+
+			busy = false;
+			done.notify_all();
+		}
+	}
+
+	void imp::CapturePhysicsPoses(vector<PhysicsPose>& poses)
+	{
+		for (auto& pose : poses)
+		{
+			pose.sleeping = pose.body->isSleeping();
+			if (!pose.dynamic || pose.sleeping)
+				continue;
+
+			auto& transform   = pose.body->getTransform();
+			auto& position    = transform.getPosition();
+			auto& orientation = transform.getOrientation();
+			auto  velocity    = pose.body->getLinearVelocity();
+
+			pose.position = glm::vec3(position.x, position.y, position.z);
+			pose.rotation = glm::quat(orientation.w, orientation.x, orientation.y, orientation.z);
+			pose.velocity = glm::vec3(velocity.x, velocity.y, velocity.z);
+		}
+	}
+
+	/*
+		Without a physics thread the world is stepped right here. With one, this
+		is the sync point: the step kicked off by the previous call is waited
+		for, queued commands and edited transforms are handed to rp3d, the next
+		step is kicked off, and only then are the poses of the finished step
+		applied, while the thread is already busy with the next one.
+	*/
+	void Scene::physicsUpdate(double dt)
+	{
+		physicsSync++;
+
+		if (physicsThread == nullptr)
+		{
+			auto& poses = physicsPoses[0];
+			runPhysicsCommands();
+			pushPhysicsTransforms(poses);
+			physicsWorld->update(static_cast<rp3d::decimal>(dt));
+			imp::CapturePhysicsPoses(poses);
+			pullPhysicsTransforms(poses);
+			return;
+		}
+
+		physicsThread->wait();
+		uint32_t finished = physicsBuffer;
+		physicsBuffer    ^= 1;
+
+		runPhysicsCommands();
+		pushPhysicsTransforms(physicsPoses[physicsBuffer]);
+		physicsThread->kick(dt, &physicsPoses[physicsBuffer]);
+		pullPhysicsTransforms(physicsPoses[finished]);
+	}
+
+	void Scene::usePhysicsThread(bool enabled)
+	{
+		if (enabled == isPhysicsThreaded())
+			return;
+
+		if (enabled)
+		{
+			// Poses captured inline still belong to the current buffer; start the thread on the other one
+			physicsPoses[physicsBuffer ^ 1].clear();
+			physicsBuffer ^= 1;
+			physicsThread  = std::make_unique<imp::PhysicsThread>(physicsWorld);
+			return;
+		}
+
+		physicsThread->wait();
+		physicsThread = nullptr;
+
+		pullPhysicsTransforms(physicsPoses[physicsBuffer]);
+		runPhysicsCommands();
+		physicsBuffer = 0;
+		physicsPoses[0].clear();
+	}
+
+	bool Scene::isPhysicsThreaded() const
+	{
+		return physicsThread != nullptr;
+	}
+
+	/* Blocks until the physics thread is idle; the world can then be accessed directly until the next physicsUpdate(). */
+	void Scene::waitForPhysics()
+	{
+		if (physicsThread != nullptr)
+			physicsThread->wait();
+	}
+
+	void Scene::queuePhysicsCommand(imp::PhysicsCommand command)
+	{
+		auto guard = std::lock_guard(physicsLock);
+		physicsCommands.push_back(std::move(command));
+	}
+
+	void Scene::runPhysicsCommands()
+	{
+		{
+			auto guard = std::lock_guard(physicsLock);
+			physicsRunning.swap(physicsCommands);
+		}
+
+		for (auto& command : physicsRunning)
+			command();
+
+		physicsRunning.clear();
+	}
+
+	/*
+		Pushes every transform that changed since the last sync (whether by game
+		code or by the previous pull) to rp3d, creating bodies and attaching
+		colliders that showed up since the last step. Also lists the bodies whose
+		poses the coming step has to capture.
+	*/
+	void Scene::pushPhysicsTransforms(vector<imp::PhysicsPose>& poses)
+	{
+		poses.clear();
+
+		ComponentPool* pool = findComponentPool(GetComponentTypeId<RigidBody>());
+		if (pool == nullptr)
+			return;
+
+		poses.reserve(pool->size());
+		for (Component_T* component : pool->getComponents())
+		{
+			auto& rigid_body = static_cast<RigidBody&>(*component);
+			auto& object     = rigid_body.gameObject.get();
+
+			if (rigid_body.body == nullptr)
+			{
+				rigid_body.create(physicsWorld);
+				rigid_body.pushedSync = physicsSync;
+			}
+			else
+			{
+				// World pose, so bodies also follow when only an ancestor moved
+				auto position = object.getWorldPos();
+				auto rotation = object.getWorldRotation();
+				if (!IsSamePose(position, rotation, rigid_body.syncedPosition, rigid_body.syncedRotation))
+				{
+					rigid_body.body->setTransform(ToPhysics(position, rotation));
+					rigid_body.syncedPosition = position;
+					rigid_body.syncedRotation = rotation;
+					rigid_body.pushedSync     = physicsSync;
+				}
+			}
+
+			if (rigid_body.collider == nullptr)
+			{
+				if (auto* collider = object.getComponent<Collider>())
+					collider->attach(rigid_body);
+			}
+
+			auto& pose   = poses.emplace_back();
+			pose.object  = object.getSlotId();
+			pose.body    = rigid_body.body;
+			pose.sync    = physicsSync;
+			pose.dynamic = rigid_body.type == RigidBodyType::eDynamic;
+		}
+	}
+
+	/*
+		Copies the poses of awake dynamic bodies back into their objects' local
+		transforms. Poses may be a step old, so bodies are looked up again: the
+		object or its RigidBody may have been deleted since, or the body may have
+		been pushed after the step the pose comes from started, in which case the
+		pose would undo that push.
+	*/
+	void Scene::pullPhysicsTransforms(const vector<imp::PhysicsPose>& poses)
+	{
+		for (auto& pose : poses)
+		{
+			GameObject_T* object = objects.find(pose.object);
+			if (object == nullptr || object->isPendingDelete())
+				continue;
+
+			auto* rigid_body = object->getComponent<RigidBody>();
+			if (rigid_body == nullptr || rigid_body->body != pose.body)
+				continue;
+
+			rigid_body->sleeping = pose.sleeping;
+			if (!pose.dynamic || pose.sleeping || rigid_body->pushedSync > pose.sync)
+				continue;
+
+			GameObject parent    = object->getParent();
+			auto       world_pos = pose.position;
+			auto       world_rot = pose.rotation;
+			if (parent.valid())
+			{
+				world_pos = glm::vec3(glm::inverse(parent->getWorldTransform()) * glm::vec4(world_pos, 1.f));
+				world_rot = glm::inverse(parent->getWorldRotation()) * world_rot;
+			}
+
+			auto& transform    = object->getTransform();
+			transform.position = world_pos;
+			transform.rotation = glm::degrees(glm::eulerAngles(world_rot));
+			object->markTransformDirty();
+
+			rigid_body->syncedPosition = pose.position;
+			rigid_body->syncedRotation = pose.rotation;
+			rigid_body->velocity       = pose.velocity;
+		}
+	}
+}
@@ -1,9 +1,12 @@
 #include <lunar/core/scene.hpp>
 #include <lunar/core/time.hpp>
+#include <lunar/core/jobs.hpp>
 #include <lunar/debug/log.hpp>
 #include <lunar/render/components.hpp>
 
 #include <reactphysics3d/reactphysics3d.h>
+#include <algorithm>
+#include <atomic>
 
 namespace lunar
 {
@@ -13,57 +16,399 @@ namespace lunar
 
 	Scene::Scene(const std::string_view& name) noexcept
 		: name(name),
-		physicsWorld(PHYSICS_COMMON.createPhysicsWorld())
+		physicsWorld(PHYSICS_COMMON.createPhysicsWorld()),
+		commandBuffers(Jobs::GetWorkerCount() + 1)
 	{
 
 	}
 
 	Scene::Scene() noexcept
-		: physicsWorld(PHYSICS_COMMON.createPhysicsWorld())
+		: physicsWorld(PHYSICS_COMMON.createPhysicsWorld()),
+		commandBuffers(Jobs::GetWorkerCount() + 1)
 	{
 	}
 
 	Scene::~Scene() noexcept
 	{
+		// Components queue their rp3d cleanup, so they go first, while the queue can still be drained
+		physicsThread = nullptr;
+		poolList.clear();
+		pools.clear();
+		runPhysicsCommands();
 	}
 
+	/*
+		Objects are numbered by their slot, which is creation order until an object
+		is deleted; the handle to a slot that is currently free is not valid().
+	*/
 	GameObject Scene::getGameObject(size_t number)
 	{
-		return make_handle(objects, number);
+		if (number >= objects.slotCount())
+			return nullptr;
+
+		return make_handle(objects, objects.getId(static_cast<uint32_t>(number)));
 	}
 
 	GameObject Scene::getGameObject(const std::string_view& name)
 	{
-		for (size_t i = 0; i < objects.size(); i++)
-			if (objects[i].getName().compare(name) == 0)
-				return make_handle(objects, i);
+		auto [begin, end] = nameIndex.equal_range(lunar::imp::fnv1a_hash(name));
+		for (auto it = begin; it != end; it++)
+			if (objects[it->second].getName().compare(name) == 0)
+				return make_handle(objects, it->second);
 
 		return nullptr;
 	}
 
+	vector<GameObject> Scene::getGameObjectsByPrefix(const std::string_view& prefix)
+	{
+		auto result = vector<GameObject>();
+		for (auto it = prefixIndex.lower_bound(prefix); it != prefixIndex.end() && objects[*it].getName().starts_with(prefix); it++)
+			result.push_back(make_handle(objects, *it));
+
+		return result;
+	}
+
+	vector<GameObject> Scene::getGameObjectsWithTag(const std::string_view& tag)
+	{
+		uint32_t bucket = findTagBucket(tag, lunar::imp::fnv1a_hash(tag));
+		if (bucket == UINT32_MAX)
+			return {};
+
+		auto result = vector<GameObject>();
+		for (SlotId id : tagBuckets[bucket].objects)
+			result.push_back(make_handle(objects, id));
+
+		return result;
+	}
+
+	void Scene::addToNameIndex(const GameObject_T& object)
+	{
+		nameIndex.emplace(object.nameHash, object.slotId);
+		prefixIndex.insert(object.slotId);
+	}
+
+	void Scene::removeFromNameIndex(const GameObject_T& object)
+	{
+		auto [hash_begin, hash_end] = nameIndex.equal_range(object.nameHash);
+		for (auto it = hash_begin; it != hash_end; it++)
+		{
+			if (it->second == object.slotId)
+			{
+				nameIndex.erase(it);
+				break;
+			}
+		}
+
+		prefixIndex.erase(object.slotId);
+	}
+
+	/* Index of the bucket holding the tag, or UINT32_MAX if no object ever carried it. */
+	uint32_t Scene::findTagBucket(const std::string_view& tag, size_t hash) const
+	{
+		auto [begin, end] = tagLookup.equal_range(hash);
+		for (auto it = begin; it != end; it++)
+			if (tagBuckets[it->second].name == tag)
+				return it->second;
+
+		return UINT32_MAX;
+	}
+
+	void Scene::addToTagIndex(GameObject_T& object, const std::string_view& tag)
+	{
+		size_t   hash   = lunar::imp::fnv1a_hash(tag);
+		uint32_t bucket = findTagBucket(tag, hash);
+
+		if (bucket == UINT32_MAX)
+		{
+			bucket = static_cast<uint32_t>(tagBuckets.size());
+			tagBuckets.push_back({ std::string(tag), {} });
+			tagLookup.emplace(hash, bucket);
+		}
+
+		auto& bucket_objects = tagBuckets[bucket].objects;
+		object.tags.push_back({ hash, bucket, static_cast<uint32_t>(bucket_objects.size()) });
+		bucket_objects.push_back(object.slotId);
+	}
+
+	/*
+		Swap-and-pop out of the bucket; the object that got moved into the hole
+		has its stored position patched up.
+	*/
+	void Scene::removeFromTagIndex(GameObject_T& object, size_t tagEntry)
+	{
+		auto  entry  = object.tags[tagEntry];
+		auto& bucket = tagBuckets[entry.bucket].objects;
+
+		if (entry.position != bucket.size() - 1)
+		{
+			SlotId moved_id = bucket.back();
+			bucket[entry.position] = moved_id;
+
+			for (auto& moved_entry : objects[moved_id].tags)
+				if (moved_entry.bucket == entry.bucket)
+					moved_entry.position = entry.position;
+		}
+
+		bucket.pop_back();
+		object.tags[tagEntry] = object.tags.back();
+		object.tags.pop_back();
+	}
+
 	GameObject Scene::createGameObject(const std::string_view& name, GameObject_T* parent)
+	{
+		return createObject(name, parent, false);
+	}
+
+	GameObject Scene::createObject(const std::string_view& name, GameObject_T* parent, bool queueCreatedEvent)
 	{
 		DEBUG_ASSERT(name.size() > 0);
 		DEBUG_ASSERT(parent == nullptr || parent->getScene() == this);
 
-		objects.emplace_back(this, name, parent == nullptr ? nullptr : make_handle(objects, parent));
+		SlotId     id     = objects.emplace(this, name, parent == nullptr ? nullptr : parent->getHandle());
+		GameObject handle = make_handle(objects, id);
+		handle->slotId    = id;
+		handle->linkToParent();
+		addToNameIndex(handle.get());
 		
-		GameObject handle = make_handle(objects);
 		auto       event  = Events::SceneObjectCreated(*this, handle);
 		
-		fireEvent(SceneEventType::eObjectCreated, event);
+		if (queueCreatedEvent)
+			queueEvent(event);
+		else
+			fireEvent(event);
+
+		return handle;
+	}
 
-		return make_handle(objects);
+	/*
+		Slot 0 belongs to the main thread, slot i + 1 to job worker i. Every slot is
+		only ever touched by its own thread between sync points, so no locking is
+		needed; buffers are allocated the first time their thread records.
+	*/
+	SceneCommandBuffer& Scene::getCommandBuffer()
+	{
+		int32_t worker = Jobs::GetWorkerIndex();
+		DEBUG_ASSERT(worker >= 0 || Jobs::IsMainThread(), "Command buffers can only be recorded on the main thread or on job workers.");
+
+		size_t slot = static_cast<size_t>(worker + 1);
+		DEBUG_ASSERT(slot < commandBuffers.size(), "The job system was started after this scene was created.");
+
+		auto& buffer = commandBuffers[slot];
+		if (buffer == nullptr)
+			buffer = std::make_unique<SceneCommandBuffer>();
+
+		return *buffer;
 	}
 
-	std::span<GameObject_T> Scene::getGameObjects()
+	/*
+		Sync point for every command buffer recorded since the last call. Storage
+		for all new objects is reserved once up front, and creation events are
+		queued so they go out as one batch with the next flushEvents().
+		Must not run while other threads are still recording.
+
+		Each buffer is swapped out before it is played back: component start()
+		and deletion listeners may record into the main-thread buffer, and those
+		commands then run at the next playback instead of invalidating this one.
+	*/
+	void Scene::playbackCommandBuffers()
+	{
+		size_t create_count = 0;
+		for (auto& buffer : commandBuffers)
+			if (buffer != nullptr)
+				create_count += buffer->createCount;
+
+		if (create_count > 0)
+			objects.reserve(objects.size() + create_count);
+
+		for (auto& buffer : commandBuffers)
+		{
+			if (buffer == nullptr || buffer->empty())
+				continue;
+
+			playbackBuffer.swap(*buffer);
+			playback(playbackBuffer);
+			playbackBuffer.clear();
+		}
+	}
+
+	void Scene::playback(SceneCommandBuffer& buffer)
+	{
+		using CommandType = SceneCommandBuffer::CommandType;
+
+		playbackResolved.assign(buffer.createCount, SlotId());
+		auto resolve = [this](const SceneCommandBuffer::ObjectRef& ref) {
+			return ref.isPending() ? playbackResolved[ref.pending] : ref.id;
+		};
+
+		for (auto& command : buffer.commands)
+		{
+			SlotId target = resolve(command.target);
+			if (command.type != CommandType::eCreate && !objects.contains(target))
+			{
+				DEBUG_WARN("Skipping scene command targeting an object that no longer exists.");
+				continue;
+			}
+
+			switch (command.type)
+			{
+			case CommandType::eCreate:
+			{
+				GameObject_T* parent  = objects.find(resolve(command.parent));
+				GameObject    created = createObject(buffer.names[command.payload], parent, true);
+				playbackResolved[command.target.pending] = created.getId();
+				break;
+			}
+			case CommandType::eDelete:
+				deleteGameObject(make_handle(objects, target));
+				break;
+			case CommandType::eAddComponent:
+				buffer.factories[command.payload](objects[target]);
+				break;
+			case CommandType::eSetTransform:
+				objects[target].getTransform() = buffer.transforms[command.payload];
+				break;
+			}
+		}
+	}
+
+	/*
+		Marks the object and its whole subtree for deletion and fires
+		SceneObjectDeleted for each of them, parent first. Nothing is unlinked or
+		destroyed until flushDeletions() runs at the end of the frame, so handles,
+		component pointers, pool iteration and hierarchy iteration in flight (e.g.
+		deleting every child while walking getChildren()) stay valid. Marked objects
+		are no longer updated, drawn or found by name or tag.
+	*/
+	void Scene::deleteGameObject(GameObject object)
+	{
+		if (!object.valid() || object->pendingDelete)
+			return;
+
+		DEBUG_ASSERT(object->getScene() == this);
+
+		markForDeletion(object.get());
+		for (auto& descendant : object->getDescendants())
+			if (!descendant.pendingDelete)
+				markForDeletion(descendant);
+	}
+
+	void Scene::markForDeletion(GameObject_T& object)
+	{
+		object.pendingDelete = true;
+		deletionQueue.push_back(object.slotId);
+
+		removeFromNameIndex(object);
+		while (!object.tags.empty())
+			removeFromTagIndex(object, object.tags.size() - 1);
+
+		auto handle = object.getHandle();
+		auto event  = Events::SceneObjectDeleted(*this, handle);
+		fireEvent(event);
+	}
+
+	void Scene::flushDeletions()
+	{
+		// Children attached to a marked object after it was marked go down with it
+		for (size_t i = 0; i < deletionQueue.size(); i++)
+			for (auto& descendant : objects[deletionQueue[i]].getDescendants())
+				if (!descendant.pendingDelete)
+					markForDeletion(descendant);
+
+		// Only the roots of deleted subtrees are detached; everything below them goes away too
+		for (SlotId id : deletionQueue)
+		{
+			GameObject_T& object = objects[id];
+			if (object.parent == nullptr || !object.parent->pendingDelete)
+				object.unlinkFromParent();
+		}
+
+		for (SlotId id : deletionQueue)
+		{
+			GameObject_T& object = objects[id];
+
+			if (mainCamera != nullptr && mainCamera->getGameObject().getId() == id)
+				mainCamera = nullptr;
+
+			for (ComponentTypeId type_id = 0; type_id < object.componentIndex.size(); type_id++)
+				if (object.componentIndex[type_id] != 0)
+					findComponentPool(type_id)->erase(id.index);
+
+			objects.erase(id);
+			queueTrackedSpatialEntry(id.index);
+		}
+
+		deletionQueue.clear();
+	}
+
+	SlotMap<GameObject_T>& Scene::getGameObjects()
 	{
 		return objects;
 	}
 
-	std::span<Component> Scene::getComponents()
+	void Scene::reserveGameObjects(size_t count)
 	{
-		return components;
+		objects.reserve(objects.size() + count);
+		nameIndex.reserve(nameIndex.size() + count);
+	}
+
+	ComponentPool* Scene::findComponentPool(ComponentTypeId typeId)
+	{
+		if (typeId >= pools.size())
+			return nullptr;
+
+		return pools[typeId].get();
+	}
+
+	ComponentPool* Scene::findComponentPool(const std::type_info& type)
+	{
+		return findComponentPool(GetComponentTypeId(type));
+	}
+
+	ComponentPool& Scene::getComponentPool(ComponentTypeId typeId, const std::type_info& type)
+	{
+		if (typeId >= pools.size())
+			pools.resize(typeId + 1);
+
+		auto& pool = pools[typeId];
+		if (pool == nullptr)
+		{
+			pool = std::make_unique<ComponentPool>(typeId, type);
+
+			auto position = std::ranges::upper_bound(poolList, typeId, {}, &ComponentPool::getTypeId);
+			poolList.insert(position, pool.get());
+		}
+
+		return *pool;
+	}
+
+	ComponentPool& Scene::getComponentPool(const std::type_info& type)
+	{
+		return getComponentPool(GetComponentTypeId(type), type);
+	}
+
+	std::span<ComponentPool* const> Scene::getComponentPools()
+	{
+		return poolList;
+	}
+
+	/*
+		Every component of the scene, pool by pool. Builds a new vector on each
+		call; prefer view<Ts...>() or getComponentPools() on hot paths.
+	*/
+	vector<Component> Scene::getComponents()
+	{
+		size_t count = 0;
+		for (ComponentPool* pool : poolList)
+			count += pool->size();
+
+		auto result = vector<Component>();
+		result.reserve(count);
+
+		for (ComponentPool* pool : poolList)
+			for (size_t i = 0; i < pool->size(); i++)
+				result.push_back(pool->getRef(pool->ownerAt(i)));
+
+		return result;
 	}
 
 	void Scene::setMainCamera(Camera* camera)
@@ -88,13 +433,202 @@ namespace lunar
 
 	void Scene::update()
 	{
-		for (auto& component : components)
-			component->update();
+		if (updateMode == SceneUpdateMode::eParallel)
+			updateParallel();
+		else
+			updateSequential();
+
+		playbackCommandBuffers();
+
+		// Deferred events go out while the objects they refer to are still alive
+		flushEvents();
+		flushDeletions();
+		updateTransforms();
+		updateSpatialIndex();
+	}
+
+	SceneUpdateMode Scene::getUpdateMode() const
+	{
+		return updateMode;
 	}
 
-	void Scene::physicsUpdate(double dt)
+	void Scene::setUpdateMode(SceneUpdateMode mode)
 	{
-		this->physicsWorld->update(dt);
+		updateMode = mode;
+	}
+
+	void Scene::updateSequential()
+	{
+		/*
+			Components are updated pool by pool (i.e. grouped by class, in the order
+			in which each class was first registered). Indices are used instead
+			of iterators since an update() call is allowed to add new components.
+		*/
+		for (size_t i = 0; i < pools.size(); i++)
+		{
+			ComponentPool* pool = pools[i].get();
+			if (pool == nullptr)
+				continue;
+
+			for (size_t j = 0; j < pool->size(); j++)
+				updateComponent(pool, j);
+		}
+	}
+
+	void Scene::updateComponent(ComponentPool* pool, size_t index)
+	{
+		// Deleted objects keep their components until flushDeletions(), but stop updating right away
+		if (!objects[objects.getId(static_cast<uint32_t>(pool->ownerAt(index)))].pendingDelete)
+			pool->at(index)->update();
+	}
+
+	/*
+		Pools are still visited in type id order. Consecutive thread-safe pools that
+		do not conflict with each other are gathered into a phase and updated
+		concurrently; a conflicting pool starts a new phase, so conflicting classes
+		always observe each other in the same order as in the sequential mode.
+		Pools that are not thread-safe act as barriers and run on the main thread.
+	*/
+	void Scene::updateParallel()
+	{
+		updatePhase.clear();
+
+		for (size_t i = 0; i < pools.size(); i++)
+		{
+			ComponentPool* pool = pools[i].get();
+			if (pool == nullptr || pool->size() == 0)
+				continue;
+
+			const auto& access = pool->getAccess();
+			if (!access.isThreadSafe())
+			{
+				runUpdatePhase();
+				for (size_t j = 0; j < pool->size(); j++)
+					updateComponent(pool, j);
+
+				continue;
+			}
+
+			bool conflicts = std::ranges::any_of(updatePhase, [&access](ComponentPool* other) {
+				return access.conflictsWith(other->getAccess());
+			});
+
+			if (conflicts)
+				runUpdatePhase();
+
+			updatePhase.push_back(pool);
+		}
+
+		runUpdatePhase();
+	}
+
+	void Scene::runUpdatePhase()
+	{
+		if (updatePhase.empty())
+			return;
+
+		/*
+			World matrices are only written here, never while the phase runs, so
+			every world-space read inside the phase sees the same flushed state and
+			world-space setters only end up writing the local transform.
+		*/
+		updateTransforms();
+
+		auto counters = vector<Jobs::Counter>();
+		counters.reserve(updatePhase.size());
+
+		for (ComponentPool* pool : updatePhase)
+		{
+			/*
+				A class that both reads and writes transforms may read what another
+				instance of it (e.g. on the parent object) is writing; its pool runs
+				as a single job, in order, still concurrently with the other pools.
+			*/
+			const auto& access = pool->getAccess();
+			bool        serial = (access.flags & ComponentAccessFlagBits::eReadTransform) && (access.flags & ComponentAccessFlagBits::eWriteTransform);
+			size_t      grain  = serial ? pool->size() : PARALLEL_UPDATE_GRAIN;
+
+			counters.push_back(Jobs::ParallelFor(pool->size(), grain, [this, pool](size_t begin, size_t end) {
+				for (size_t j = begin; j < end; j++)
+					updateComponent(pool, j);
+			}));
+		}
+
+		for (auto& counter : counters)
+			Jobs::Wait(counter);
+
+		updatePhase.clear();
+	}
+
+	/*
+		Single top-down pass over the hierarchy: every root is refreshed first, then
+		its subtree in pre-order, so a parent's cached matrix is always up to date by
+		the time its children look at it. Clean subtrees cost one comparison per object.
+	*/
+	void Scene::updateTransforms()
+	{
+		if (objects.size() >= TRANSFORM_BATCH_THRESHOLD)
+		{
+			updateTransformsBatched();
+			return;
+		}
+
+		for (auto& object : objects)
+		{
+			if (object.parent != nullptr)
+				continue;
+
+			object.updateWorldTransform();
+			for (auto& descendant : object.getDescendants())
+				descendant.updateWorldTransform();
+		}
+	}
+
+	/*
+		Objects are counting-sorted by hierarchy depth, so every parent is final
+		before any of its children is processed. Only stale objects are pushed into
+		the batch; clean parents are referenced through their cached matrix.
+	*/
+	void Scene::updateTransformsBatched()
+	{
+		uint32_t max_depth = 0;
+		for (const auto& object : objects)
+			max_depth = std::max(max_depth, object.depth);
+
+		depthOffsets.assign(max_depth + 2, 0);
+		for (const auto& object : objects)
+			depthOffsets[object.depth + 1]++;
+
+		for (size_t i = 1; i < depthOffsets.size(); i++)
+			depthOffsets[i] += depthOffsets[i - 1];
+
+		transformOrder.resize(objects.size());
+		for (const auto& object : objects)
+			transformOrder[depthOffsets[object.depth]++] = object.slotId.index;
+
+		transformBatch.clear();
+		transformBatch.reserve(objects.size());
+
+		for (uint32_t index : transformOrder)
+		{
+			GameObject_T&       object = objects[objects.getId(index)];
+			const GameObject_T* parent = object.parent != nullptr ? &object.parent.get() : nullptr;
+
+			if (!object.isTransformStale())
+				continue;
+
+			transformBatch.push(object.transform, parent != nullptr ? &parent->worldMatrix : nullptr, &object.worldMatrix);
+
+			object.appliedTransform = object.transform;
+			object.transformDirty   = false;
+			object.worldVersion++;
+			if (parent != nullptr)
+				object.parentVersion = parent->worldVersion;
+
+			queueTrackedSpatialEntry(index);
+		}
+
+		transformBatch.run();
 	}
 
 	PhysicsWorld* Scene::getPhysicsWorld()
@@ -0,0 +1,68 @@
+#include <lunar/core/scene_command_buffer.hpp>
+#include <lunar/debug/assert.hpp>
+#include <utility>
+
+namespace lunar
+{
+	void SceneCommandBuffer::pushCommand(CommandType type, ObjectRef target, ObjectRef parent, uint32_t payload)
+	{
+		DEBUG_ASSERT(!target.isPending() || target.pending < createCount, "ObjectRef does not come from this command buffer.");
+		DEBUG_ASSERT(!parent.isPending() || parent.pending < createCount, "ObjectRef does not come from this command buffer.");
+
+		commands.push_back(Command{ type, target, parent, payload });
+	}
+
+	SceneCommandBuffer::ObjectRef SceneCommandBuffer::createGameObject(const std::string_view& name, ObjectRef parent)
+	{
+		DEBUG_ASSERT(name.size() > 0);
+
+		pushCommand(CommandType::eCreate, nullptr, parent, static_cast<uint32_t>(names.size()));
+		names.emplace_back(name);
+
+		auto created           = ObjectRef();
+		created.pending        = createCount++;
+		commands.back().target = created;
+
+		return created;
+	}
+
+	void SceneCommandBuffer::deleteGameObject(ObjectRef object)
+	{
+		pushCommand(CommandType::eDelete, object, nullptr, 0);
+	}
+
+	void SceneCommandBuffer::setTransform(ObjectRef object, const Transform& transform)
+	{
+		pushCommand(CommandType::eSetTransform, object, nullptr, static_cast<uint32_t>(transforms.size()));
+		transforms.push_back(transform);
+	}
+
+	size_t SceneCommandBuffer::size() const
+	{
+		return commands.size();
+	}
+
+	bool SceneCommandBuffer::empty() const
+	{
+		return commands.empty();
+	}
+
+	/* Exchanges contents and storage, so both buffers keep their capacity around. */
+	void SceneCommandBuffer::swap(SceneCommandBuffer& other) noexcept
+	{
+		commands.swap(other.commands);
+		names.swap(other.names);
+		transforms.swap(other.transforms);
+		factories.swap(other.factories);
+		std::swap(createCount, other.createCount);
+	}
+
+	void SceneCommandBuffer::clear()
+	{
+		commands.clear();
+		names.clear();
+		transforms.clear();
+		factories.clear();
+		createCount = 0;
+	}
+}
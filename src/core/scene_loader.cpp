@@ -5,12 +5,16 @@
 #include <lunar/render/mesh.hpp>
 #include <lunar/render/common.hpp>
 #include <lunar/file/json_file.hpp>
+#include <lunar/file/mapped_file.hpp>
+#include <lunar/core/jobs.hpp>
+#include <fstream>
+#include <cstring>
 
 namespace lunar
 {
 	using namespace std;
 
-	inline void LoadVec3f
+	void imp::LoadVec3f
 	(
 		const nlohmann::json& json,
 		const std::string_view& name,
@@ -35,40 +39,79 @@ namespace lunar
 		}
 	}
 
+	uint64_t imp::GetStableId(const nlohmann::json& json, uint64_t parent, SiblingNames& siblings)
+	{
+		if (json.contains("id"))
+		{
+			auto& id = json["id"];
+			return MakeStableId(id.is_string() ? id.get<std::string>() : id.dump());
+		}
+
+		auto name = json.value<std::string>("name", "GameObject");
+		return MakeStableId(parent, name, siblings[name]++);
+	}
+
+	inline void LoadTransform(const nlohmann::json& json, Transform& transform)
+	{
+		if (json.contains("transform"))
+		{
+			auto& data = json["transform"];
+			imp::LoadVec3f(data, "position", transform.position);
+			imp::LoadVec3f(data, "rotation", transform.rotation);
+			imp::LoadVec3f(data, "scale",    transform.scale);
+		}
+	}
+
+	float SceneLoadProgress::getRatio() const
+	{
+		// Creating an object is cheap, decoding and uploading a mesh is not
+		static constexpr float MESH_WEIGHT = 16.f;
+
+		float total = objectsTotal + MESH_WEIGHT * 2.f * meshesTotal;
+		float done  = objectsLoaded + MESH_WEIGHT * (meshesDecoded + meshesUploaded);
+
+		if (isDone())
+			return 1.f;
+
+		return total > 0.f ? std::min(done / total, 1.f) : 0.f;
+	}
+
 	SceneLoader& SceneLoader::useRenderContext(Render::RenderContext context)
 	{
 		this->renderContext = context;
 		return *this;
 	}
 
+	SceneLoader& SceneLoader::useAsyncLoading(bool enabled)
+	{
+		this->asyncLoading = enabled;
+		return *this;
+	}
+
+	std::shared_ptr<const SceneLoadProgress> SceneLoader::getProgress() const
+	{
+		return progress;
+	}
+
 	SceneLoader& SceneLoader::useCoreSerializers()
 	{
 		useCustomClassSerializer("core.render.camera",        [](const nlohmann::json& json) -> Component { 
 			auto camera = make_shared<Camera>();
 			camera->fov = json.value<float>("fov", camera->fov);
 			
-			LoadVec3f(json, "front", camera->front);
-			LoadVec3f(json, "right", camera->right);
-			LoadVec3f(json, "up",    camera->up);
+			imp::LoadVec3f(json, "front", camera->front);
+			imp::LoadVec3f(json, "right", camera->right);
+			imp::LoadVec3f(json, "up",    camera->up);
 
 			return camera;
 		});
 
-		useCustomClassSerializer("core.render.mesh_renderer", [&](const nlohmann::json& json) -> Component {
-			auto mesh_renderer     = make_shared<MeshRenderer>();
-			mesh_renderer->program = renderContext->getProgram(Render::GpuDefaultPrograms::eBasicPbrShader);
+		// Program and mesh are resolved by the loader once all objects exist, see loadPendingMeshes()
+		useCustomClassSerializer("core.render.mesh_renderer", [](const nlohmann::json& json) -> Component {
+			auto mesh_renderer = make_shared<MeshRenderer>();
 
 			if (json.contains("meshPath"))
-			{
-				auto path = Fs::fromData(json["meshPath"]);
-				auto mesh_builder = Render::GpuMeshBuilder();
-				auto mesh = mesh_builder
-					.useRenderContext(renderContext.get())
-					.fromMeshFile(path)
-					.build();
-
-				mesh_renderer->mesh = mesh;
-			}
+				mesh_renderer->meshPath = json["meshPath"].get<std::string>();
 
 			return mesh_renderer;
 		});
@@ -96,39 +139,34 @@ namespace lunar
 		const nlohmann::json& json
 	)
 	{
-		auto& transform = object->getTransform();
-		if (json.contains("transform"))
-		{
-			auto& data = json["transform"];
-			LoadVec3f(data, "position", transform.position);
-			LoadVec3f(data, "rotation", transform.rotation);
-			LoadVec3f(data, "scale",    transform.scale);
-		}
+		LoadTransform(json, object->getTransform());
 	}
 
-	inline void LoadComponent
+	Component imp::ParseComponent
 	(
-		GameObject               object,
-		SceneLoader::VisitorDict visitors,
-		const nlohmann::json&    json
+		const ComponentVisitorDict& visitors,
+		const nlohmann::json&       json
 	)
 	{
+		if (!json.is_object() || !json.contains("type") || !json["type"].is_string())
+		{
+			DEBUG_WARN("Found component without a type. Skipping...");
+			return nullptr;
+		}
+
 		std::string type = json["type"];
-		if (not visitors.contains(type))
+		auto        it   = visitors.find(type);
+		if (it == visitors.end())
 		{
 			DEBUG_WARN("Found component of type '{}' but no visitor to parse it. Skipping...", type);
-			return;
+			return nullptr;
 		}
 
-		auto parser    = visitors.at(type);
-		auto component = parser(json);
+		auto component = it->second(json);
 		if (component == nullptr)
-		{
 			DEBUG_WARN("Parsed component of type '{}', yet result was nullptr. Skipping...", type);
-			return;
-		}
 
-		object->addComponent(component);
+		return component;
 	}
 
 	void SceneLoader::parseComponents
@@ -140,35 +178,106 @@ namespace lunar
 		if (json.contains("components"))
 		{
 			auto& data = json["components"];
-			for(auto& [ key, component ] : data.items())
-				LoadComponent(object, visitors, component);
+			for(auto& [ key, component_data ] : data.items())
+			{
+				auto component = imp::ParseComponent(visitors, component_data);
+				if (component == nullptr)
+					continue;
+
+				object->addComponent(component);
+				collectMeshRenderer(component);
+			}
 		}
 	}
 
 	void SceneLoader::parseGameObject
 	(
 		const nlohmann::json& json,
-		GameObject            parent
+		GameObject            parent,
+		imp::SiblingNames&    siblings
 	)
 	{
 		const std::string name = json.contains("name")
 			? json["name"]
 			: "GameObject";
 
+		uint64_t parent_id = parent == nullptr ? 0 : parent->getStableId();
+
 		GameObject object = result->createGameObject(name, parent.pointer());
+		object->setStableId(imp::GetStableId(json, parent_id, siblings));
 		parseTransform(object, json);
 		parseComponents(object, json);
 
+		progress->objectsTotal++;
+		progress->objectsLoaded++;
+
 		if (json.contains("children"))
 		{
 			auto& children = json["children"];
+			auto  names    = imp::SiblingNames();
 			for (auto& [key, child] : children.items())
-				parseGameObject(child, object);
+				parseGameObject(child, object, names);
+		}
+	}
+
+	void SceneLoader::collectMeshRenderer(const Component& component)
+	{
+		if (auto mesh_renderer = std::dynamic_pointer_cast<MeshRenderer>(component))
+			pendingMeshes.push_back(std::move(mesh_renderer));
+	}
+
+	/*
+		Gives every mesh renderer created by the last load its default program and
+		its mesh. Renderers referencing the same file share a single GpuMesh.
+	*/
+	void SceneLoader::loadPendingMeshes()
+	{
+		if (!pendingMeshes.empty() && renderContext == nullptr)
+		{
+			DEBUG_WARN("Scene contains mesh renderers, but the loader has no render context. Meshes will not be loaded.");
+			pendingMeshes.clear();
+			return;
+		}
+
+		for (auto& mesh_renderer : pendingMeshes)
+		{
+			if (!mesh_renderer->program.exists())
+				mesh_renderer->program = renderContext->getProgram(Render::GpuDefaultPrograms::eBasicPbrShader);
+
+			if (mesh_renderer->meshPath.empty() || mesh_renderer->mesh != nullptr)
+				continue;
+
+			auto [it, inserted] = meshCache.try_emplace(mesh_renderer->meshPath);
+			if (inserted)
+			{
+				it->second = Render::GpuMeshBuilder()
+					.useRenderContext(renderContext.get())
+					.fromMeshFile(Fs::fromData(mesh_renderer->meshPath))
+					.build();
+
+				progress->meshesTotal++;
+				progress->meshesDecoded++;
+				progress->meshesUploaded++;
+			}
+
+			mesh_renderer->mesh = it->second;
+			mesh_renderer->getGameObject()->markBoundsDirty();
 		}
+
+		pendingMeshes.clear();
 	}
 
 	SceneLoader& SceneLoader::loadJsonFile(const Fs::Path& path)
 	{
+		progress = std::make_shared<SceneLoadProgress>();
+
+		// Without workers nothing would ever pick up the parsing jobs
+		if (asyncLoading && Jobs::GetWorkerCount() > 0)
+		{
+			loadJsonFileAsync(path);
+			return *this;
+		}
+
 		auto  json_file = Fs::JsonFile(path);
 		auto& json      = json_file.content;
 		
@@ -176,11 +285,363 @@ namespace lunar
 		
 		if (json.contains("gameObjects"))
 		{
-			auto& data = json["gameObjects"];
+			auto& data     = json["gameObjects"];
+			auto  siblings = imp::SiblingNames();
 			for(auto& [ key, object ] : data.items())
-				parseGameObject(object, nullptr);
+				parseGameObject(object, nullptr, siblings);
 		}
 
+		loadPendingMeshes();
+		progress->finished = true;
+
+		return *this;
+	}
+
+	namespace imp
+	{
+		struct AsyncSceneLoad
+		{
+			SceneLoader::VisitorDict           visitors      = {};
+			Scene*                             scene         = nullptr;
+			Render::RenderContext              renderContext = nullptr;
+			std::shared_ptr<SceneLoadProgress> progress      = nullptr;
+			nlohmann::json                     json          = {};
+			vector<LoadedSubtree>              subtrees      = {};
+			std::mutex                         errorLock     = {};
+			std::string                        error         = {}; // first error thrown on a worker
+		};
+
+		struct AsyncMeshLoad
+		{
+			std::string                           path      = {};
+			vector<std::shared_ptr<MeshRenderer>> renderers = {};
+			Render::MeshData                      data      = {};
+		};
+
+		void ParseSubtree
+		(
+			const ComponentVisitorDict& visitors,
+			const nlohmann::json&       json,
+			uint32_t                    parent,
+			uint64_t                    stableId,
+			LoadedSubtree&              output,
+			std::atomic<uint32_t>*      parsedCounter
+		)
+		{
+			auto  index  = static_cast<uint32_t>(output.size());
+			auto& object = output.emplace_back();
+
+			object.name     = json.value<std::string>("name", "GameObject");
+			object.parent   = parent;
+			object.stableId = stableId;
+			LoadTransform(json, object.transform);
+
+			if (json.contains("components"))
+			{
+				for (auto& [key, data] : json["components"].items())
+				{
+					if (auto component = ParseComponent(visitors, data))
+						object.components.push_back(std::move(component));
+				}
+			}
+
+			if (parsedCounter != nullptr)
+				(*parsedCounter)++;
+
+			// `object` must not be touched past this point, children grow the vector
+			if (json.contains("children"))
+			{
+				auto children = SiblingNames();
+				for (auto& [key, child] : json["children"].items())
+					ParseSubtree(visitors, child, index, GetStableId(child, stableId, children), output, parsedCounter);
+			}
+		}
+
+		inline void LoadMeshesAsync(const std::shared_ptr<AsyncSceneLoad>& load, vector<std::shared_ptr<MeshRenderer>>& renderers)
+		{
+			auto& progress = load->progress;
+			if (!renderers.empty() && load->renderContext == nullptr)
+			{
+				DEBUG_WARN("Scene contains mesh renderers, but the loader has no render context. Meshes will not be loaded.");
+				renderers.clear();
+			}
+
+			auto batches = std::unordered_map<std::string, std::shared_ptr<AsyncMeshLoad>>();
+			for (auto& mesh_renderer : renderers)
+			{
+				if (!mesh_renderer->program.exists())
+					mesh_renderer->program = load->renderContext->getProgram(Render::GpuDefaultPrograms::eBasicPbrShader);
+
+				if (mesh_renderer->meshPath.empty() || mesh_renderer->mesh != nullptr)
+					continue;
+
+				auto& batch = batches[mesh_renderer->meshPath];
+				if (batch == nullptr)
+				{
+					batch       = std::make_shared<AsyncMeshLoad>();
+					batch->path = mesh_renderer->meshPath;
+				}
+				batch->renderers.push_back(mesh_renderer);
+			}
+
+			// Set before any job is scheduled so the last upload can tell that it is the last one
+			progress->meshesTotal = static_cast<uint32_t>(batches.size());
+			if (batches.empty())
+			{
+				progress->finished.store(true, std::memory_order_release);
+				return;
+			}
+
+			for (auto& [path, batch] : batches)
+			{
+				auto decoded = Jobs::Schedule([batch, progress] {
+					Render::DecodeMeshFile(Fs::fromData(batch->path), batch->data);
+					progress->meshesDecoded++;
+				});
+
+				Jobs::Schedule([batch, progress, context = load->renderContext] {
+					if (!batch->data.empty())
+					{
+						auto mesh = Render::GpuMeshBuilder()
+							.useRenderContext(context.get())
+							.fromMeshData(batch->data)
+							.build();
+
+						// Runs frames after the objects were created, some of them may be gone by now
+						for (auto& mesh_renderer : batch->renderers)
+						{
+							mesh_renderer->mesh = mesh;
+							if (GameObject object = mesh_renderer->getGameObject(); object.valid())
+								object->markBoundsDirty();
+						}
+					}
+
+					batch->data = {};
+					if (++progress->meshesUploaded == progress->meshesTotal)
+						progress->finished.store(true, std::memory_order_release);
+				}, decoded, Jobs::JobAffinity::eMainThread);
+			}
+		}
+
+		inline void ReportLoadError(AsyncSceneLoad& load, const char* message)
+		{
+			auto guard = std::lock_guard(load.errorLock);
+			if (load.error.empty())
+				load.error = message;
+		}
+
+		/* Runs on the main thread once every subtree has been parsed. */
+		inline void CreateLoadedObjects(const std::shared_ptr<AsyncSceneLoad>& load)
+		{
+			if (!load->error.empty())
+			{
+				DEBUG_ERROR("Failed to load scene: {}", load->error);
+				load->json     = {};
+				load->subtrees = {};
+				load->progress->error = std::move(load->error);
+				load->progress->finished.store(true, std::memory_order_release);
+				return;
+			}
+
+			auto& scene = *load->scene;
+			scene.setName(load->json.value<std::string>("name", "Unnamed Scene"));
+
+			size_t object_count = 0;
+			for (auto& subtree : load->subtrees)
+				object_count += subtree.size();
+
+			scene.reserveGameObjects(object_count);
+
+			auto renderers = vector<std::shared_ptr<MeshRenderer>>();
+			auto created   = vector<GameObject>();
+			for (auto& subtree : load->subtrees)
+			{
+				created.clear();
+				for (auto& loaded : subtree)
+				{
+					GameObject_T* parent = loaded.parent == UINT32_MAX
+						? nullptr
+						: created[loaded.parent].pointer();
+
+					GameObject object = scene.createGameObject(loaded.name, parent);
+					object->setStableId(loaded.stableId);
+					object->getTransform() = loaded.transform;
+					created.push_back(object);
+
+					for (auto& component : loaded.components)
+					{
+						object->addComponent(component);
+						if (auto mesh_renderer = std::dynamic_pointer_cast<MeshRenderer>(component))
+							renderers.push_back(std::move(mesh_renderer));
+					}
+
+					load->progress->objectsLoaded++;
+				}
+			}
+
+			load->json     = {};
+			load->subtrees = {};
+
+			LoadMeshesAsync(load, renderers);
+		}
+	}
+
+	void SceneLoader::loadJsonFileAsync(const Fs::Path& path)
+	{
+		auto load           = std::make_shared<imp::AsyncSceneLoad>();
+		load->visitors      = visitors;
+		load->scene         = result;
+		load->renderContext = renderContext;
+		load->progress      = progress;
+
+		// Exceptions thrown by the json library or by visitors are caught on the worker and reported by CreateLoadedObjects()
+		auto parsed = Jobs::Schedule([load, path] {
+			auto file  = std::ifstream(path);
+			load->json = nlohmann::json::parse(file, nullptr, false);
+			if (!file.is_open() || load->json.is_discarded())
+			{
+				auto message = "Couldn't parse scene file '" + path.string() + "'.";
+				imp::ReportLoadError(*load, message.c_str());
+				load->json = nlohmann::json::object();
+				return;
+			}
+
+			if (!load->json.contains("gameObjects"))
+				return;
+
+			// Root ids depend on the names of the roots before them, so they are assigned up front
+			auto roots    = vector<const nlohmann::json*>();
+			auto root_ids = vector<uint64_t>();
+			try
+			{
+				auto siblings = imp::SiblingNames();
+				for (auto& [key, object] : load->json["gameObjects"].items())
+				{
+					roots.push_back(&object);
+					root_ids.push_back(imp::GetStableId(object, 0, siblings));
+				}
+			}
+			catch (const std::exception& e)
+			{
+				imp::ReportLoadError(*load, e.what());
+				return;
+			}
+
+			// Top-level subtrees share nothing, so each one is parsed by its own job
+			load->subtrees.resize(roots.size());
+			Jobs::Wait(Jobs::ParallelFor(roots.size(), 1, [&](size_t begin, size_t end) {
+				try
+				{
+					for (size_t i = begin; i < end; i++)
+						imp::ParseSubtree(load->visitors, *roots[i], UINT32_MAX, root_ids[i], load->subtrees[i], &load->progress->objectsTotal);
+				}
+				catch (const std::exception& e)
+				{
+					imp::ReportLoadError(*load, e.what());
+				}
+			}));
+		});
+
+		Jobs::Schedule([load] { imp::CreateLoadedObjects(load); }, parsed, Jobs::JobAffinity::eMainThread);
+	}
+
+	/*
+		Objects are created in file order (parents always precede their children),
+		transforms are copied straight out of the mapping, and component blobs are
+		decoded from MessagePack and handed to the same serializers the JSON path uses.
+	*/
+	SceneLoader& SceneLoader::loadBinaryFile(const Fs::Path& path)
+	{
+		progress = std::make_shared<SceneLoadProgress>();
+
+		auto file = Fs::MappedFile(path);
+		auto view = imp::SceneFileView();
+		if (!file.isOpen() || !view.open(file.bytes()))
+		{
+			DEBUG_ERROR("'{}' is not a valid binary scene file.", path.string());
+			progress->finished = true;
+			return *this;
+		}
+
+		auto& header = *view.header;
+		progress->objectsTotal = header.objectCount;
+		result->setName(view.getString(header.sceneName));
+		result->reserveGameObjects(header.objectCount);
+
+		// Component types are resolved once per file instead of once per component
+		auto parsers = vector<const ComponentJsonParser*>(header.typeCount, nullptr);
+		for (uint32_t i = 0; i < header.typeCount; i++)
+		{
+			if (!view.isString(view.types[i]))
+				continue;
+
+			auto type = std::string(view.getString(view.types[i]));
+			auto it   = visitors.find(type);
+			if (it != visitors.end())
+				parsers[i] = &it->second;
+			else
+				DEBUG_WARN("Found components of type '{}' but no visitor to parse them. Skipping...", type);
+		}
+
+		auto created = vector<GameObject>();
+		created.reserve(header.objectCount);
+
+		for (uint32_t i = 0; i < header.objectCount; i++)
+		{
+			auto& entry = view.objects[i];
+			bool  valid = view.isString(entry.name) && entry.name.size > 0
+				&& (entry.parent == imp::SCENE_FILE_NO_PARENT || entry.parent < i)
+				&& uint64_t(entry.firstComponent) + entry.componentCount <= header.componentCount;
+
+			if (!valid)
+			{
+				DEBUG_ERROR("Corrupted object entry #{} in '{}', stopping.", i, path.string());
+				break;
+			}
+
+			GameObject_T* parent = entry.parent == imp::SCENE_FILE_NO_PARENT
+				? nullptr
+				: created[entry.parent].pointer();
+
+			GameObject object = result->createGameObject(view.getString(entry.name), parent);
+			object->setStableId(entry.stableId);
+			std::memcpy(&object->getTransform(), view.transforms + size_t(i) * sizeof(Transform), sizeof(Transform));
+			created.push_back(object);
+
+			for (uint32_t j = 0; j < entry.componentCount; j++)
+			{
+				auto& component = view.components[entry.firstComponent + j];
+				if (component.type >= header.typeCount || parsers[component.type] == nullptr)
+					continue;
+
+				if (component.blobOffset > header.blobsSize || component.blobSize > header.blobsSize - component.blobOffset)
+				{
+					DEBUG_WARN("Component blob of '{}' lies outside of the file. Skipping...", view.getString(entry.name));
+					continue;
+				}
+
+				const uint8_t* blob = view.blobs + component.blobOffset;
+				auto           json = nlohmann::json::from_msgpack(blob, blob + component.blobSize, true, false);
+				if (json.is_discarded())
+				{
+					DEBUG_WARN("Failed to decode a component blob of '{}'. Skipping...", view.getString(entry.name));
+					continue;
+				}
+
+				auto instance = (*parsers[component.type])(json);
+				if (instance == nullptr)
+					continue;
+
+				object->addComponent(instance);
+				collectMeshRenderer(instance);
+			}
+
+			progress->objectsLoaded++;
+		}
+
+		loadPendingMeshes();
+		progress->finished = true;
+
 		return *this;
 	}
 }
@@ -0,0 +1,360 @@
+#include <lunar/core/scene.hpp>
+#include <lunar/core/scene_file.hpp>
+#include <lunar/render/components.hpp>
+#include <lunar/file/mapped_file.hpp>
+#include <lunar/debug/log.hpp>
+#include <functional>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+
+namespace lunar
+{
+	namespace imp
+	{
+		struct SnapshotComponent
+		{
+			std::string    type = {};
+			size_t         hash = 0;
+			nlohmann::json data = {};
+		};
+
+		struct SnapshotObject
+		{
+			uint64_t                  stableId   = 0;
+			uint32_t                  parent     = UINT32_MAX; // index of an earlier object, UINT32_MAX for roots
+			std::string               name       = {};
+			Transform                 transform  = {};
+			vector<SnapshotComponent> components = {};
+		};
+
+		/* Flattened contents of a scene file, parents always precede their children. */
+		struct SceneSnapshot
+		{
+			std::string            name    = {};
+			vector<SnapshotObject> objects = {};
+		};
+
+		struct TrackedComponent
+		{
+			std::string     type   = {};
+			size_t          hash   = 0;
+			ComponentTypeId typeId = 0;
+		};
+
+		/*
+			What the file said about an object the last time it was applied. Only
+			differences against this state are written to the live object, so
+			changes made at runtime survive reloads that do not touch them.
+		*/
+		struct TrackedObject
+		{
+			GameObject               object     = nullptr;
+			Transform                transform  = {};
+			vector<TrackedComponent> components = {};
+		};
+
+		struct TrackedScene
+		{
+			std::unordered_map<uint64_t, TrackedObject> objects = {};
+		};
+
+		inline void SnapshotJsonObject
+		(
+			const nlohmann::json& json,
+			uint32_t              parent,
+			SiblingNames&         siblings,
+			SceneSnapshot&        output
+		)
+		{
+			uint64_t parent_id = parent == UINT32_MAX ? 0 : output.objects[parent].stableId;
+			auto     index     = static_cast<uint32_t>(output.objects.size());
+			auto&    object    = output.objects.emplace_back();
+
+			object.stableId = GetStableId(json, parent_id, siblings);
+			object.parent   = parent;
+			object.name     = json.value<std::string>("name", "GameObject");
+
+			if (json.contains("transform"))
+			{
+				auto& data = json["transform"];
+				LoadVec3f(data, "position", object.transform.position);
+				LoadVec3f(data, "rotation", object.transform.rotation);
+				LoadVec3f(data, "scale",    object.transform.scale);
+			}
+
+			if (json.contains("components"))
+			{
+				for (auto& [key, component_data] : json["components"].items())
+				{
+					if (!component_data.contains("type") || !component_data["type"].is_string())
+						continue;
+
+					auto& component = object.components.emplace_back();
+					component.type  = component_data["type"].get<std::string>();
+					component.hash  = std::hash<nlohmann::json>()(component_data);
+					component.data  = component_data;
+				}
+			}
+
+			// `object` must not be touched past this point, children grow the vector
+			if (json.contains("children"))
+			{
+				auto children = SiblingNames();
+				for (auto& [key, child] : json["children"].items())
+					SnapshotJsonObject(child, index, children, output);
+			}
+		}
+
+		inline bool SnapshotJsonFile(const Fs::Path& path, SceneSnapshot& output)
+		{
+			auto file = std::ifstream(path);
+			auto json = nlohmann::json::parse(file, nullptr, false);
+			if (!file.is_open() || json.is_discarded())
+				return false;
+
+			output.name = json.value<std::string>("name", "Unnamed Scene");
+			if (json.contains("gameObjects"))
+			{
+				auto roots = SiblingNames();
+				for (auto& [key, object] : json["gameObjects"].items())
+					SnapshotJsonObject(object, UINT32_MAX, roots, output);
+			}
+
+			return true;
+		}
+
+		inline bool SnapshotBinaryFile(const Fs::Path& path, SceneSnapshot& output)
+		{
+			auto file = Fs::MappedFile(path);
+			auto view = SceneFileView();
+			if (!file.isOpen() || !view.open(file.bytes()))
+				return false;
+
+			auto& header = *view.header;
+			output.name  = view.getString(header.sceneName);
+			output.objects.reserve(header.objectCount);
+
+			for (uint32_t i = 0; i < header.objectCount; i++)
+			{
+				auto& entry = view.objects[i];
+				bool  valid = view.isString(entry.name)
+					&& (entry.parent == SCENE_FILE_NO_PARENT || entry.parent < i)
+					&& uint64_t(entry.firstComponent) + entry.componentCount <= header.componentCount;
+
+				if (!valid)
+					return false;
+
+				auto& object    = output.objects.emplace_back();
+				object.stableId = entry.stableId;
+				object.parent   = entry.parent == SCENE_FILE_NO_PARENT ? UINT32_MAX : entry.parent;
+				object.name     = view.getString(entry.name);
+				std::memcpy(&object.transform, view.transforms + size_t(i) * sizeof(Transform), sizeof(Transform));
+
+				for (uint32_t j = 0; j < entry.componentCount; j++)
+				{
+					auto& component = view.components[entry.firstComponent + j];
+					if (component.type >= header.typeCount || !view.isString(view.types[component.type]))
+						continue;
+
+					if (component.blobOffset > header.blobsSize || component.blobSize > header.blobsSize - component.blobOffset)
+						continue;
+
+					const uint8_t* blob = view.blobs + component.blobOffset;
+					auto           data = nlohmann::json::from_msgpack(blob, blob + component.blobSize, true, false);
+					if (data.is_discarded())
+						continue;
+
+					auto& snapshot = object.components.emplace_back();
+					snapshot.type  = view.getString(view.types[component.type]);
+					snapshot.hash  = std::hash<nlohmann::json>()(data);
+					snapshot.data  = std::move(data);
+				}
+			}
+
+			return true;
+		}
+	}
+
+	/*
+		Hot reload: the file is tracked, and every time it changes the new version
+		is diffed against the one applied last, so only objects and components that
+		were actually edited are touched. The first call loads the file as usual.
+	*/
+	SceneLoader& SceneLoader::watchFile(const Fs::Path& path, Fs::FileTracker& tracker)
+	{
+		reloadFile(path);
+		tracker.trackPath(path, [this](Fs::Path changed) {
+			reloadFile(changed);
+		});
+
+		return *this;
+	}
+
+	SceneLoader& SceneLoader::reloadFile(const Fs::Path& path)
+	{
+		DEBUG_ASSERT(result != nullptr, "SceneLoader has no destination scene.");
+		progress = std::make_shared<SceneLoadProgress>();
+
+		auto snapshot = imp::SceneSnapshot();
+		bool parsed   = path.extension() == ".lscene"
+			? imp::SnapshotBinaryFile(path, snapshot)
+			: imp::SnapshotJsonFile(path, snapshot);
+
+		// Editors often save in several steps; a half-written file is simply skipped
+		if (!parsed)
+		{
+			DEBUG_WARN("Couldn't parse '{}', keeping the previously loaded version.", path.string());
+			progress->finished = true;
+			return *this;
+		}
+
+		auto& tracked = trackedFiles[path.string()];
+		if (tracked == nullptr)
+		{
+			tracked = std::make_shared<imp::TrackedScene>();
+			result->setName(snapshot.name);
+		}
+
+		applyReload(*tracked, snapshot);
+		progress->finished = true;
+
+		return *this;
+	}
+
+	void SceneLoader::applyReload(imp::TrackedScene& tracked, const imp::SceneSnapshot& snapshot)
+	{
+		auto previous = std::move(tracked.objects);
+		auto objects  = vector<GameObject>(snapshot.objects.size(), nullptr);
+		tracked.objects.clear();
+		tracked.objects.reserve(snapshot.objects.size());
+
+		uint32_t created = 0;
+		uint32_t updated = 0;
+
+		auto add_component = [&](GameObject object, imp::TrackedObject& entry, const imp::SnapshotComponent& source) {
+			auto component = imp::ParseComponent(visitors, source.data);
+			if (component == nullptr)
+				return;
+
+			ComponentTypeId type_id = GetComponentTypeId(typeid(*component));
+			if (object->getComponent(type_id) != nullptr)
+			{
+				DEBUG_WARN("'{}' already has a component of type '{}'. Skipping...", object->getName(), source.type);
+				return;
+			}
+
+			object->addComponent(component);
+			collectMeshRenderer(component);
+			entry.components.push_back(imp::TrackedComponent{ source.type, source.hash, type_id });
+		};
+
+		progress->objectsTotal = static_cast<uint32_t>(snapshot.objects.size());
+
+		for (size_t i = 0; i < snapshot.objects.size(); i++)
+		{
+			auto&      source = snapshot.objects[i];
+			GameObject parent = source.parent == UINT32_MAX ? nullptr : objects[source.parent];
+
+			// Two objects ending up with the same id (e.g. a copy-pasted "id") would otherwise share one live object
+			uint64_t id = source.stableId;
+			while (tracked.objects.contains(id))
+				id = imp::MakeStableId(id, source.name, 1);
+
+			auto& entry = tracked.objects[id];
+			auto  old   = previous.find(id);
+			if (old != previous.end() && old->second.object.valid() && !old->second.object->isPendingDelete())
+			{
+				entry = std::move(old->second);
+				previous.erase(old);
+
+				GameObject object  = entry.object;
+				bool       changed = false;
+
+				object->setStableId(source.stableId);
+
+				if (object->getParent().pointer() != parent.pointer())
+				{
+					object->setParent(parent);
+					changed = true;
+				}
+
+				if (std::memcmp(&entry.transform, &source.transform, sizeof(Transform)) != 0)
+				{
+					entry.transform        = source.transform;
+					object->getTransform() = source.transform;
+					object->markTransformDirty();
+					changed = true;
+				}
+
+				// Components are matched by type name: removed and edited ones go, new and edited ones are parsed again
+				auto kept = vector<imp::TrackedComponent>();
+				for (auto& component : entry.components)
+				{
+					auto match = std::find_if(source.components.begin(), source.components.end(), [&](auto& c) {
+						return c.type == component.type;
+					});
+
+					if (match != source.components.end() && match->hash == component.hash)
+					{
+						kept.push_back(component);
+						continue;
+					}
+
+					object->removeComponent(component.typeId);
+					changed = true;
+				}
+
+				entry.components = std::move(kept);
+				for (auto& component : source.components)
+				{
+					bool present = std::any_of(entry.components.begin(), entry.components.end(), [&](auto& c) {
+						return c.type == component.type;
+					});
+
+					if (!present)
+					{
+						add_component(object, entry, component);
+						changed = true;
+					}
+				}
+
+				objects[i] = object;
+				updated   += changed ? 1 : 0;
+			}
+			else
+			{
+				if (old != previous.end())
+					previous.erase(old);
+
+				GameObject object = result->createGameObject(source.name, parent.pointer());
+				object->setStableId(source.stableId);
+				object->getTransform() = source.transform;
+				entry.object           = object;
+				entry.transform        = source.transform;
+
+				for (auto& component : source.components)
+					add_component(object, entry, component);
+
+				objects[i] = object;
+				created++;
+			}
+
+			progress->objectsLoaded++;
+		}
+
+		// Whatever was not matched has been removed from the file
+		uint32_t removed = 0;
+		for (auto& [id, entry] : previous)
+		{
+			if (!entry.object.valid() || entry.object->isPendingDelete())
+				continue;
+
+			result->deleteGameObject(entry.object);
+			removed++;
+		}
+
+		loadPendingMeshes();
+		DEBUG_LOG("Reloaded scene '{}': {} objects created, {} updated, {} removed.", result->getName(), created, updated, removed);
+	}
+}
@@ -0,0 +1,213 @@
+#include <lunar/core/scene.hpp>
+#include <lunar/core/jobs.hpp>
+#include <lunar/render/components.hpp>
+#include <lunar/render/mesh.hpp>
+
+namespace lunar
+{
+	static constexpr size_t SPATIAL_QUERY_GRAIN = 16;
+
+	/* Union of the object's mesh and collider bounds, in local space. */
+	static Aabb GetLocalBounds(GameObject_T& object)
+	{
+		Aabb bounds = {};
+
+		if (auto* renderer = object.getComponent<MeshRenderer>(); renderer != nullptr && renderer->mesh.valid())
+			bounds.expand(renderer->mesh->getBounds());
+
+		if (auto* collider = object.getComponent<Collider>())
+			bounds.expand(collider->getLocalBounds());
+
+		return bounds;
+	}
+
+	/*
+		Only refreshes the slots queued since the last pass: objects whose world
+		matrix was recomputed, that gained or lost a mesh renderer or a collider,
+		that were deleted, or whose bounds were marked dirty. The tree itself only
+		restructures once a new box leaves the fat one.
+	*/
+	void Scene::updateSpatialIndex()
+	{
+		for (uint32_t slot : spatialQueue)
+			updateSpatialEntry(slot);
+
+		spatialQueue.clear();
+	}
+
+	void Scene::updateSpatialEntry(uint32_t slot)
+	{
+		auto& entry  = spatialEntries[slot];
+		entry.queued = false;
+
+		// Deleted objects lose their proxy; so does the one of an object whose slot got reused
+		SlotId        id     = objects.getId(slot);
+		GameObject_T* object = objects.contains(id) && !objects[id].pendingDelete ? &objects[id] : nullptr;
+
+		entry.tracked = object != nullptr
+			&& (object->getComponent<MeshRenderer>() != nullptr || object->getComponent<Collider>() != nullptr);
+
+		Aabb local = entry.tracked ? GetLocalBounds(*object) : Aabb{};
+		if (local.isEmpty())
+		{
+			if (entry.proxy != DynamicAabbTree::NULL_NODE)
+				spatialIndex.remove(entry.proxy);
+
+			entry.proxy  = DynamicAabbTree::NULL_NODE;
+			entry.object = 0;
+			return;
+		}
+
+		entry.object = object->getId();
+		entry.local  = local;
+		entry.world  = local.transformed(object->getWorldTransform());
+
+		if (entry.proxy == DynamicAabbTree::NULL_NODE)
+			entry.proxy = spatialIndex.insert(entry.world, slot);
+		else
+			spatialIndex.update(entry.proxy, entry.world);
+	}
+
+	void Scene::queueSpatialEntry(uint32_t slot)
+	{
+		if (slot >= spatialEntries.size())
+			spatialEntries.resize(slot + 1);
+
+		auto& entry = spatialEntries[slot];
+		if (!entry.queued)
+		{
+			entry.queued = true;
+			spatialQueue.push_back(slot);
+		}
+	}
+
+	/* Components other than mesh renderers and colliders have no say in the bounds. */
+	void Scene::queueSpatialEntry(uint32_t slot, ComponentTypeId typeId)
+	{
+		if (typeId == GetComponentTypeId<MeshRenderer>() || typeId == GetComponentTypeId<Collider>())
+			queueSpatialEntry(slot);
+	}
+
+	/* Called for every recomputed world matrix and every deletion, so objects without bounds are filtered out first. */
+	void Scene::queueTrackedSpatialEntry(uint32_t slot)
+	{
+		if (slot < spatialEntries.size() && spatialEntries[slot].tracked && !spatialEntries[slot].queued)
+		{
+			spatialEntries[slot].queued = true;
+			spatialQueue.push_back(slot);
+		}
+	}
+
+	/* Null for objects that died (or were queued for deletion) since the index was refreshed. */
+	GameObject Scene::getSpatialObject(uint32_t slot)
+	{
+		SlotId id = objects.getId(slot);
+		if (!objects.contains(id))
+			return nullptr;
+
+		GameObject_T& object = objects[id];
+		if (object.pendingDelete || object.getId() != spatialEntries[slot].object)
+			return nullptr;
+
+		return make_handle(objects, id);
+	}
+
+	const DynamicAabbTree& Scene::getSpatialIndex() const
+	{
+		return spatialIndex;
+	}
+
+	vector<GameObject> Scene::queryOverlap(const Aabb& box)
+	{
+		auto result = vector<GameObject>();
+		spatialIndex.queryOverlap(box, [&](uint32_t slot) {
+			if (spatialEntries[slot].world.overlaps(box))
+				if (GameObject object = getSpatialObject(slot); object.valid())
+					result.push_back(object);
+			return true;
+		});
+
+		return result;
+	}
+
+	/*
+		Queries only read the tree, so a batch of them is spread over the job
+		system; results[i] receives the objects overlapping boxes[i].
+	*/
+	void Scene::queryOverlaps(std::span<const Aabb> boxes, vector<vector<GameObject>>& results)
+	{
+		results.resize(boxes.size());
+
+		auto run_queries = [this, boxes, &results](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				results[i].clear();
+				spatialIndex.queryOverlap(boxes[i], [&](uint32_t slot) {
+					if (spatialEntries[slot].world.overlaps(boxes[i]))
+						if (GameObject object = getSpatialObject(slot); object.valid())
+							results[i].push_back(object);
+					return true;
+				});
+			}
+		};
+
+		if (Jobs::GetWorkerCount() > 0 && boxes.size() > SPATIAL_QUERY_GRAIN)
+			Jobs::Wait(Jobs::ParallelFor(boxes.size(), SPATIAL_QUERY_GRAIN, run_queries));
+		else
+			run_queries(0, boxes.size());
+	}
+
+	vector<GameObject> Scene::queryFrustum(const Frustum& frustum)
+	{
+		auto result = vector<GameObject>();
+		spatialIndex.queryFrustum(frustum, [&](uint32_t slot) {
+			if (GameObject object = getSpatialObject(slot); object.valid())
+				result.push_back(object);
+			return true;
+		});
+
+		return result;
+	}
+
+	/* Nearest first; distances are measured to the fat bounds kept by the tree. */
+	vector<GameObject> Scene::queryNearest(const glm::vec3& point, size_t count)
+	{
+		auto nearest = vector<std::pair<uint32_t, float>>();
+		spatialIndex.queryNearest(point, count, nearest);
+
+		auto result = vector<GameObject>();
+		result.reserve(nearest.size());
+		for (auto [slot, distance] : nearest)
+			if (GameObject object = getSpatialObject(slot); object.valid())
+				result.push_back(object);
+
+		return result;
+	}
+
+	/* Closest object whose (tight) world bounds the ray hits, or null. */
+	GameObject Scene::raycast(const Ray& ray, float maxDistance, float* hitDistance)
+	{
+		const glm::vec3 inverse_direction = 1.f / ray.direction;
+
+		GameObject closest = nullptr;
+		float      best    = maxDistance;
+
+		spatialIndex.raycast(ray, maxDistance, [&](uint32_t slot, float) {
+			float distance = IntersectRay(ray, inverse_direction, spatialEntries[slot].world, best);
+			if (distance < 0.f)
+				return best;
+
+			if (GameObject object = getSpatialObject(slot); object.valid())
+			{
+				closest = object;
+				best    = distance;
+			}
+			return best;
+		});
+
+		if (hitDistance != nullptr && closest.valid())
+			*hitDistance = best;
+
+		return closest;
+	}
+}
@@ -0,0 +1,401 @@
+#include <lunar/core/scene.hpp>
+#include <lunar/core/jobs.hpp>
+#include <lunar/render/components.hpp>
+#include <lunar/render/context.hpp>
+#include <lunar/render/mesh.hpp>
+#include <lunar/debug/log.hpp>
+#include <algorithm>
+#include <fstream>
+
+namespace lunar
+{
+	namespace imp
+	{
+		struct StreamRegion
+		{
+			std::string                                      name         = {};
+			Fs::Path                                         path         = {};
+			ComponentVisitorDict                             visitors     = {};
+			RegionResidency                                  residency    = RegionResidency::eQueued;
+			std::atomic<bool>                                parsed       = false;
+			std::atomic<bool>                                cancelled    = false; // set by unloadRegion(), polled by the parser
+
+			// Filled by the parsing job, consumed by updateStreaming()
+			vector<LoadedSubtree>                            chunks       = {};
+			vector<std::string>                              meshPaths    = {};
+			vector<Render::MeshData>                         meshData     = {};
+			size_t                                           nextChunk    = 0;
+			size_t                                           nextMesh     = 0;
+			uint32_t                                         objectsLeft  = 0;
+
+			std::unordered_map<std::string, Render::GpuMesh> meshes       = {};
+			vector<GameObject>                               roots        = {};
+			size_t                                           nextUnload   = 0;
+		};
+
+		inline bool IsCancelled(const StreamRegion& region)
+		{
+			return region.cancelled.load(std::memory_order_relaxed);
+		}
+
+		inline void ParseRegionData(StreamRegion& region)
+		{
+			auto file = std::ifstream(region.path);
+			auto json = nlohmann::json::parse(file, nullptr, false);
+			if (!file.is_open() || json.is_discarded())
+			{
+				DEBUG_ERROR("Couldn't parse region file '{}'.", region.path.string());
+				return;
+			}
+
+			if (!json.contains("gameObjects") || IsCancelled(region))
+				return;
+
+			auto roots    = vector<const nlohmann::json*>();
+			auto root_ids = vector<uint64_t>();
+			auto siblings = SiblingNames();
+			for (auto& [key, object] : json["gameObjects"].items())
+			{
+				roots.push_back(&object);
+				root_ids.push_back(GetStableId(object, 0, siblings));
+			}
+
+			// Exceptions must not escape a worker; the first one cancels the region
+			region.chunks.resize(roots.size());
+			auto parse = [&](size_t begin, size_t end) {
+				try
+				{
+					for (size_t i = begin; i < end && !IsCancelled(region); i++)
+						ParseSubtree(region.visitors, *roots[i], UINT32_MAX, root_ids[i], region.chunks[i]);
+				}
+				catch (const std::exception& e)
+				{
+					DEBUG_ERROR("Failed to parse region file '{}': {}", region.path.string(), e.what());
+					region.cancelled.store(true, std::memory_order_relaxed);
+				}
+			};
+
+			if (Jobs::GetWorkerCount() > 0)
+				Jobs::Wait(Jobs::ParallelFor(roots.size(), 1, parse));
+			else
+				parse(0, roots.size());
+
+			if (IsCancelled(region))
+				return;
+
+			for (auto& chunk : region.chunks)
+			{
+				region.objectsLeft += static_cast<uint32_t>(chunk.size());
+				for (auto& object : chunk)
+				{
+					for (auto& component : object.components)
+					{
+						auto mesh_renderer = std::dynamic_pointer_cast<MeshRenderer>(component);
+						if (mesh_renderer != nullptr && !mesh_renderer->meshPath.empty())
+							region.meshPaths.push_back(mesh_renderer->meshPath);
+					}
+				}
+			}
+
+			std::sort(region.meshPaths.begin(), region.meshPaths.end());
+			region.meshPaths.erase(std::unique(region.meshPaths.begin(), region.meshPaths.end()), region.meshPaths.end());
+			region.meshData.resize(region.meshPaths.size());
+
+			auto decode = [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end && !IsCancelled(region); i++)
+					Render::DecodeMeshFile(Fs::fromData(region.meshPaths[i]), region.meshData[i]);
+			};
+
+			if (Jobs::GetWorkerCount() > 0)
+				Jobs::Wait(Jobs::ParallelFor(region.meshPaths.size(), 1, decode));
+			else
+				decode(0, region.meshPaths.size());
+		}
+
+		/*
+			Parses the region file and decodes every mesh it references. Stops early
+			once the region gets unloaded; whatever was produced is then dropped.
+		*/
+		inline void ParseRegion(StreamRegion& region)
+		{
+			try
+			{
+				ParseRegionData(region);
+			}
+			catch (const std::exception& e)
+			{
+				DEBUG_ERROR("Failed to parse region file '{}': {}", region.path.string(), e.what());
+				region.cancelled.store(true, std::memory_order_relaxed);
+			}
+
+			if (IsCancelled(region))
+			{
+				region.chunks      = {};
+				region.meshPaths   = {};
+				region.meshData    = {};
+				region.objectsLeft = 0;
+			}
+		}
+	}
+
+	SceneLoader& SceneLoader::useStreamingBudget(double milliseconds)
+	{
+		this->streamingBudget = milliseconds;
+		return *this;
+	}
+
+	SceneLoader& SceneLoader::streamRegion(const std::string& name, const Fs::Path& path)
+	{
+		auto existing = regions.find(name);
+		if (existing != regions.end() && existing->second->residency != RegionResidency::eUnloading)
+			return *this;
+
+		if (result == nullptr)
+		{
+			DEBUG_ERROR("Streaming region '{}' without a destination scene.", name);
+			return *this;
+		}
+
+		if (renderContext == nullptr)
+			DEBUG_WARN("Streaming region '{}' without a render context, its meshes will not be loaded.", name);
+
+		auto region      = std::make_shared<imp::StreamRegion>();
+		region->name     = name;
+		region->path     = path;
+		region->visitors = visitors;
+
+		// A region that is still being unloaded keeps its queue entry until it is done
+		regions[name] = region;
+		streamQueue.push_back(region);
+
+		auto parse = [region] {
+			imp::ParseRegion(*region);
+			region->parsed.store(true, std::memory_order_release);
+		};
+
+		if (Jobs::GetWorkerCount() > 0)
+			Jobs::Schedule(parse);
+		else
+			parse();
+
+		return *this;
+	}
+
+	SceneLoader& SceneLoader::unloadRegion(const std::string& name)
+	{
+		auto it = regions.find(name);
+		if (it == regions.end() || it->second->residency == RegionResidency::eUnloading)
+			return *this;
+
+		auto region = it->second;
+		bool queued = std::find(streamQueue.begin(), streamQueue.end(), region) != streamQueue.end();
+
+		// Work that has not been started yet is simply dropped. A region still being
+		// parsed owns its data until the parsing job notices the flag and frees it.
+		region->cancelled.store(true, std::memory_order_relaxed);
+		if (region->parsed.load(std::memory_order_acquire))
+		{
+			region->chunks.clear();
+			region->meshData.clear();
+			region->objectsLeft = 0;
+		}
+
+		region->residency = RegionResidency::eUnloading;
+
+		if (!queued)
+			streamQueue.push_back(region);
+
+		return *this;
+	}
+
+	/*
+		Does one unit of work on the region: uploads a mesh, instantiates a chunk or
+		deletes a chunk's root. Returns true once the region has no work left. Every
+		unit is checked against the budget before it starts, except for the very
+		first one of an update, so streaming always makes progress.
+	*/
+	bool SceneLoader::streamRegionStep(imp::StreamRegion& region, const Utils::Stopwatch& frameTime, bool& didWork)
+	{
+		const double budget = streamingBudget / 1000.0;
+		auto out_of_time = [&] { return didWork && frameTime.elapsed() >= budget; };
+
+		if (region.residency == RegionResidency::eUnloading)
+		{
+			// Objects are only created after parsing, so an unparsed region has no roots to wait for
+			while (region.nextUnload < region.roots.size())
+			{
+				if (out_of_time())
+					return false;
+
+				result->deleteGameObject(region.roots[region.nextUnload++]);
+				didWork = true;
+			}
+
+			// The renderers referencing the meshes belong to objects that are no longer drawn
+			if (renderContext != nullptr)
+			{
+				for (auto& [path, mesh] : region.meshes)
+					renderContext->destroyMesh(mesh);
+			}
+
+			region.meshes.clear();
+			return true;
+		}
+
+		if (!region.parsed.load(std::memory_order_acquire))
+			return false;
+
+		region.residency = RegionResidency::eLoading;
+
+		while (region.nextMesh < region.meshPaths.size())
+		{
+			if (out_of_time())
+				return false;
+
+			auto& data = region.meshData[region.nextMesh];
+			auto& path = region.meshPaths[region.nextMesh++];
+			if (!data.empty() && renderContext != nullptr)
+			{
+				region.meshes[path] = Render::GpuMeshBuilder()
+					.useRenderContext(renderContext.get())
+					.fromMeshData(data)
+					.build();
+			}
+
+			data    = {};
+			didWork = true;
+		}
+
+		while (region.nextChunk < region.chunks.size())
+		{
+			if (out_of_time())
+				return false;
+
+			auto& chunk = region.chunks[region.nextChunk++];
+			instantiateChunk(region, chunk);
+			region.objectsLeft -= static_cast<uint32_t>(chunk.size());
+			chunk   = {};
+			didWork = true;
+		}
+
+		region.residency = RegionResidency::eResident;
+		region.chunks    = {};
+		region.meshData  = {};
+		return true;
+	}
+
+	/* Creates a whole subtree in one go, so it becomes visible in a single frame. */
+	void SceneLoader::instantiateChunk(imp::StreamRegion& region, imp::LoadedSubtree& chunk)
+	{
+		if (result == nullptr)
+		{
+			DEBUG_ERROR("Region '{}' has no destination scene to be instantiated in.", region.name);
+			return;
+		}
+
+		auto created = vector<GameObject>();
+		created.reserve(chunk.size());
+		result->reserveGameObjects(chunk.size());
+
+		for (auto& loaded : chunk)
+		{
+			GameObject_T* parent = loaded.parent == UINT32_MAX
+				? nullptr
+				: created[loaded.parent].pointer();
+
+			GameObject object = result->createGameObject(loaded.name, parent);
+			object->setStableId(loaded.stableId);
+			object->getTransform() = loaded.transform;
+			created.push_back(object);
+
+			for (auto& component : loaded.components)
+			{
+				if (auto mesh_renderer = std::dynamic_pointer_cast<MeshRenderer>(component); mesh_renderer != nullptr && renderContext != nullptr)
+				{
+					if (!mesh_renderer->program.exists())
+						mesh_renderer->program = renderContext->getProgram(Render::GpuDefaultPrograms::eBasicPbrShader);
+
+					auto mesh = region.meshes.find(mesh_renderer->meshPath);
+					if (mesh != region.meshes.end())
+						mesh_renderer->mesh = mesh->second;
+				}
+
+				object->addComponent(component);
+			}
+		}
+
+		if (!created.empty())
+			region.roots.push_back(created.front());
+	}
+
+	void SceneLoader::updateStreaming()
+	{
+		auto frame_time = Utils::Stopwatch(true);
+		bool did_work   = false;
+
+		for (size_t i = 0; i < streamQueue.size(); )
+		{
+			auto& region = *streamQueue[i];
+			if (!streamRegionStep(region, frame_time, did_work))
+			{
+				// Out of time, or still waiting for the parser; later regions may already be parsed
+				if (did_work && frame_time.elapsed() >= streamingBudget / 1000.0)
+					break;
+
+				i++;
+				continue;
+			}
+
+			if (region.residency == RegionResidency::eUnloading)
+			{
+				auto it = regions.find(region.name);
+				if (it != regions.end() && it->second.get() == &region)
+					regions.erase(it);
+			}
+
+			streamQueue.erase(streamQueue.begin() + i);
+		}
+
+		auto& status = streamingStatus;
+		status = {};
+		for (auto& [name, region] : regions)
+		{
+			if (region->residency == RegionResidency::eResident)
+				status.regionsResident++;
+		}
+
+		for (auto& region : streamQueue)
+		{
+			if (region->residency == RegionResidency::eUnloading)
+			{
+				status.objectsToUnload += static_cast<uint32_t>(region->roots.size() - region->nextUnload);
+				continue;
+			}
+
+			if (!region->parsed.load(std::memory_order_acquire))
+			{
+				status.regionsQueued++;
+				continue;
+			}
+
+			status.meshesRemaining  += static_cast<uint32_t>(region->meshPaths.size() - region->nextMesh);
+			status.chunksRemaining  += static_cast<uint32_t>(region->chunks.size() - region->nextChunk);
+			status.objectsRemaining += region->objectsLeft;
+		}
+
+		status.lastUpdateMs = frame_time.elapsed() * 1000.0;
+	}
+
+	RegionResidency SceneLoader::getResidency(const std::string& name) const
+	{
+		auto it = regions.find(name);
+		return it != regions.end()
+			? it->second->residency
+			: RegionResidency::eNotLoaded;
+	}
+
+	StreamingStatus SceneLoader::getStreamingStatus() const
+	{
+		return streamingStatus;
+	}
+}
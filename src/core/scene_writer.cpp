@@ -0,0 +1,291 @@
+#include <lunar/core/scene.hpp>
+#include <lunar/render/components.hpp>
+#include <lunar/file/json_file.hpp>
+#include <lunar/debug/log.hpp>
+#include <fstream>
+#include <utility>
+
+namespace lunar
+{
+	inline nlohmann::json SaveVec3f(const glm::vec3& value)
+	{
+		return nlohmann::json::array({ value.x, value.y, value.z });
+	}
+
+	SceneWriter& SceneWriter::useCoreSerializers()
+	{
+		useCustomClassSerializer<Camera>("core.render.camera", [](const Camera& camera) {
+			auto json     = nlohmann::json::object();
+			json["fov"]   = camera.fov;
+			json["front"] = SaveVec3f(camera.front);
+			json["right"] = SaveVec3f(camera.right);
+			json["up"]    = SaveVec3f(camera.up);
+			return json;
+		});
+
+		useCustomClassSerializer<MeshRenderer>("core.render.mesh_renderer", [](const MeshRenderer& meshRenderer) {
+			auto json = nlohmann::json::object();
+			if (!meshRenderer.meshPath.empty())
+				json["meshPath"] = meshRenderer.meshPath;
+
+			return json;
+		});
+
+		return *this;
+	}
+
+	SceneWriter& SceneWriter::useCustomClassSerializer(const std::string& name, ComponentTypeId typeId, const ComponentJsonWriter& writer)
+	{
+		classWriters[typeId] = ClassWriter{ name, writer };
+		return *this;
+	}
+
+	void SceneWriter::clear()
+	{
+		stringLookup.clear();
+		typeLookup.clear();
+		sceneName = {};
+		objects.clear();
+		transforms.clear();
+		components.clear();
+		types.clear();
+		strings.clear();
+		blobs.clear();
+		reservedIds.clear();
+		writtenIds.clear();
+	}
+
+	imp::SceneFileString SceneWriter::addString(const std::string_view& string)
+	{
+		auto [it, inserted] = stringLookup.try_emplace(std::string(string));
+		if (inserted)
+		{
+			it->second = imp::SceneFileString{ static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(string.size()) };
+			strings.append(string);
+		}
+
+		return it->second;
+	}
+
+	uint32_t SceneWriter::addType(const std::string_view& type)
+	{
+		auto [it, inserted] = typeLookup.try_emplace(std::string(type), static_cast<uint32_t>(types.size()));
+		if (inserted)
+			types.push_back(addString(type));
+
+		return it->second;
+	}
+
+	void SceneWriter::addComponent(const std::string_view& type, const nlohmann::json& json)
+	{
+		auto component       = imp::SceneFileComponent();
+		component.type       = addType(type);
+		component.blobOffset = blobs.size();
+
+		nlohmann::json::to_msgpack(json, blobs);
+		component.blobSize   = static_cast<uint32_t>(blobs.size() - component.blobOffset);
+
+		components.push_back(component);
+	}
+
+	/*
+		Objects are written depth-first, so every parent precedes its children and
+		the loader can link the hierarchy in a single forward pass.
+
+		An object keeps the stable id it was loaded with, so explicit ids survive
+		and renaming an object does not change the ids of its descendants. Objects
+		created at runtime (and duplicates of an id already written) get one
+		derived from their parent and name, skipping ids claimed by other objects.
+	*/
+	void SceneWriter::writeGameObject(GameObject_T& object, uint32_t parent, imp::SiblingNames& siblings)
+	{
+		auto index     = static_cast<uint32_t>(objects.size());
+		auto entry     = imp::SceneFileObject();
+		auto name      = std::string(object.getName());
+		auto parent_id = parent == imp::SCENE_FILE_NO_PARENT ? 0 : objects[parent].stableId;
+
+		entry.stableId = object.getStableId();
+		if (entry.stableId == 0 || writtenIds.contains(entry.stableId))
+		{
+			do
+				entry.stableId = imp::MakeStableId(parent_id, name, siblings[name]++);
+			while (reservedIds.contains(entry.stableId) || writtenIds.contains(entry.stableId));
+		}
+
+		writtenIds.insert(entry.stableId);
+		entry.name           = addString(name);
+		entry.parent         = parent;
+		entry.firstComponent = static_cast<uint32_t>(components.size());
+
+		for (Component_T* component : object.getComponentList())
+		{
+			auto it = classWriters.find(GetComponentTypeId(typeid(*component)));
+			if (it == classWriters.end())
+			{
+				DEBUG_WARN("No serializer registered for component class '{}'. Skipping...", typeid(*component).name());
+				continue;
+			}
+
+			addComponent(it->second.name, it->second.writer(*component));
+		}
+
+		entry.componentCount = static_cast<uint32_t>(components.size()) - entry.firstComponent;
+		objects.push_back(entry);
+		transforms.push_back(std::as_const(object).getTransform());
+
+		auto children = imp::SiblingNames();
+		for (auto& child : object.getChildren())
+		{
+			if (!child.isPendingDelete())
+				writeGameObject(child, index, children);
+		}
+	}
+
+	SceneWriter& SceneWriter::fromScene(Scene& scene)
+	{
+		clear();
+		sceneName = addString(scene.getName());
+
+		auto roots = vector<GameObject_T*>();
+		for (auto& object : scene.getGameObjects())
+		{
+			if (object.isPendingDelete())
+				continue;
+
+			if (object.getStableId() != 0)
+				reservedIds.insert(object.getStableId());
+
+			if (object.getParent() == nullptr)
+				roots.push_back(&object);
+		}
+
+		objects.reserve(scene.getGameObjects().size());
+		transforms.reserve(scene.getGameObjects().size());
+
+		auto siblings = imp::SiblingNames();
+		for (GameObject_T* root : roots)
+			writeGameObject(*root, imp::SCENE_FILE_NO_PARENT, siblings);
+
+		return *this;
+	}
+
+	void SceneWriter::parseGameObject(const nlohmann::json& json, uint32_t parent, imp::SiblingNames& siblings)
+	{
+		auto index     = static_cast<uint32_t>(objects.size());
+		auto entry     = imp::SceneFileObject();
+		auto parent_id = parent == imp::SCENE_FILE_NO_PARENT ? 0 : objects[parent].stableId;
+
+		entry.stableId       = imp::GetStableId(json, parent_id, siblings);
+		entry.name           = addString(json.value<std::string>("name", "GameObject"));
+		entry.parent         = parent;
+		entry.firstComponent = static_cast<uint32_t>(components.size());
+
+		auto transform = Transform();
+		if (json.contains("transform"))
+		{
+			auto& data = json["transform"];
+			imp::LoadVec3f(data, "position", transform.position);
+			imp::LoadVec3f(data, "rotation", transform.rotation);
+			imp::LoadVec3f(data, "scale",    transform.scale);
+		}
+
+		if (json.contains("components"))
+		{
+			for (auto& [key, component] : json["components"].items())
+			{
+				if (component.contains("type") && component["type"].is_string())
+					addComponent(component["type"].get<std::string>(), component);
+				else
+					DEBUG_WARN("Component without a type on '{}'. Skipping...", json.value<std::string>("name", "GameObject"));
+			}
+		}
+
+		entry.componentCount = static_cast<uint32_t>(components.size()) - entry.firstComponent;
+		objects.push_back(entry);
+		transforms.push_back(transform);
+
+		if (json.contains("children"))
+		{
+			auto children = imp::SiblingNames();
+			for (auto& [key, child] : json["children"].items())
+				parseGameObject(child, index, children);
+		}
+	}
+
+	SceneWriter& SceneWriter::fromJsonFile(const Fs::Path& path)
+	{
+		clear();
+
+		auto  json_file = Fs::JsonFile(path);
+		auto& json      = json_file.content;
+
+		sceneName = addString(json.value<std::string>("name", "Unnamed Scene"));
+
+		if (json.contains("gameObjects"))
+		{
+			auto siblings = imp::SiblingNames();
+			for (auto& [key, object] : json["gameObjects"].items())
+				parseGameObject(object, imp::SCENE_FILE_NO_PARENT, siblings);
+		}
+
+		return *this;
+	}
+
+	bool SceneWriter::toFile(const Fs::Path& path) const
+	{
+		if constexpr (std::endian::native != std::endian::little)
+		{
+			DEBUG_ERROR("Binary scene files can only be written on little-endian hosts.");
+			return false;
+		}
+
+		auto align = [](uint64_t offset) {
+			return (offset + imp::SCENE_FILE_ALIGNMENT - 1) & ~uint64_t(imp::SCENE_FILE_ALIGNMENT - 1);
+		};
+
+		auto header             = imp::SceneFileHeader();
+		header.objectCount      = static_cast<uint32_t>(objects.size());
+		header.componentCount   = static_cast<uint32_t>(components.size());
+		header.typeCount        = static_cast<uint32_t>(types.size());
+		header.sceneName        = sceneName;
+		header.objectsOffset    = align(sizeof(imp::SceneFileHeader));
+		header.transformsOffset = align(header.objectsOffset    + objects.size()    * sizeof(imp::SceneFileObject));
+		header.componentsOffset = align(header.transformsOffset + transforms.size() * sizeof(Transform));
+		header.typesOffset      = align(header.componentsOffset + components.size() * sizeof(imp::SceneFileComponent));
+		header.stringsOffset    = align(header.typesOffset      + types.size()      * sizeof(imp::SceneFileString));
+		header.stringsSize      = strings.size();
+		header.blobsOffset      = align(header.stringsOffset    + strings.size());
+		header.blobsSize        = blobs.size();
+
+		auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			DEBUG_ERROR("Failed to open '{}' for writing.", path.string());
+			return false;
+		}
+
+		uint64_t written = 0;
+		auto write = [&](uint64_t offset, const void* data, size_t size) {
+			static constexpr char PADDING[imp::SCENE_FILE_ALIGNMENT] = {};
+			file.write(PADDING, static_cast<std::streamsize>(offset - written));
+			file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+			written = offset + size;
+		};
+
+		write(0,                       &header,           sizeof(header));
+		write(header.objectsOffset,    objects.data(),    objects.size()    * sizeof(imp::SceneFileObject));
+		write(header.transformsOffset, transforms.data(), transforms.size() * sizeof(Transform));
+		write(header.componentsOffset, components.data(), components.size() * sizeof(imp::SceneFileComponent));
+		write(header.typesOffset,      types.data(),      types.size()      * sizeof(imp::SceneFileString));
+		write(header.stringsOffset,    strings.data(),    strings.size());
+		write(header.blobsOffset,      blobs.data(),      blobs.size());
+
+		if (!file)
+		{
+			DEBUG_ERROR("Failed to write scene file '{}'.", path.string());
+			return false;
+		}
+
+		return true;
+	}
+}
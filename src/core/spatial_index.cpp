@@ -0,0 +1,335 @@
+#include <lunar/core/spatial_index.hpp>
+#include <algorithm>
+#include <functional>
+
+namespace lunar
+{
+	/* Tests the box's most positive and most negative corner against every plane. */
+	FrustumTest TestFrustum(const Frustum& frustum, const Aabb& box)
+	{
+		FrustumTest result = FrustumTest::eInside;
+		for (const auto& plane : frustum.planes)
+		{
+			glm::vec3 normal   = glm::vec3(plane);
+			glm::vec3 positive = glm::vec3(
+				normal.x >= 0.f ? box.max.x : box.min.x,
+				normal.y >= 0.f ? box.max.y : box.min.y,
+				normal.z >= 0.f ? box.max.z : box.min.z
+			);
+			glm::vec3 negative = glm::vec3(
+				normal.x >= 0.f ? box.min.x : box.max.x,
+				normal.y >= 0.f ? box.min.y : box.max.y,
+				normal.z >= 0.f ? box.min.z : box.max.z
+			);
+
+			if (glm::dot(normal, positive) + plane.w < 0.f)
+				return FrustumTest::eOutside;
+
+			if (glm::dot(normal, negative) + plane.w < 0.f)
+				result = FrustumTest::eIntersect;
+		}
+
+		return result;
+	}
+
+	uint32_t DynamicAabbTree::insert(const Aabb& box, uint32_t userData)
+	{
+		uint32_t leaf = allocateNode();
+		nodes[leaf].box      = Aabb{ box.min - glm::vec3(margin), box.max + glm::vec3(margin) };
+		nodes[leaf].userData = userData;
+		nodes[leaf].height   = 0;
+
+		insertLeaf(leaf);
+		leafCount++;
+
+		return leaf;
+	}
+
+	void DynamicAabbTree::remove(uint32_t proxy)
+	{
+		DEBUG_ASSERT(proxy < nodes.size() && nodes[proxy].isLeaf() && nodes[proxy].height == 0);
+
+		removeLeaf(proxy);
+		freeNode(proxy);
+		leafCount--;
+	}
+
+	/*
+		Only reinserts the leaf once the new box leaves the fat one; small moves
+		cost a single containment test. Returns whether the tree changed.
+	*/
+	bool DynamicAabbTree::update(uint32_t proxy, const Aabb& box)
+	{
+		DEBUG_ASSERT(proxy < nodes.size() && nodes[proxy].isLeaf() && nodes[proxy].height == 0);
+
+		if (nodes[proxy].box.contains(box))
+			return false;
+
+		removeLeaf(proxy);
+		nodes[proxy].box = Aabb{ box.min - glm::vec3(margin), box.max + glm::vec3(margin) };
+		insertLeaf(proxy);
+
+		return true;
+	}
+
+	void DynamicAabbTree::clear()
+	{
+		nodes.clear();
+		root      = NULL_NODE;
+		freeList  = NULL_NODE;
+		leafCount = 0;
+	}
+
+	const Aabb& DynamicAabbTree::getFatBounds(uint32_t proxy) const
+	{
+		return nodes[proxy].box;
+	}
+
+	uint32_t DynamicAabbTree::getUserData(uint32_t proxy) const
+	{
+		return nodes[proxy].userData;
+	}
+
+	uint32_t DynamicAabbTree::getHeight() const
+	{
+		return root == NULL_NODE ? 0 : static_cast<uint32_t>(nodes[root].height);
+	}
+
+	size_t DynamicAabbTree::size() const
+	{
+		return leafCount;
+	}
+
+	/* Best-first search: nodes are expanded in order of their distance to the point. */
+	void DynamicAabbTree::queryNearest(const glm::vec3& point, size_t count, vector<std::pair<uint32_t, float>>& output) const
+	{
+		output.clear();
+		if (root == NULL_NODE || count == 0)
+			return;
+
+		using Entry = std::pair<float, uint32_t>;
+
+		auto queue = vector<Entry>(); // min-heap of (distance, node)
+		auto best  = vector<Entry>(); // max-heap of (distance, user data), at most `count` entries
+
+		queue.emplace_back(nodes[root].box.getDistance2(point), root);
+		while (!queue.empty())
+		{
+			std::pop_heap(queue.begin(), queue.end(), std::greater<>());
+			auto [distance, index] = queue.back();
+			queue.pop_back();
+
+			if (best.size() == count && distance >= best.front().first)
+				break;
+
+			const Node& node = nodes[index];
+			if (node.isLeaf())
+			{
+				best.emplace_back(distance, node.userData);
+				std::push_heap(best.begin(), best.end());
+
+				if (best.size() > count)
+				{
+					std::pop_heap(best.begin(), best.end());
+					best.pop_back();
+				}
+				continue;
+			}
+
+			for (uint32_t child : { node.left, node.right })
+			{
+				queue.emplace_back(nodes[child].box.getDistance2(point), child);
+				std::push_heap(queue.begin(), queue.end(), std::greater<>());
+			}
+		}
+
+		std::sort_heap(best.begin(), best.end());
+		output.reserve(best.size());
+		for (auto [distance, user_data] : best)
+			output.emplace_back(user_data, distance);
+	}
+
+	uint32_t DynamicAabbTree::allocateNode()
+	{
+		if (freeList == NULL_NODE)
+		{
+			nodes.emplace_back();
+			return static_cast<uint32_t>(nodes.size() - 1);
+		}
+
+		uint32_t index = freeList;
+		freeList       = nodes[index].parent;
+		nodes[index]   = Node{};
+		return index;
+	}
+
+	void DynamicAabbTree::freeNode(uint32_t index)
+	{
+		nodes[index]        = Node{};
+		nodes[index].parent = freeList;
+		freeList            = index;
+	}
+
+	/*
+		Descends towards the sibling that minimizes the surface area heuristic:
+		the cost of a new parent at the current node is compared with the cost of
+		pushing the leaf further down either child.
+	*/
+	void DynamicAabbTree::insertLeaf(uint32_t leaf)
+	{
+		if (root == NULL_NODE)
+		{
+			root                = leaf;
+			nodes[leaf].parent  = NULL_NODE;
+			return;
+		}
+
+		const Aabb leaf_box = nodes[leaf].box;
+
+		uint32_t index = root;
+		while (!nodes[index].isLeaf())
+		{
+			const Node& node          = nodes[index];
+			float       area          = node.box.getSurfaceArea();
+			float       combined_area = Aabb::Union(node.box, leaf_box).getSurfaceArea();
+			float       cost          = 2.f * combined_area;
+			float       inheritance   = 2.f * (combined_area - area);
+
+			auto child_cost = [&](uint32_t child) {
+				float enlarged = Aabb::Union(leaf_box, nodes[child].box).getSurfaceArea();
+				return nodes[child].isLeaf()
+					? enlarged + inheritance
+					: enlarged - nodes[child].box.getSurfaceArea() + inheritance;
+			};
+
+			float cost_left  = child_cost(node.left);
+			float cost_right = child_cost(node.right);
+
+			if (cost < cost_left && cost < cost_right)
+				break;
+
+			index = cost_left < cost_right ? node.left : node.right;
+		}
+
+		uint32_t sibling    = index;
+		uint32_t old_parent = nodes[sibling].parent;
+		uint32_t new_parent = allocateNode();
+
+		nodes[new_parent].parent = old_parent;
+		nodes[new_parent].box    = Aabb::Union(leaf_box, nodes[sibling].box);
+		nodes[new_parent].height = nodes[sibling].height + 1;
+		nodes[new_parent].left   = sibling;
+		nodes[new_parent].right  = leaf;
+
+		if (old_parent == NULL_NODE)
+			root = new_parent;
+		else if (nodes[old_parent].left == sibling)
+			nodes[old_parent].left = new_parent;
+		else
+			nodes[old_parent].right = new_parent;
+
+		nodes[sibling].parent = new_parent;
+		nodes[leaf].parent    = new_parent;
+
+		refitAncestors(new_parent);
+	}
+
+	void DynamicAabbTree::removeLeaf(uint32_t leaf)
+	{
+		if (leaf == root)
+		{
+			root = NULL_NODE;
+			return;
+		}
+
+		uint32_t parent      = nodes[leaf].parent;
+		uint32_t grandparent = nodes[parent].parent;
+		uint32_t sibling     = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+		freeNode(parent);
+		nodes[sibling].parent = grandparent;
+
+		if (grandparent == NULL_NODE)
+		{
+			root = sibling;
+			return;
+		}
+
+		if (nodes[grandparent].left == parent)
+			nodes[grandparent].left = sibling;
+		else
+			nodes[grandparent].right = sibling;
+
+		refitAncestors(grandparent);
+	}
+
+	void DynamicAabbTree::refitAncestors(uint32_t index)
+	{
+		while (index != NULL_NODE)
+		{
+			index = balance(index);
+
+			Node&       node  = nodes[index];
+			const Node& left  = nodes[node.left];
+			const Node& right = nodes[node.right];
+
+			node.height = 1 + std::max(left.height, right.height);
+			node.box    = Aabb::Union(left.box, right.box);
+
+			index = node.parent;
+		}
+	}
+
+	/* Rotates the taller child up if the subtree is out of balance; returns the subtree's new root. */
+	uint32_t DynamicAabbTree::balance(uint32_t index)
+	{
+		const Node& node = nodes[index];
+		if (node.isLeaf() || node.height < 2)
+			return index;
+
+		int32_t difference = nodes[node.right].height - nodes[node.left].height;
+		if (difference > 1)
+			return rotate(index, node.right);
+		if (difference < -1)
+			return rotate(index, node.left);
+
+		return index;
+	}
+
+	/*
+		Moves `child` into the place of `index`. The taller of the child's own
+		children stays with it, the shorter one goes to `index`.
+	*/
+	uint32_t DynamicAabbTree::rotate(uint32_t index, uint32_t child)
+	{
+		Node& a = nodes[index];
+		Node& c = nodes[child];
+
+		bool     from_right = a.right == child;
+		uint32_t other      = from_right ? a.left : a.right;
+		uint32_t keep       = nodes[c.left].height > nodes[c.right].height ? c.left : c.right;
+		uint32_t give       = keep == c.left ? c.right : c.left;
+
+		c.left   = index;
+		c.right  = keep;
+		c.parent = a.parent;
+		a.parent = child;
+
+		if (c.parent == NULL_NODE)
+			root = child;
+		else if (nodes[c.parent].left == index)
+			nodes[c.parent].left = child;
+		else
+			nodes[c.parent].right = child;
+
+		(from_right ? a.right : a.left) = give;
+		nodes[give].parent              = index;
+
+		a.box    = Aabb::Union(nodes[other].box, nodes[give].box);
+		a.height = 1 + std::max(nodes[other].height, nodes[give].height);
+		c.box    = Aabb::Union(a.box, nodes[keep].box);
+		c.height = 1 + std::max(a.height, nodes[keep].height);
+
+		return child;
+	}
+}
@@ -0,0 +1,530 @@
+#include <lunar/core/transform_batch.hpp>
+#include <lunar/debug/assert.hpp>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#	define LUNAR_TRANSFORM_SIMD 1
+#	include <immintrin.h>
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#	endif
+#else
+#	define LUNAR_TRANSFORM_SIMD 0
+#endif
+
+#if LUNAR_TRANSFORM_SIMD && (defined(__GNUC__) || defined(__clang__))
+#	define LUNAR_TARGET(isa) __attribute__((target(isa)))
+#else
+#	define LUNAR_TARGET(isa)
+#endif
+
+namespace lunar
+{
+	namespace imp
+	{
+		TransformKernel DetectTransformKernel()
+		{
+#if LUNAR_TRANSFORM_SIMD && (defined(__GNUC__) || defined(__clang__))
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+				return TransformKernel::eAVX2;
+			if (__builtin_cpu_supports("sse4.1"))
+				return TransformKernel::eSSE4;
+#elif LUNAR_TRANSFORM_SIMD && defined(_MSC_VER)
+			int info[4] = {};
+			__cpuid(info, 1);
+			bool sse41   = (info[2] & (1 << 19)) != 0;
+			bool fma     = (info[2] & (1 << 12)) != 0;
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			bool avx     = (info[2] & (1 << 28)) != 0;
+
+			// AVX registers are only usable if the OS saves the YMM state on context switches
+			if (osxsave && avx && fma && (_xgetbv(0) & 0x6) == 0x6)
+			{
+				__cpuidex(info, 7, 0);
+				if (info[1] & (1 << 5))
+					return TransformKernel::eAVX2;
+			}
+
+			if (sse41)
+				return TransformKernel::eSSE4;
+#endif
+			return TransformKernel::eScalar;
+		}
+	}
+
+	TransformKernel GetTransformKernel()
+	{
+		static const TransformKernel kernel = imp::DetectTransformKernel();
+		return kernel;
+	}
+
+	const char* GetTransformKernelName(TransformKernel kernel)
+	{
+		switch (kernel)
+		{
+		case TransformKernel::eAVX2: return "AVX2/FMA";
+		case TransformKernel::eSSE4: return "SSE4.1";
+		default:                     return "Scalar";
+		}
+	}
+}
+
+namespace lunar::imp
+{
+	void TransformBatch::clear()
+	{
+		px.clear(); py.clear(); pz.clear();
+		ex.clear(); ey.clear(); ez.clear();
+		sx.clear(); sy.clear(); sz.clear();
+		parents.clear();
+		outputs.clear();
+	}
+
+	void TransformBatch::reserve(size_t count)
+	{
+		px.reserve(count); py.reserve(count); pz.reserve(count);
+		ex.reserve(count); ey.reserve(count); ez.reserve(count);
+		sx.reserve(count); sy.reserve(count); sz.reserve(count);
+		parents.reserve(count);
+		outputs.reserve(count);
+	}
+
+	size_t TransformBatch::size() const
+	{
+		return outputs.size();
+	}
+
+	void TransformBatch::push(const Transform& local, const glm::mat4* parentWorld, glm::mat4* outWorld)
+	{
+		DEBUG_ASSERT(outWorld != nullptr);
+
+		px.push_back(local.position.x);
+		py.push_back(local.position.y);
+		pz.push_back(local.position.z);
+		ex.push_back(local.rotation.x);
+		ey.push_back(local.rotation.y);
+		ez.push_back(local.rotation.z);
+		sx.push_back(local.scale.x);
+		sy.push_back(local.scale.y);
+		sz.push_back(local.scale.z);
+		parents.push_back(parentWorld);
+		outputs.push_back(outWorld);
+	}
+
+	void TransformBatch::run(TransformKernel kernel)
+	{
+		const size_t count = size();
+		if (count == 0)
+			return;
+
+		locals.resize(count);
+
+		switch (kernel)
+		{
+		case TransformKernel::eAVX2:
+			composeAVX2(0, count);
+			propagateAVX2();
+			break;
+		case TransformKernel::eSSE4:
+			composeSSE4(0, count);
+			propagateSSE4();
+			break;
+		default:
+			composeScalar(0, count);
+			propagateScalar();
+			break;
+		}
+	}
+
+	/*
+		Builds T * R * S for every entry, going from the euler angles to the
+		quaternion and from there straight to the matrix, without intermediate glm
+		types. Matches glm::quat(glm::radians(euler)) followed by glm::mat3_cast.
+	*/
+	void TransformBatch::composeScalar(size_t begin, size_t end)
+	{
+		constexpr float HALF_RADIANS = 3.14159265358979f / 360.f;
+
+		for (size_t i = begin; i < end; i++)
+		{
+			float cos_x = std::cos(ex[i] * HALF_RADIANS), sin_x = std::sin(ex[i] * HALF_RADIANS);
+			float cos_y = std::cos(ey[i] * HALF_RADIANS), sin_y = std::sin(ey[i] * HALF_RADIANS);
+			float cos_z = std::cos(ez[i] * HALF_RADIANS), sin_z = std::sin(ez[i] * HALF_RADIANS);
+
+			float qw = cos_x * cos_y * cos_z + sin_x * sin_y * sin_z;
+			float qx = sin_x * cos_y * cos_z - cos_x * sin_y * sin_z;
+			float qy = cos_x * sin_y * cos_z + sin_x * cos_y * sin_z;
+			float qz = cos_x * cos_y * sin_z - sin_x * sin_y * cos_z;
+
+			float xx = qx * qx, yy = qy * qy, zz = qz * qz;
+			float xy = qx * qy, xz = qx * qz, yz = qy * qz;
+			float wx = qw * qx, wy = qw * qy, wz = qw * qz;
+
+			glm::mat4& m = locals[i];
+			m[0][0] = (1.f - 2.f * (yy + zz)) * sx[i];
+			m[0][1] = (2.f * (xy + wz))       * sx[i];
+			m[0][2] = (2.f * (xz - wy))       * sx[i];
+			m[0][3] = 0.f;
+			m[1][0] = (2.f * (xy - wz))       * sy[i];
+			m[1][1] = (1.f - 2.f * (xx + zz)) * sy[i];
+			m[1][2] = (2.f * (yz + wx))       * sy[i];
+			m[1][3] = 0.f;
+			m[2][0] = (2.f * (xz + wy))       * sz[i];
+			m[2][1] = (2.f * (yz - wx))       * sz[i];
+			m[2][2] = (1.f - 2.f * (xx + yy)) * sz[i];
+			m[2][3] = 0.f;
+			m[3][0] = px[i];
+			m[3][1] = py[i];
+			m[3][2] = pz[i];
+			m[3][3] = 1.f;
+		}
+	}
+
+	void TransformBatch::propagateScalar()
+	{
+		for (size_t i = 0; i < size(); i++)
+		{
+			if (parents[i] != nullptr)
+				*outputs[i] = *parents[i] * locals[i];
+			else
+				*outputs[i] = locals[i];
+		}
+	}
+
+#if LUNAR_TRANSFORM_SIMD
+	namespace
+	{
+		/*
+			Takes one matrix column for four consecutive entries, stored as one lane
+			per entry, and writes it back out in glm's column-major layout.
+		*/
+		LUNAR_TARGET("sse4.1")
+		inline void StoreColumn4(glm::mat4* out, int column, __m128 r0, __m128 r1, __m128 r2, __m128 r3)
+		{
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(&out[0][column][0], r0);
+			_mm_storeu_ps(&out[1][column][0], r1);
+			_mm_storeu_ps(&out[2][column][0], r2);
+			_mm_storeu_ps(&out[3][column][0], r3);
+		}
+
+		/*
+			Lane-wise sine and cosine (Cephes sinf/cosf): the angle is reduced by the
+			nearest multiple of pi/2 in three steps, both minimax polynomials are
+			evaluated on the remainder, and the quadrant picks and signs the results.
+			Accurate to a couple of ulps over the angles transforms use.
+		*/
+		struct SinCosConstants
+		{
+			static constexpr float TWO_OVER_PI  = 0.636619772367581f;
+			static constexpr float PI_2_HI      = 1.5703125f;
+			static constexpr float PI_2_MID     = 4.837512969970703125e-4f;
+			static constexpr float PI_2_LO      = 7.54978995489188216e-8f;
+			static constexpr float SIN_1        = -1.6666654611e-1f;
+			static constexpr float SIN_2        = 8.3321608736e-3f;
+			static constexpr float SIN_3        = -1.9515295891e-4f;
+			static constexpr float COS_1        = 4.166664568298827e-2f;
+			static constexpr float COS_2        = -1.388731625493765e-3f;
+			static constexpr float COS_3        = 2.443315711809948e-5f;
+			static constexpr float HALF_RADIANS = 3.14159265358979f / 360.f;
+		};
+
+		LUNAR_TARGET("sse4.1")
+		inline void SinCos4(__m128 angle, __m128& sin, __m128& cos)
+		{
+			using C = SinCosConstants;
+
+			__m128  quadrant = _mm_round_ps(_mm_mul_ps(angle, _mm_set1_ps(C::TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m128i q        = _mm_cvtps_epi32(quadrant);
+
+			__m128 r = _mm_sub_ps(angle, _mm_mul_ps(quadrant, _mm_set1_ps(C::PI_2_HI)));
+			r = _mm_sub_ps(r, _mm_mul_ps(quadrant, _mm_set1_ps(C::PI_2_MID)));
+			r = _mm_sub_ps(r, _mm_mul_ps(quadrant, _mm_set1_ps(C::PI_2_LO)));
+			__m128 r2 = _mm_mul_ps(r, r);
+
+			__m128 sin_r = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(C::SIN_3)), _mm_set1_ps(C::SIN_2));
+			sin_r = _mm_add_ps(_mm_mul_ps(r2, sin_r), _mm_set1_ps(C::SIN_1));
+			sin_r = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(r, r2), sin_r), r);
+
+			__m128 cos_r = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(C::COS_3)), _mm_set1_ps(C::COS_2));
+			cos_r = _mm_add_ps(_mm_mul_ps(r2, cos_r), _mm_set1_ps(C::COS_1));
+			cos_r = _mm_mul_ps(_mm_mul_ps(r2, r2), cos_r);
+			cos_r = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.f), _mm_mul_ps(r2, _mm_set1_ps(0.5f))), cos_r);
+
+			// Odd quadrants swap sine and cosine; bit 1 of q (of q + 1 for the cosine) flips the sign
+			const __m128i one  = _mm_set1_epi32(1);
+			const __m128i two  = _mm_set1_epi32(2);
+			__m128        swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+			__m128        sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+			__m128        cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30));
+
+			sin = _mm_xor_ps(_mm_blendv_ps(sin_r, cos_r, swap), sin_sign);
+			cos = _mm_xor_ps(_mm_blendv_ps(cos_r, sin_r, swap), cos_sign);
+		}
+
+		/* glm::quat(glm::radians(euler)) for four entries, from angles in degrees. */
+		LUNAR_TARGET("sse4.1")
+		inline void EulerToQuat4(__m128 ex, __m128 ey, __m128 ez, __m128& x, __m128& y, __m128& z, __m128& w)
+		{
+			const __m128 half_radians = _mm_set1_ps(SinCosConstants::HALF_RADIANS);
+
+			__m128 sin_x, cos_x, sin_y, cos_y, sin_z, cos_z;
+			SinCos4(_mm_mul_ps(ex, half_radians), sin_x, cos_x);
+			SinCos4(_mm_mul_ps(ey, half_radians), sin_y, cos_y);
+			SinCos4(_mm_mul_ps(ez, half_radians), sin_z, cos_z);
+
+			__m128 cc = _mm_mul_ps(cos_y, cos_z), ss = _mm_mul_ps(sin_y, sin_z);
+			__m128 cs = _mm_mul_ps(cos_y, sin_z), sc = _mm_mul_ps(sin_y, cos_z);
+
+			w = _mm_add_ps(_mm_mul_ps(cos_x, cc), _mm_mul_ps(sin_x, ss));
+			x = _mm_sub_ps(_mm_mul_ps(sin_x, cc), _mm_mul_ps(cos_x, ss));
+			y = _mm_add_ps(_mm_mul_ps(cos_x, sc), _mm_mul_ps(sin_x, cs));
+			z = _mm_sub_ps(_mm_mul_ps(cos_x, cs), _mm_mul_ps(sin_x, sc));
+		}
+
+		/* SinCos4 on eight lanes, with the reduction and polynomials fused. */
+		LUNAR_TARGET("avx2,fma")
+		inline void SinCos8(__m256 angle, __m256& sin, __m256& cos)
+		{
+			using C = SinCosConstants;
+
+			__m256  quadrant = _mm256_round_ps(_mm256_mul_ps(angle, _mm256_set1_ps(C::TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m256i q        = _mm256_cvtps_epi32(quadrant);
+
+			__m256 r = _mm256_fnmadd_ps(quadrant, _mm256_set1_ps(C::PI_2_HI), angle);
+			r = _mm256_fnmadd_ps(quadrant, _mm256_set1_ps(C::PI_2_MID), r);
+			r = _mm256_fnmadd_ps(quadrant, _mm256_set1_ps(C::PI_2_LO), r);
+			__m256 r2 = _mm256_mul_ps(r, r);
+
+			__m256 sin_r = _mm256_fmadd_ps(r2, _mm256_set1_ps(C::SIN_3), _mm256_set1_ps(C::SIN_2));
+			sin_r = _mm256_fmadd_ps(r2, sin_r, _mm256_set1_ps(C::SIN_1));
+			sin_r = _mm256_fmadd_ps(_mm256_mul_ps(r, r2), sin_r, r);
+
+			__m256 cos_r = _mm256_fmadd_ps(r2, _mm256_set1_ps(C::COS_3), _mm256_set1_ps(C::COS_2));
+			cos_r = _mm256_fmadd_ps(r2, cos_r, _mm256_set1_ps(C::COS_1));
+			cos_r = _mm256_fmadd_ps(_mm256_mul_ps(r2, r2), cos_r, _mm256_fnmadd_ps(r2, _mm256_set1_ps(0.5f), _mm256_set1_ps(1.f)));
+
+			const __m256i one  = _mm256_set1_epi32(1);
+			const __m256i two  = _mm256_set1_epi32(2);
+			__m256        swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, one), one));
+			__m256        sin_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, two), 30));
+			__m256        cos_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, one), two), 30));
+
+			sin = _mm256_xor_ps(_mm256_blendv_ps(sin_r, cos_r, swap), sin_sign);
+			cos = _mm256_xor_ps(_mm256_blendv_ps(cos_r, sin_r, swap), cos_sign);
+		}
+
+		LUNAR_TARGET("avx2,fma")
+		inline void EulerToQuat8(__m256 ex, __m256 ey, __m256 ez, __m256& x, __m256& y, __m256& z, __m256& w)
+		{
+			const __m256 half_radians = _mm256_set1_ps(SinCosConstants::HALF_RADIANS);
+
+			__m256 sin_x, cos_x, sin_y, cos_y, sin_z, cos_z;
+			SinCos8(_mm256_mul_ps(ex, half_radians), sin_x, cos_x);
+			SinCos8(_mm256_mul_ps(ey, half_radians), sin_y, cos_y);
+			SinCos8(_mm256_mul_ps(ez, half_radians), sin_z, cos_z);
+
+			__m256 cc = _mm256_mul_ps(cos_y, cos_z), ss = _mm256_mul_ps(sin_y, sin_z);
+			__m256 cs = _mm256_mul_ps(cos_y, sin_z), sc = _mm256_mul_ps(sin_y, cos_z);
+
+			w = _mm256_fmadd_ps(cos_x, cc, _mm256_mul_ps(sin_x, ss));
+			x = _mm256_fmsub_ps(sin_x, cc, _mm256_mul_ps(cos_x, ss));
+			y = _mm256_fmadd_ps(cos_x, sc, _mm256_mul_ps(sin_x, cs));
+			z = _mm256_fmsub_ps(cos_x, cs, _mm256_mul_ps(sin_x, sc));
+		}
+	}
+
+	LUNAR_TARGET("sse4.1")
+	void TransformBatch::composeSSE4(size_t begin, size_t end)
+	{
+		const __m128 one  = _mm_set1_ps(1.f);
+		const __m128 two  = _mm_set1_ps(2.f);
+		const __m128 zero = _mm_setzero_ps();
+
+		size_t i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			__m128 x, y, z, w;
+			EulerToQuat4(_mm_loadu_ps(&ex[i]), _mm_loadu_ps(&ey[i]), _mm_loadu_ps(&ez[i]), x, y, z, w);
+
+			__m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+			__m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+			__m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+			__m128 scale_x = _mm_loadu_ps(&sx[i]);
+			__m128 scale_y = _mm_loadu_ps(&sy[i]);
+			__m128 scale_z = _mm_loadu_ps(&sz[i]);
+
+			__m128 m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), scale_x);
+			__m128 m01 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), scale_x);
+			__m128 m02 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), scale_x);
+			__m128 m10 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), scale_y);
+			__m128 m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), scale_y);
+			__m128 m12 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), scale_y);
+			__m128 m20 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), scale_z);
+			__m128 m21 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), scale_z);
+			__m128 m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), scale_z);
+
+			glm::mat4* out = &locals[i];
+			StoreColumn4(out, 0, m00, m01, m02, zero);
+			StoreColumn4(out, 1, m10, m11, m12, zero);
+			StoreColumn4(out, 2, m20, m21, m22, zero);
+			StoreColumn4(out, 3, _mm_loadu_ps(&px[i]), _mm_loadu_ps(&py[i]), _mm_loadu_ps(&pz[i]), one);
+		}
+
+		composeScalar(i, end);
+	}
+
+	/* Same as composeSSE4, eight entries at a time, with the 1 - 2 * (a + b) terms fused. */
+	LUNAR_TARGET("avx2,fma")
+	void TransformBatch::composeAVX2(size_t begin, size_t end)
+	{
+		const __m256 one  = _mm256_set1_ps(1.f);
+		const __m256 two  = _mm256_set1_ps(2.f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 ones = _mm_set1_ps(1.f);
+
+		size_t i = begin;
+		for (; i + 8 <= end; i += 8)
+		{
+			__m256 x, y, z, w;
+			EulerToQuat8(_mm256_loadu_ps(&ex[i]), _mm256_loadu_ps(&ey[i]), _mm256_loadu_ps(&ez[i]), x, y, z, w);
+
+			__m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+			__m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+			__m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+
+			// Scales are pre-doubled for the off-diagonal terms, saving a multiply each
+			__m256 scale_x = _mm256_loadu_ps(&sx[i]), scale_2x = _mm256_mul_ps(two, scale_x);
+			__m256 scale_y = _mm256_loadu_ps(&sy[i]), scale_2y = _mm256_mul_ps(two, scale_y);
+			__m256 scale_z = _mm256_loadu_ps(&sz[i]), scale_2z = _mm256_mul_ps(two, scale_z);
+
+			__m256 m[3][3] =
+			{
+				{
+					_mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one), scale_x),
+					_mm256_mul_ps(_mm256_add_ps(xy, wz), scale_2x),
+					_mm256_mul_ps(_mm256_sub_ps(xz, wy), scale_2x),
+				},
+				{
+					_mm256_mul_ps(_mm256_sub_ps(xy, wz), scale_2y),
+					_mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one), scale_y),
+					_mm256_mul_ps(_mm256_add_ps(yz, wx), scale_2y),
+				},
+				{
+					_mm256_mul_ps(_mm256_add_ps(xz, wy), scale_2z),
+					_mm256_mul_ps(_mm256_sub_ps(yz, wx), scale_2z),
+					_mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one), scale_z),
+				},
+			};
+
+			// The 8-wide lanes are split into two 4-wide halves for the final transpose
+			glm::mat4* out = &locals[i];
+			for (int c = 0; c < 3; c++)
+			{
+				StoreColumn4(out,     c, _mm256_castps256_ps128(m[c][0]), _mm256_castps256_ps128(m[c][1]), _mm256_castps256_ps128(m[c][2]), zero);
+				StoreColumn4(out + 4, c, _mm256_extractf128_ps(m[c][0], 1), _mm256_extractf128_ps(m[c][1], 1), _mm256_extractf128_ps(m[c][2], 1), zero);
+			}
+
+			StoreColumn4(out,     3, _mm_loadu_ps(&px[i]),     _mm_loadu_ps(&py[i]),     _mm_loadu_ps(&pz[i]),     ones);
+			StoreColumn4(out + 4, 3, _mm_loadu_ps(&px[i + 4]), _mm_loadu_ps(&py[i + 4]), _mm_loadu_ps(&pz[i + 4]), ones);
+		}
+
+		composeSSE4(i, end);
+	}
+
+	/*
+		parent * local, one column at a time: each output column is the parent's
+		columns weighted by the four components of the local column.
+	*/
+	LUNAR_TARGET("sse4.1")
+	void TransformBatch::propagateSSE4()
+	{
+		for (size_t i = 0; i < size(); i++)
+		{
+			const glm::mat4& local = locals[i];
+			glm::mat4&       out   = *outputs[i];
+
+			if (parents[i] == nullptr)
+			{
+				out = local;
+				continue;
+			}
+
+			const glm::mat4& parent = *parents[i];
+			__m128 p0 = _mm_loadu_ps(&parent[0][0]);
+			__m128 p1 = _mm_loadu_ps(&parent[1][0]);
+			__m128 p2 = _mm_loadu_ps(&parent[2][0]);
+			__m128 p3 = _mm_loadu_ps(&parent[3][0]);
+
+			for (int c = 0; c < 4; c++)
+			{
+				__m128 col = _mm_loadu_ps(&local[c][0]);
+				__m128 res = _mm_mul_ps(p0, _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0)));
+				res = _mm_add_ps(res, _mm_mul_ps(p1, _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1))));
+				res = _mm_add_ps(res, _mm_mul_ps(p2, _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2))));
+				res = _mm_add_ps(res, _mm_mul_ps(p3, _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3))));
+				_mm_storeu_ps(&out[c][0], res);
+			}
+		}
+	}
+
+	/*
+		Two output columns per iteration: each 128-bit lane holds one local column,
+		whose components are broadcast within the lane and fused into the sum of
+		the parent's columns.
+	*/
+	LUNAR_TARGET("avx2,fma")
+	void TransformBatch::propagateAVX2()
+	{
+		for (size_t i = 0; i < size(); i++)
+		{
+			const glm::mat4& local = locals[i];
+			glm::mat4&       out   = *outputs[i];
+
+			if (parents[i] == nullptr)
+			{
+				out = local;
+				continue;
+			}
+
+			const glm::mat4& parent = *parents[i];
+			__m256 p0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&parent[0][0]));
+			__m256 p1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&parent[1][0]));
+			__m256 p2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&parent[2][0]));
+			__m256 p3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&parent[3][0]));
+
+			for (int c = 0; c < 4; c += 2)
+			{
+				__m256 cols = _mm256_loadu_ps(&local[c][0]);
+				__m256 res  = _mm256_mul_ps(p0, _mm256_permute_ps(cols, _MM_SHUFFLE(0, 0, 0, 0)));
+				res = _mm256_fmadd_ps(p1, _mm256_permute_ps(cols, _MM_SHUFFLE(1, 1, 1, 1)), res);
+				res = _mm256_fmadd_ps(p2, _mm256_permute_ps(cols, _MM_SHUFFLE(2, 2, 2, 2)), res);
+				res = _mm256_fmadd_ps(p3, _mm256_permute_ps(cols, _MM_SHUFFLE(3, 3, 3, 3)), res);
+				_mm256_storeu_ps(&out[c][0], res);
+			}
+		}
+	}
+#else
+	void TransformBatch::composeSSE4(size_t begin, size_t end)
+	{
+		composeScalar(begin, end);
+	}
+
+	void TransformBatch::composeAVX2(size_t begin, size_t end)
+	{
+		composeScalar(begin, end);
+	}
+
+	void TransformBatch::propagateSSE4()
+	{
+		propagateScalar();
+	}
+
+	void TransformBatch::propagateAVX2()
+	{
+		propagateScalar();
+	}
+#endif
+}
@@ -0,0 +1,168 @@
+#include <lunar/file/mapped_file.hpp>
+#include <lunar/debug.hpp>
+#include <utility>
+
+#if defined(WIN32)
+#	include <Windows.h>
+#else
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+namespace Fs
+{
+	MappedFile::~MappedFile() noexcept
+	{
+		close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			view           = std::exchange(other.view, nullptr);
+			viewSize       = std::exchange(other.viewSize, 0);
+			opened         = std::exchange(other.opened, false);
+#if defined(WIN32)
+			file           = std::exchange(other.file, nullptr);
+			mapping        = std::exchange(other.mapping, nullptr);
+#endif
+		}
+		return *this;
+	}
+
+#if defined(WIN32)
+	bool MappedFile::fromFile(const Path& path)
+	{
+		close();
+		if (!fileExists(path))
+			return false;
+
+		HANDLE file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file_handle == INVALID_HANDLE_VALUE)
+		{
+			DEBUG_ERROR("Failed to open '{}' for mapping.", path.string());
+			return false;
+		}
+
+		LARGE_INTEGER file_size = {};
+		if (!GetFileSizeEx(file_handle, &file_size))
+		{
+			DEBUG_ERROR("Failed to query the size of '{}'.", path.string());
+			CloseHandle(file_handle);
+			return false;
+		}
+
+		// Zero-sized files can not be mapped; treat them as an open, empty view
+		if (file_size.QuadPart == 0)
+		{
+			CloseHandle(file_handle);
+			opened = true;
+			return true;
+		}
+
+		file = file_handle;
+
+		mapping = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			DEBUG_ERROR("Failed to create a mapping of '{}'.", path.string());
+			close();
+			return false;
+		}
+
+		view     = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		viewSize = static_cast<size_t>(file_size.QuadPart);
+		if (view == nullptr)
+		{
+			DEBUG_ERROR("Failed to map a view of '{}'.", path.string());
+			close();
+			return false;
+		}
+
+		opened = true;
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (view != nullptr)
+			UnmapViewOfFile(view);
+		if (mapping != nullptr)
+			CloseHandle(mapping);
+		if (file != nullptr)
+			CloseHandle(file);
+
+		view     = nullptr;
+		viewSize = 0;
+		opened   = false;
+		mapping  = nullptr;
+		file     = nullptr;
+	}
+#else
+	bool MappedFile::fromFile(const Path& path)
+	{
+		close();
+		if (!fileExists(path))
+			return false;
+
+		int descriptor = ::open(path.c_str(), O_RDONLY);
+		if (descriptor < 0)
+		{
+			DEBUG_ERROR("Failed to open '{}' for mapping.", path.string());
+			return false;
+		}
+
+		struct stat info = {};
+		if (fstat(descriptor, &info) != 0)
+		{
+			DEBUG_ERROR("Failed to query the size of '{}'.", path.string());
+			::close(descriptor);
+			return false;
+		}
+
+		// Zero-sized files can not be mapped; treat them as an open, empty view
+		if (info.st_size == 0)
+		{
+			::close(descriptor);
+			opened = true;
+			return true;
+		}
+
+		// The mapping keeps its own reference to the file, the descriptor is not needed past this point
+		void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+		::close(descriptor);
+
+		if (address == MAP_FAILED)
+		{
+			DEBUG_ERROR("Failed to map '{}'.", path.string());
+			return false;
+		}
+
+		madvise(address, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+		view     = static_cast<const std::byte*>(address);
+		viewSize = static_cast<size_t>(info.st_size);
+		opened   = true;
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (view != nullptr)
+			munmap(const_cast<std::byte*>(view), viewSize);
+
+		view     = nullptr;
+		viewSize = 0;
+		opened   = false;
+	}
+#endif
+}
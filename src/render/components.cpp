@@ -4,6 +4,7 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <utility>
 
 namespace lunar
 {
@@ -21,7 +22,7 @@ namespace lunar
 	{
 		static const glm::vec3 worldUp = { 0.f, 1.f, 0.f };
 
-		const auto& transform = getTransform();
+		const auto& transform = std::as_const(*this).getTransform();
 
 		auto& position  = transform.position;
 		auto& rotation  = transform.rotation;
@@ -38,6 +39,12 @@ namespace lunar
 		up    = glm::normalize(glm::cross(right, front));
 	}
 
+	ComponentAccess Camera::getAccess() const
+	{
+		return ComponentAccess(ComponentAccessFlagBits::eThreadSafe)
+			.readTransform();
+	}
+
 	glm::mat4 Camera::getProjectionMatrix(int renderWidth, int renderHeight) const
 	{
 		return glm::perspective(
@@ -2,6 +2,7 @@
 #include <lunar/render/program.hpp>
 #include <lunar/debug/log.hpp>
 #include <lunar/debug/assert.hpp>
+#include <algorithm>
 
 namespace lunar::Render
 {
@@ -22,6 +23,41 @@ namespace lunar::Render
 		this->renderCamera = camera;
 	}
 
+	void RenderContext_T::useInterpolation(const FrameInterpolation* interpolation)
+	{
+		this->interpolation = interpolation;
+	}
+
+	void RenderContext_T::useFrustumCulling(bool enabled)
+	{
+		this->frustumCulling = enabled;
+	}
+
+	const CullingStats& RenderContext_T::getCullingStats() const
+	{
+		return cullingStats;
+	}
+
+	/*
+		The variant must behave like `program`, except that it takes the model
+		matrix from instances[in_instance] in the instance buffer (binding 3)
+		instead of the MeshData uniform, and its materials from the geometry pool
+		(bindings 4 and 5); see pbr_instanced.vert and pbr_instanced.frag.
+	*/
+	void RenderContext_T::useInstancedVariant(GpuProgram program, GpuProgram instanced)
+	{
+		for (auto& [base, variant] : instancedVariants)
+		{
+			if (&base.get() == &program.get())
+			{
+				variant = instanced;
+				return;
+			}
+		}
+
+		instancedVariants.emplace_back(program, instanced);
+	}
+
 	Window RenderContext_T::createWindow
 	(
 		int                     width,
@@ -113,8 +149,57 @@ namespace lunar::Render
 		GpuTexture   materialsAtlas
 	)
 	{
-		meshes.emplace_back(this, vertexBuffer, indexBuffer, topology, materialsBuffer, materialsAtlas);
-		return make_handle(meshes);
+		SlotId id = meshes.emplace(this, vertexBuffer, indexBuffer, topology, materialsBuffer, materialsAtlas);
+		return make_handle(meshes, id);
+	}
+
+	/* Mesh made of ranges in the geometry pool, see uploadVertices()/uploadIndices(). */
+	GpuMesh RenderContext_T::createMesh
+	(
+		GeometryRange vertices,
+		GeometryRange indices,
+		MeshTopology  topology,
+		GpuBuffer     materialsBuffer,
+		GpuTexture    materialsAtlas
+	)
+	{
+		SlotId id = meshes.emplace(
+			this,
+			geometryPool.getVertexBuffer(),
+			geometryPool.getIndexBuffer(),
+			vertices,
+			indices,
+			topology,
+			materialsBuffer,
+			materialsAtlas
+		);
+		return make_handle(meshes, id);
+	}
+
+	/*
+		Frees the mesh and its geometry pool ranges right away; handles to it turn
+		stale. Meshes that are still referenced by visible renderers must not be
+		destroyed, primitive meshes never are.
+	*/
+	void RenderContext_T::destroyMesh(GpuMesh mesh)
+	{
+		if (!mesh.valid())
+			return;
+
+		DEBUG_ASSERT(std::ranges::find(primitiveMeshes, mesh) == std::end(primitiveMeshes), "Primitive meshes can not be destroyed.");
+
+#ifdef LUNAR_OPENGL
+		if (mesh->isPooled())
+		{
+			geometryPool.freeVertices(mesh->getVertexRange());
+			geometryPool.freeIndices(mesh->getIndexRange());
+		}
+
+		geometryPool.freeMaterials(mesh->getMaterialRange());
+		geometryPool.freePrimitives(mesh->getPrimitiveRange());
+#endif
+
+		meshes.erase(mesh.getId());
 	}
 
 	GpuCubemap RenderContext_T::createCubemap
@@ -125,8 +210,8 @@ namespace lunar::Render
 		bool  isSourceHdr
 	)
 	{
-		cubemaps.emplace_back(this, width, height, data, isSourceHdr);
-		return make_handle(cubemaps);
+		SlotId id = cubemaps.emplace(this, width, height, data, isSourceHdr);
+		return make_handle(cubemaps, id);
 	}
 
 	void RenderContext_T::loadDefaultMeshes()
@@ -203,13 +288,13 @@ namespace lunar::Render
 			2, 1, 3
 		};
 
-		GpuMeshBuilder()
+		primitiveMeshes[static_cast<size_t>(MeshPrimitive::eCube)] = GpuMeshBuilder()
 			.useRenderContext(this)
 			.fromVertexArray(cube_vertices)
 			.fromIndexArray(cube_indices)
 			.build();
 
-		GpuMeshBuilder()
+		primitiveMeshes[static_cast<size_t>(MeshPrimitive::eQuad)] = GpuMeshBuilder()
 			.useRenderContext(this)
 			.fromVertexArray(quad_vertices)
 			.fromIndexArray(quad_indices)
@@ -278,6 +363,17 @@ namespace lunar::Render
 			.addFragmentSource(Fs::fromData("shader-src/pbr.frag"))
 			.build(this)->refCount += 2;
 
+		GpuProgramBuilder()
+			.graphicsShader()
+			.addVertexSource(Fs::fromData("shader-src/pbr_instanced.vert"))
+			.addFragmentSource(Fs::fromData("shader-src/pbr_instanced.frag"))
+			.build(this)->refCount += 2;
+
+		useInstancedVariant(
+			getProgram(GpuDefaultPrograms::eBasicPbrShader),
+			getProgram(GpuDefaultPrograms::eInstancedPbrShader)
+		);
+
 		defaultProgramsBuilt = true;
 		DEBUG_LOG("Built default GPU programs.");
 	}
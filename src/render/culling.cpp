@@ -0,0 +1,150 @@
+#include <lunar/render/culling.hpp>
+#include <lunar/debug/assert.hpp>
+#include <cfloat>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#	define LUNAR_CULLING_SIMD 1
+#	include <immintrin.h>
+#else
+#	define LUNAR_CULLING_SIMD 0
+#endif
+
+#if LUNAR_CULLING_SIMD && (defined(__GNUC__) || defined(__clang__))
+#	define LUNAR_TARGET(isa) __attribute__((target(isa)))
+#else
+#	define LUNAR_TARGET(isa)
+#endif
+
+namespace lunar::Render::imp
+{
+	void FrustumCuller::clear()
+	{
+		cx.clear(); cy.clear(); cz.clear();
+		radius.clear();
+		visible.clear();
+	}
+
+	void FrustumCuller::reserve(size_t count)
+	{
+		cx.reserve(count); cy.reserve(count); cz.reserve(count);
+		radius.reserve(count);
+		visible.reserve(count);
+	}
+
+	size_t FrustumCuller::size() const
+	{
+		return radius.size();
+	}
+
+	void FrustumCuller::push(const BoundingSphere& sphere)
+	{
+		cx.push_back(sphere.center.x);
+		cy.push_back(sphere.center.y);
+		cz.push_back(sphere.center.z);
+		radius.push_back(sphere.isEmpty() ? FLT_MAX : sphere.radius);
+	}
+
+	/* Returns the number of visible spheres. */
+	uint32_t FrustumCuller::run(const Frustum& frustum, TransformKernel kernel)
+	{
+		const size_t count = size();
+		visible.resize(count);
+
+		switch (kernel)
+		{
+#if LUNAR_CULLING_SIMD
+		case TransformKernel::eAVX2: cullAVX2(frustum, 0, count);   break;
+		case TransformKernel::eSSE4: cullSSE4(frustum, 0, count);   break;
+#endif
+		default:                     cullScalar(frustum, 0, count); break;
+		}
+
+		uint32_t visible_count = 0;
+		for (uint8_t flag : visible)
+			visible_count += flag;
+
+		return visible_count;
+	}
+
+	bool FrustumCuller::isVisible(size_t index) const
+	{
+		DEBUG_ASSERT(index < visible.size());
+		return visible[index] != 0;
+	}
+
+	/* A sphere is outside once its center lies farther than its radius behind any plane. */
+	void FrustumCuller::cullScalar(const Frustum& frustum, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			bool inside = true;
+			for (const auto& plane : frustum.planes)
+				inside &= plane.x * cx[i] + plane.y * cy[i] + plane.z * cz[i] + plane.w >= -radius[i];
+
+			visible[i] = inside ? 1 : 0;
+		}
+	}
+
+#if LUNAR_CULLING_SIMD
+	LUNAR_TARGET("sse4.1")
+	void FrustumCuller::cullSSE4(const Frustum& frustum, size_t begin, size_t end)
+	{
+		const __m128 zero = _mm_setzero_ps();
+
+		size_t i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(&cx[i]), y = _mm_loadu_ps(&cy[i]), z = _mm_loadu_ps(&cz[i]);
+			__m128 negative_radius = _mm_sub_ps(zero, _mm_loadu_ps(&radius[i]));
+			__m128 inside          = _mm_cmpeq_ps(zero, zero);
+
+			for (const auto& plane : frustum.planes)
+			{
+				__m128 distance = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+					_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w))
+				);
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negative_radius));
+			}
+
+			int mask = _mm_movemask_ps(inside);
+			for (int lane = 0; lane < 4; lane++)
+				visible[i + lane] = (mask >> lane) & 1;
+		}
+
+		cullScalar(frustum, i, end);
+	}
+
+	LUNAR_TARGET("avx2")
+	void FrustumCuller::cullAVX2(const Frustum& frustum, size_t begin, size_t end)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+
+		size_t i = begin;
+		for (; i + 8 <= end; i += 8)
+		{
+			__m256 x = _mm256_loadu_ps(&cx[i]), y = _mm256_loadu_ps(&cy[i]), z = _mm256_loadu_ps(&cz[i]);
+			__m256 negative_radius = _mm256_sub_ps(zero, _mm256_loadu_ps(&radius[i]));
+			__m256 inside          = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+
+			for (const auto& plane : frustum.planes)
+			{
+				__m256 distance = _mm256_add_ps(
+					_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane.x)), _mm256_mul_ps(y, _mm256_set1_ps(plane.y))),
+					_mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(plane.z)), _mm256_set1_ps(plane.w))
+				);
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negative_radius, _CMP_GE_OQ));
+			}
+
+			int mask = _mm256_movemask_ps(inside);
+			for (int lane = 0; lane < 8; lane++)
+				visible[i + lane] = (mask >> lane) & 1;
+		}
+
+		cullSSE4(frustum, i, end);
+	}
+#else
+	void FrustumCuller::cullSSE4(const Frustum& frustum, size_t begin, size_t end) { cullScalar(frustum, begin, end); }
+	void FrustumCuller::cullAVX2(const Frustum& frustum, size_t begin, size_t end) { cullScalar(frustum, begin, end); }
+#endif
+}
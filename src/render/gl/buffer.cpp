@@ -2,6 +2,7 @@
 #include <lunar/debug/assert.hpp>
 
 #include <glad/gl.h>
+#include <algorithm>
 
 namespace lunar::Render
 {
@@ -32,6 +33,11 @@ namespace lunar::Render
 		}
 	}
 
+	void GpuBuffer_T::bind()
+	{
+		glBindBuffer((GLenum)type, handle);
+	}
+
 	void GpuBuffer_T::bind(size_t location)
 	{
 		glBindBuffer((GLenum)type, handle);
@@ -45,6 +51,25 @@ namespace lunar::Render
 		glBindBuffer((GLenum)type, 0);
 	}
 
+	/*
+		Moves the contents into a new buffer of `size` bytes, truncating them if it
+		is smaller. Handles keep referring to the buffer, but the GL name changes,
+		so it has to be bound again.
+	*/
+	void GpuBuffer_T::resize(size_t size)
+	{
+		DEBUG_ASSERT(handle != 0);
+
+		GLuint buffer = 0;
+		glCreateBuffers(1, &buffer);
+		glNamedBufferData(buffer, size, nullptr, (GLenum)usageFlags);
+		glCopyNamedBufferSubData(handle, buffer, 0, 0, std::min(this->size, size));
+		glDeleteBuffers(1, &handle);
+
+		this->handle = buffer;
+		this->size   = size;
+	}
+
 	size_t GpuBuffer_T::getSize() const
 	{
 		DEBUG_ASSERT(handle != 0);
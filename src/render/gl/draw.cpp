@@ -3,15 +3,25 @@
 #include <lunar/render/components.hpp>
 #include <lunar/debug/assert.hpp>
 #include <lunar/core/scene.hpp>
+#include <lunar/core/frame_runner.hpp>
 #include <lunar/core/component.hpp>
 
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <numeric>
+#include <bit>
+#include <cstring>
 
 namespace lunar::Render
 {
+	static bool IsWindow(RenderTarget* target)
+	{
+		return target != nullptr && typeid(*target).hash_code() == typeid(Window_T).hash_code();
+	}
+
 	void RenderContext_T::begin(RenderTarget* target)
 	{
 		//this->renderCamera = &camera;
@@ -21,10 +31,11 @@ namespace lunar::Render
 		int v_width  = target->getRenderWidth();
 		int v_height = target->getRenderHeight();
 
-		if (typeid(*target).hash_code() == typeid(Window_T).hash_code())
+		if (IsWindow(target))
 		{
 			Window_T* window = static_cast<Window_T*>(target);
 			glfwMakeContextCurrent(window->glfwGetHandle());
+			window->getBackendData().frameData.beginFrame();
 		}
 
 		if (typeid(*target).hash_code() == typeid(GpuTexture_T).hash_code())
@@ -56,19 +67,63 @@ namespace lunar::Render
 		glClearColor(r, g, b, a);
 	}
 
+	/*
+		Grows the instance id buffer to at least `count` entries and binds it to
+		the per-instance attribute of the global VAO right away.
+	*/
+	static void ReserveInstances(RenderContext_T* context, imp::WindowBackendData& data, size_t count)
+	{
+		if (count <= data.instanceCapacity)
+			return;
+
+		size_t capacity = std::max<size_t>(1024, std::bit_ceil(count));
+		auto   ids      = vector<uint32_t>(capacity);
+		std::iota(ids.begin(), ids.end(), 0u);
+
+		data.instanceIds      = context->createBuffer(GpuBufferType::eVertex, GpuBufferUsageFlagBits::eStatic, capacity * sizeof(uint32_t), ids.data());
+		data.instanceCapacity = capacity;
+
+		glBindVertexArray(data.globalVao);
+		glBindBuffer(GL_ARRAY_BUFFER, data.instanceIds->glGetHandle());
+		glVertexAttribIPointer(5, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+		glVertexAttribDivisor(5, 1);
+		glEnableVertexAttribArray(5);
+	}
+
+	/* Index and vertex offsets come from the mesh's ranges, so pooled and standalone meshes draw alike. */
+	static void DrawMesh(GpuMesh_T& mesh, uint32_t instanceCount = 1, uint32_t baseInstance = 0)
+	{
+		const GeometryRange indices = mesh.getIndexRange();
+
+		glDrawElementsInstancedBaseVertexBaseInstance(
+			(GLenum)mesh.getTopology(),
+			indices.count,
+			GL_UNSIGNED_INT,
+			(void*)(indices.first * sizeof(uint32_t)),
+			instanceCount,
+			mesh.getVertexRange().first,
+			baseInstance
+		);
+	}
+
 	void RenderContext_T::draw(GpuMesh mesh)
+	{
+		bindMesh(mesh);
+		DrawMesh(mesh.get());
+	}
+
+	void RenderContext_T::bindMesh(GpuMesh mesh)
 	{
 		GLuint    vao = (target == nullptr)
 			? imp::GetGlobalRenderContext().glfw.vao
 			: static_cast<Window_T*>(target)->getBackendData().globalVao;
 
-		GpuBuffer vertex    = mesh->getVertexBuffer();
-		GpuBuffer index     = mesh->getIndexBuffer();
 		GpuBuffer materials = mesh->getMaterialsBuffer();
 
 		glBindVertexArray(vao);
-		glBindBuffer(GL_ARRAY_BUFFER, vertex->glGetHandle());
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index->glGetHandle());
+		glBindBuffer(GL_ARRAY_BUFFER, mesh->getVertexBuffer()->glGetHandle());
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->getIndexBuffer()->glGetHandle());
+
 		if (materials.exists())
 		{
 			materials->bind(2);
@@ -83,12 +138,19 @@ namespace lunar::Render
 		glEnableVertexAttribArray(2);
 		glEnableVertexAttribArray(3);
 		glEnableVertexAttribArray(4);
-
-		glDrawElements((GLenum)mesh->getTopology(), mesh->getIndicesCount(), GL_UNSIGNED_INT, 0);
 	}
 
+	/*
+		Per-frame data is streamed through the window's ring buffer and instance
+		ids feed the window's VAO; texture targets own neither, so scenes can only
+		be drawn into windows.
+	*/
 	void RenderContext_T::draw(Scene& scene)
 	{
+		DEBUG_ASSERT(IsWindow(target), "Scenes can only be drawn into a window.");
+		if (!IsWindow(target))
+			return;
+
 		Window_T* window      = static_cast<Window_T*>(target);
 		auto&     window_data = window->getBackendData();
 		
@@ -99,43 +161,247 @@ namespace lunar::Render
 			.cameraPosition = renderCamera->getTransform().position
 		};
 
-		window_data.sceneDataUniform->upload(scene_data);
-		window_data.sceneDataUniform->bind(0);
+		auto      scene_range = window_data.frameData.push(scene_data, GL_UNIFORM_BUFFER);
+		glBindBufferRange(GL_UNIFORM_BUFFER, 0, scene_range.buffer, scene_range.offset, scene_range.size);
 
-		auto components = scene.getComponents();
-		for (Component& component : components)
+		/*
+			Gathers everything drawable first, so the world-space bounding spheres can
+			be culled in one SIMD pass before anything is submitted.
+		*/
+		drawItems.clear();
+		culler.clear();
+		for (auto [object, mesh_renderer] : scene.view<MeshRenderer>())
 		{
-			if (component == nullptr || typeid(*component).hash_code() != typeid(MeshRenderer).hash_code())
+			auto& mesh    = mesh_renderer.mesh;
+			auto& program = mesh_renderer.program;
+
+			// Meshes of an asynchronously loaded scene show up once their upload is done
+			if (!mesh.valid() || !program.exists())
+				continue;
+
+			auto& item    = drawItems.emplace_back();
+			item.renderer = &mesh_renderer;
+			item.model    = interpolation != nullptr
+				? interpolation->getWorldTransform(object.get())
+				: object->getWorldTransform();
+
+			item.bounds   = mesh->getBoundingSphere().transformed(item.model);
+			culler.push(item.bounds);
+		}
+
+		cullingStats.tested  = static_cast<uint32_t>(drawItems.size());
+		cullingStats.visible = frustumCulling
+			? culler.run(Frustum::FromMatrix(scene_data.projection * scene_data.view))
+			: cullingStats.tested;
+		cullingStats.culled  = cullingStats.tested - cullingStats.visible;
+
+		/*
+			Opaque items are sorted by state first and front to back within a state
+			group. Uniform locations are cached by the programs, and every piece of
+			state is only rebound when it differs from the previous item's.
+		*/
+		renderQueue.clear();
+		for (size_t i = 0; i < drawItems.size(); i++)
+		{
+			if (frustumCulling && !culler.isVisible(i))
+				continue;
+
+			auto& item  = drawItems[i];
+			auto& mesh  = item.renderer->mesh;
+			auto  atlas = mesh->getMaterialsAtlas();
+			float depth = -(scene_data.view * glm::vec4(item.bounds.center, 1.f)).z;
+
+			renderQueue.push(imp::MakeSortKey(
+				RenderPass::eOpaque,
+				item.renderer->program->glGetHandle(),
+				atlas.exists() ? atlas->glGetHandle() : 0,
+				mesh.getId().index,
+				depth
+			), static_cast<uint32_t>(i));
+		}
+		renderQueue.sort();
+
+		/*
+			Equal program, material and mesh are adjacent after sorting; each run
+			becomes one batch. The model matrices of instanced batches are packed
+			together and pooled batches get an indirect command, so both are
+			written to the frame's ring buffer in one go.
+		*/
+		auto sorted = renderQueue.getItems();
+
+		drawBatches.clear();
+		instanceData.clear();
+		indirectCommands.clear();
+		for (uint32_t first = 0, last = 0; first < sorted.size(); first = last)
+		{
+			const auto& head = drawItems[sorted[first]];
+			for (last = first + 1; last < sorted.size(); last++)
+			{
+				const auto& item = drawItems[sorted[last]];
+				if (&item.renderer->mesh.get()    != &head.renderer->mesh.get() ||
+					&item.renderer->program.get() != &head.renderer->program.get())
+					break;
+			}
+
+			auto& mesh       = head.renderer->mesh;
+			auto  primitives = mesh->getPrimitiveRange();
+			bool  instanced  = primitives.count > 0 || !mesh->getMaterialsBuffer().exists();
+
+			auto& batch      = drawBatches.emplace_back();
+			batch.first      = first;
+			batch.count      = last - first;
+			batch.program    = instanced && (batch.count >= imp::DrawBatch::INSTANCING_THRESHOLD || mesh->isPooled())
+				? findInstancedVariant(&head.renderer->program.get())
+				: nullptr;
+
+			if (batch.program == nullptr)
 				continue;
 
-			MeshRenderer* mesh_renderer = static_cast<MeshRenderer*>(component.get());
-			auto&         mesh          = mesh_renderer->mesh;
-			auto&         program       = mesh_renderer->program;
-			auto          mesh_atlas    = mesh->getMaterialsAtlas();
-			auto          mesh_data     = imp::GpuMeshData
+			batch.firstInstance = static_cast<uint32_t>(instanceData.size());
+			for (uint32_t i = first; i < last; i++)
+			{
+				instanceData.push_back(imp::GpuInstanceData{
+					.model         = drawItems[sorted[i]].model,
+					.primitiveBase = primitives.count > 0 ? primitives.first : imp::GpuInstanceData::NO_MATERIALS,
+				});
+			}
+
+			if (!mesh->isPooled())
+				continue;
+
+			batch.command = static_cast<uint32_t>(indirectCommands.size());
+			indirectCommands.push_back(DrawElementsIndirectCommand{
+				.count         = mesh->getIndexRange().count,
+				.instanceCount = batch.count,
+				.firstIndex    = mesh->getIndexRange().first,
+				.baseVertex    = static_cast<int32_t>(mesh->getVertexRange().first),
+				.baseInstance  = batch.firstInstance,
+			});
+		}
+
+		if (!instanceData.empty())
+		{
+			ReserveInstances(this, window_data, instanceData.size());
+
+			auto range = window_data.frameData.allocate(instanceData.size() * sizeof(imp::GpuInstanceData), GL_SHADER_STORAGE_BUFFER);
+			std::memcpy(range.data, instanceData.data(), instanceData.size() * sizeof(imp::GpuInstanceData));
+			glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 3, range.buffer, range.offset, range.size);
+
+			geometryPool.getMaterialBuffer()->bind(4);
+			geometryPool.getPrimitiveBuffer()->bind(5);
+		}
+
+		size_t indirect_offset = 0;
+		if (!indirectCommands.empty())
+		{
+			auto range = window_data.frameData.allocate(indirectCommands.size() * sizeof(DrawElementsIndirectCommand), GL_DRAW_INDIRECT_BUFFER);
+			std::memcpy(range.data, indirectCommands.data(), indirectCommands.size() * sizeof(DrawElementsIndirectCommand));
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, range.buffer);
+			indirect_offset = range.offset;
+		}
+
+		GpuProgram_T* current_program = nullptr;
+		GpuTexture_T* current_atlas   = nullptr;
+		GpuMesh_T*    current_mesh    = nullptr;
+
+		auto use_state = [&](GpuProgram_T* program, GpuMesh& mesh) {
+			if (program != current_program)
+			{
+				program->use();
+				program->bind("environmentMap", 0, cubemap->environmentMap);
+				program->bind("irradianceMap", 1, cubemap->irradianceMap);
+				program->bind("prefilterMap", 2, cubemap->prefilterMap);
+				program->bind("brdfMap", 3, cubemap->brdfLut);
+
+				current_program = program;
+				current_atlas   = nullptr; // the sampler uniform belongs to the program
+			}
+
+			auto mesh_atlas = mesh->getMaterialsAtlas();
+			if (mesh_atlas.exists() && &mesh_atlas.get() != current_atlas)
 			{
-				.model = mesh_renderer
-					->getGameObject()
-					->getWorldTransform()
-			};
-
-			program->use();
-			program->bind("environmentMap", 0, cubemap->environmentMap);
-			program->bind("irradianceMap", 1, cubemap->irradianceMap);
-			program->bind("prefilterMap", 2, cubemap->prefilterMap);
-			program->bind("brdfMap", 3, cubemap->brdfLut);
-
-			if(mesh_atlas.exists())
 				program->bind("albedoAtlas", 4, mesh_atlas);
-			
+				current_atlas = &mesh_atlas.get();
+			}
 
-			window_data.meshDataUniform->upload(mesh_data);
-			window_data.meshDataUniform->bind(1);
+			if (&mesh.get() != current_mesh)
+			{
+				bindMesh(mesh);
+				current_mesh = &mesh.get();
+			}
+		};
+
+		for (size_t b = 0; b < drawBatches.size(); )
+		{
+			const auto& batch = drawBatches[b];
+			auto&       head  = drawItems[sorted[batch.first]];
+			auto&       mesh  = head.renderer->mesh;
+
+			/*
+				Pooled batches are merged with the following ones for as long as
+				program and topology match: the geometry and the materials all come
+				from the geometry pool, and per-draw data (model matrix, first
+				material index) is reached through the instance attribute, which the
+				command's base instance offsets. Each mesh's atlas is referenced by a
+				bindless handle in its materials, and stays uniform within a draw.
+			*/
+			if (batch.command != imp::DrawBatch::NO_COMMAND)
+			{
+				size_t end = b + 1;
+				while (end < drawBatches.size())
+				{
+					const auto& next      = drawBatches[end];
+					auto&       next_mesh = drawItems[sorted[next.first]].renderer->mesh;
+					if (next.command == imp::DrawBatch::NO_COMMAND || next.program != batch.program ||
+						next_mesh->getTopology() != mesh->getTopology())
+						break;
+					end++;
+				}
+
+				use_state(batch.program, mesh);
+				glMultiDrawElementsIndirect(
+					(GLenum)mesh->getTopology(),
+					GL_UNSIGNED_INT,
+					(void*)(indirect_offset + batch.command * sizeof(DrawElementsIndirectCommand)),
+					static_cast<GLsizei>(end - b),
+					0
+				);
+
+				b = end;
+				continue;
+			}
 
-			draw(mesh);
+			if (batch.program != nullptr)
+			{
+				use_state(batch.program, mesh);
+				DrawMesh(mesh.get(), batch.count, batch.firstInstance);
+			}
+			else
+			{
+				for (uint32_t i = batch.first; i < batch.first + batch.count; i++)
+				{
+					auto& item = drawItems[sorted[i]];
+					use_state(&item.renderer->program.get(), item.renderer->mesh);
+
+					auto mesh_range = window_data.frameData.push(imp::GpuMeshData{ .model = item.model }, GL_UNIFORM_BUFFER);
+					glBindBufferRange(GL_UNIFORM_BUFFER, 1, mesh_range.buffer, mesh_range.offset, mesh_range.size);
+					DrawMesh(item.renderer->mesh.get());
+				}
+			}
+
+			b++;
 		}
 	}
 
+	GpuProgram_T* RenderContext_T::findInstancedVariant(const GpuProgram_T* program)
+	{
+		for (auto& [base, variant] : instancedVariants)
+			if (&base.get() == program)
+				return &variant.get();
+
+		return nullptr;
+	}
+
 	void RenderContext_T::draw(GpuCubemap cubemap)
 	{
 		const GpuMesh cube_mesh  = getMesh(MeshPrimitive::eCube);
@@ -157,6 +423,9 @@ namespace lunar::Render
 
 	void RenderContext_T::end()
 	{
+		if (IsWindow(target))
+			static_cast<Window_T*>(target)->getBackendData().frameData.endFrame();
+
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
 		this->inFrameScope = false;
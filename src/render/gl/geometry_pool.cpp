@@ -0,0 +1,199 @@
+#include <lunar/render/imp/gl/geometry_pool.hpp>
+#include <lunar/render/context.hpp>
+#include <lunar/debug/assert.hpp>
+
+#include <algorithm>
+#include <bit>
+
+namespace lunar::Render
+{
+	namespace imp
+	{
+		GeometryPool::~GeometryPool() noexcept
+		{
+			release();
+		}
+
+		void GeometryPool::create(RenderContext_T* context)
+		{
+			Create(context, vertices, GpuBufferType::eVertex, sizeof(Vertex), INITIAL_VERTICES);
+			Create(context, indices, GpuBufferType::eIndex, sizeof(uint32_t), INITIAL_INDICES);
+			Create(context, materials, GpuBufferType::eShaderStorage, sizeof(GpuMaterialData), INITIAL_MATERIALS);
+			Create(context, primitives, GpuBufferType::eShaderStorage, sizeof(uint32_t), INITIAL_PRIMITIVES);
+		}
+
+		/*
+			Drops the pool's references to its buffers; meshes still holding them
+			keep them alive. Must run before the context's buffer list is cleared.
+		*/
+		void GeometryPool::release()
+		{
+			for (Storage* storage : { &vertices, &indices, &materials, &primitives })
+			{
+				GpuBuffer buffer = std::move(storage->buffer);
+				*storage = {};
+			}
+		}
+
+		GeometryRange GeometryPool::addVertices(const std::span<const Vertex>& data)
+		{
+			return Append(vertices, data.data(), static_cast<uint32_t>(data.size()));
+		}
+
+		GeometryRange GeometryPool::addIndices(const std::span<const uint32_t>& data)
+		{
+			return Append(indices, data.data(), static_cast<uint32_t>(data.size()));
+		}
+
+		GeometryRange GeometryPool::addMaterials(const std::span<const GpuMaterialData>& data)
+		{
+			return Append(materials, data.data(), static_cast<uint32_t>(data.size()));
+		}
+
+		GeometryRange GeometryPool::addPrimitives(const std::span<const uint32_t>& data)
+		{
+			return Append(primitives, data.data(), static_cast<uint32_t>(data.size()));
+		}
+
+		void GeometryPool::freeVertices(GeometryRange range)
+		{
+			Free(vertices, range);
+		}
+
+		void GeometryPool::freeIndices(GeometryRange range)
+		{
+			Free(indices, range);
+		}
+
+		void GeometryPool::freeMaterials(GeometryRange range)
+		{
+			Free(materials, range);
+		}
+
+		void GeometryPool::freePrimitives(GeometryRange range)
+		{
+			Free(primitives, range);
+		}
+
+		uint32_t GeometryPool::getVertexCount() const
+		{
+			return vertices.size;
+		}
+
+		uint32_t GeometryPool::getIndexCount() const
+		{
+			return indices.size;
+		}
+
+		GpuBuffer GeometryPool::getVertexBuffer() const
+		{
+			return vertices.buffer;
+		}
+
+		GpuBuffer GeometryPool::getIndexBuffer() const
+		{
+			return indices.buffer;
+		}
+
+		GpuBuffer GeometryPool::getMaterialBuffer() const
+		{
+			return materials.buffer;
+		}
+
+		GpuBuffer GeometryPool::getPrimitiveBuffer() const
+		{
+			return primitives.buffer;
+		}
+
+		void GeometryPool::Create(RenderContext_T* context, Storage& storage, GpuBufferType type, size_t elementSize, uint32_t capacity)
+		{
+			storage.buffer      = context->createBuffer(type, GpuBufferUsageFlagBits::eStatic, capacity * elementSize, nullptr);
+			storage.elementSize = elementSize;
+			storage.capacity    = capacity;
+		}
+
+		/* Buffers are only written through DSA, so no binding of any context gets disturbed. */
+		GeometryRange GeometryPool::Append(Storage& storage, const void* data, uint32_t count)
+		{
+			DEBUG_ASSERT(storage.buffer.exists(), "The geometry pool is created with the render context.");
+
+			const size_t element_size = storage.elementSize;
+
+			auto hole = std::ranges::find_if(storage.holes, [count](const GeometryRange& range) { return range.count >= count; });
+			if (count > 0 && hole != storage.holes.end())
+			{
+				auto range = GeometryRange{ hole->first, count };
+				glNamedBufferSubData(storage.buffer->glGetHandle(), range.first * element_size, count * element_size, data);
+
+				hole->first += count;
+				hole->count -= count;
+				if (hole->count == 0)
+					storage.holes.erase(hole);
+
+				return range;
+			}
+
+			const uint32_t required = storage.size + count;
+			if (required > storage.capacity)
+			{
+				storage.capacity = std::bit_ceil(required);
+				storage.buffer->resize(storage.capacity * element_size);
+			}
+
+			auto range = GeometryRange{ storage.size, count };
+			if (count > 0)
+				glNamedBufferSubData(storage.buffer->glGetHandle(), storage.size * element_size, count * element_size, data);
+
+			storage.size = required;
+			return range;
+		}
+
+		/* Merges the range with its neighbouring holes; a hole reaching the end just shrinks the storage. */
+		void GeometryPool::Free(Storage& storage, GeometryRange range)
+		{
+			if (range.count == 0)
+				return;
+
+			auto next = std::ranges::upper_bound(storage.holes, range.first, {}, &GeometryRange::first);
+			if (next != storage.holes.begin() && std::prev(next)->first + std::prev(next)->count == range.first)
+			{
+				next         = std::prev(next);
+				range.first  = next->first;
+				range.count += next->count;
+				next         = storage.holes.erase(next);
+			}
+
+			if (next != storage.holes.end() && range.first + range.count == next->first)
+			{
+				range.count += next->count;
+				next         = storage.holes.erase(next);
+			}
+
+			if (range.first + range.count == storage.size)
+				storage.size = range.first;
+			else
+				storage.holes.insert(next, range);
+		}
+	}
+
+	GeometryRange RenderContext_T::uploadVertices(const std::span<const Vertex>& vertices)
+	{
+		return geometryPool.addVertices(vertices);
+	}
+
+	GeometryRange RenderContext_T::uploadIndices(const std::span<const uint32_t>& indices)
+	{
+		return geometryPool.addIndices(indices);
+	}
+
+	GeometryRange RenderContext_T::uploadMaterials(const std::span<const imp::GpuMaterialData>& materials)
+	{
+		return geometryPool.addMaterials(materials);
+	}
+
+	/* One material index per triangle, relative to the start of the pool's materials. */
+	GeometryRange RenderContext_T::uploadPrimitiveMaterials(const std::span<const uint32_t>& materialIndices)
+	{
+		return geometryPool.addPrimitives(materialIndices);
+	}
+}
@@ -36,6 +36,7 @@ namespace lunar::Render
 		imp::GetGlobalRenderContext();
 
 		loadDefaultPrograms();
+		geometryPool.create(this);
 		loadDefaultMeshes();
 
 		glGenFramebuffers(1, &frameBuffer);
@@ -44,6 +45,7 @@ namespace lunar::Render
 
 	RenderContext_T::~RenderContext_T() noexcept
 	{
+		geometryPool.release();
 		cubemaps.clear();
 		meshes.clear();
 		programs.clear();
@@ -83,24 +85,14 @@ namespace lunar::Render
 
 		glGenVertexArrays(1, &imp.globalVao);
 
-		imp.sceneDataUniform = context->createBuffer(
-			GpuBufferType::eUniform,
-			GpuBufferUsageFlagBits::eDynamic,
-			sizeof(imp::GpuSceneData),
-			nullptr
-		);
-
-		imp.meshDataUniform = context->createBuffer(
-			GpuBufferType::eUniform,
-			GpuBufferUsageFlagBits::eDynamic,
-			sizeof(imp::GpuMeshData),
-			nullptr
-		);
+		imp.frameData.create(imp::WindowBackendData::FRAME_DATA_CAPACITY);
 	}
 
 	void Window_T::clearBackendData()
 	{
-		imp.meshDataUniform = nullptr;
+		imp.frameData.release();
+		imp.instanceIds      = nullptr;
+		imp.instanceCapacity = 0;
 		glDeleteVertexArrays(1, &imp.globalVao);
 	}
 
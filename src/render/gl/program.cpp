@@ -108,25 +108,25 @@ namespace lunar::Render
 
 	void GpuProgram_T::uniform(const std::string_view& name, const glm::vec4& v4)
 	{
-		GLint loc = glGetUniformLocation(handle, name.data());
+		GLint loc = getUniformLocation(name);
 		glUniform3fv(loc, 1, &v4.r);
 	}
 
 	void GpuProgram_T::uniform(const std::string_view& name, const glm::mat4& m4)
 	{
-		GLint loc = glGetUniformLocation(handle, name.data());
+		GLint loc = getUniformLocation(name);
 		glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(m4));
 	}
 
 	void GpuProgram_T::uniform(const std::string_view& name, const float f)
 	{
-		GLint loc = glGetUniformLocation(handle, name.data());
+		GLint loc = getUniformLocation(name);
 		glUniform1f(loc, f);
 	}
 
 	void GpuProgram_T::bind(const std::string_view& name, size_t location, GpuTexture texture)
 	{
-		GLint name_loc = glGetUniformLocation(handle, name.data());
+		GLint name_loc = getUniformLocation(name);
 		glUniform1i(name_loc, location);
 		glActiveTexture(GL_TEXTURE0 + location);
 		glBindTexture((GLenum)texture->getType(), texture->glGetHandle());
@@ -137,22 +137,43 @@ namespace lunar::Render
 		return handle;
 	}
 
+	/*
+		Uniform locations never change after linking, so each name is queried from
+		the driver once. Programs only have a handful of uniforms; a linear scan
+		over the hashes beats any map here.
+	*/
+	GLint GpuProgram_T::getUniformLocation(const std::string_view& name)
+	{
+		const size_t hash = lunar::imp::fnv1a_hash(name);
+		for (const auto& uniform : uniformLocations)
+			if (uniform.hash == hash && uniform.name == name)
+				return uniform.location;
+
+		auto& uniform    = uniformLocations.emplace_back();
+		uniform.hash     = hash;
+		uniform.name     = std::string(name);
+		uniform.location = glGetUniformLocation(handle, uniform.name.c_str());
+		return uniform.location;
+	}
+
 	/*
 		Move operators
 	*/
 
 	GpuProgram_T::GpuProgram_T(GpuProgram_T&& other) noexcept
 	{
-		this->handle      = std::move(other.handle);
-		this->programType = std::move(other.programType);
+		this->handle           = std::move(other.handle);
+		this->programType      = std::move(other.programType);
+		this->uniformLocations = std::move(other.uniformLocations);
 
 		other.handle = 0;
 	}
 
 	GpuProgram_T& GpuProgram_T::operator=(GpuProgram_T&& other) noexcept
 	{
-		this->handle      = std::move(other.handle);
-		this->programType = std::move(other.programType);
+		this->handle           = std::move(other.handle);
+		this->programType      = std::move(other.programType);
+		this->uniformLocations = std::move(other.uniformLocations);
 
 		other.handle = 0;
 		return *this;
@@ -0,0 +1,167 @@
+#include <lunar/render/imp/gl/ring_buffer.hpp>
+#include <lunar/debug/assert.hpp>
+#include <lunar/debug/log.hpp>
+
+#include <algorithm>
+
+namespace lunar::Render::imp
+{
+	static constexpr GLbitfield RING_STORAGE_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	RingBuffer::~RingBuffer() noexcept
+	{
+		release();
+	}
+
+	/* Must run with the owning GL context current. */
+	void RingBuffer::create(size_t frameCapacity)
+	{
+		release();
+
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+
+		this->frameCapacity = frameCapacity;
+		this->frame         = 0;
+		this->head          = 0;
+
+		glCreateBuffers(1, &buffer);
+		glNamedBufferStorage(buffer, frameCapacity * FRAMES, nullptr, RING_STORAGE_FLAGS);
+		mapped = static_cast<uint8_t*>(glMapNamedBufferRange(buffer, 0, frameCapacity * FRAMES, RING_STORAGE_FLAGS));
+		DEBUG_ASSERT(mapped != nullptr, "Could not map the ring buffer.");
+	}
+
+	void RingBuffer::release()
+	{
+		for (GLsync& fence : fences)
+		{
+			if (fence != nullptr)
+				glDeleteSync(fence);
+			fence = nullptr;
+		}
+
+		if (!retired.empty())
+			glDeleteBuffers(static_cast<GLsizei>(retired.size()), retired.data());
+		retired.clear();
+
+		if (buffer != 0)
+		{
+			glUnmapNamedBuffer(buffer);
+			glDeleteBuffers(1, &buffer);
+		}
+
+		buffer        = 0;
+		mapped        = nullptr;
+		frameCapacity = 0;
+		head          = 0;
+	}
+
+	/*
+		Only blocks when the GPU is more than FRAMES - 1 frames behind, which is
+		exactly when the segment about to be rewritten may still be read.
+	*/
+	void RingBuffer::beginFrame()
+	{
+		if (!retired.empty())
+		{
+			glDeleteBuffers(static_cast<GLsizei>(retired.size()), retired.data());
+			retired.clear();
+		}
+
+		frame = (frame + 1) % FRAMES;
+		head  = 0;
+
+		GLsync& fence = fences[frame];
+		if (fence == nullptr)
+			return;
+
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		while (true)
+		{
+			GLenum result = glClientWaitSync(fence, flags, 1'000'000);
+			if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+				break;
+
+			if (result == GL_WAIT_FAILED)
+			{
+				DEBUG_ERROR("Waiting for the GPU to release a ring buffer segment failed, it is reused as is.");
+				break;
+			}
+			flags = 0;
+		}
+
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	void RingBuffer::endFrame()
+	{
+		if (buffer == 0)
+			return;
+
+		if (fences[frame] != nullptr)
+			glDeleteSync(fences[frame]);
+		fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	/*
+		Offsets are aligned to what `target` requires for glBindBufferRange (4
+		bytes for anything but uniform and shader storage buffers). Sizes are
+		rounded up to 16 bytes, so std140 blocks ending in a vec3 are covered.
+	*/
+	RingAllocation RingBuffer::allocate(size_t size, GLenum target)
+	{
+		size_t alignment = 4;
+		if (target == GL_UNIFORM_BUFFER)
+			alignment = static_cast<size_t>(uniformAlignment);
+		else if (target == GL_SHADER_STORAGE_BUFFER)
+			alignment = static_cast<size_t>(storageAlignment);
+
+		size           = (size + 15) & ~size_t(15);
+		size_t offset  = (head + alignment - 1) / alignment * alignment;
+		if (offset + size > frameCapacity)
+		{
+			grow(size + alignment);
+			offset = 0;
+		}
+
+		head = offset + size;
+		offset += frame * frameCapacity;
+
+		return RingAllocation{
+			.buffer = buffer,
+			.offset = offset,
+			.size   = size,
+			.data   = mapped + offset,
+		};
+	}
+
+	/* The old buffer's pending reads are tracked by GL itself, so its fences can go. */
+	void RingBuffer::grow(size_t required)
+	{
+		size_t capacity = std::max(frameCapacity * 2, required);
+		GLuint old      = buffer;
+
+		for (GLsync& fence : fences)
+		{
+			if (fence != nullptr)
+				glDeleteSync(fence);
+			fence = nullptr;
+		}
+
+		buffer = 0;
+		glCreateBuffers(1, &buffer);
+		glNamedBufferStorage(buffer, capacity * FRAMES, nullptr, RING_STORAGE_FLAGS);
+		mapped = static_cast<uint8_t*>(glMapNamedBufferRange(buffer, 0, capacity * FRAMES, RING_STORAGE_FLAGS));
+		DEBUG_ASSERT(mapped != nullptr, "Could not map the ring buffer.");
+
+		if (old != 0)
+		{
+			glUnmapNamedBuffer(old);
+			retired.push_back(old);
+		}
+
+		frameCapacity = capacity;
+		head          = 0;
+	}
+}
@@ -303,9 +303,35 @@ namespace lunar::Render
 		//this->vertexArray->bind(this->vertexBuffer, this->indexBuffer);
 		vertexCount = this->vertexBuffer->getSize() / sizeof(Vertex);
 		indexCount  = this->indexBuffer->getSize() / sizeof(uint32_t);
+		vertexRange = GeometryRange{ 0, static_cast<uint32_t>(vertexCount) };
+		indexRange  = GeometryRange{ 0, static_cast<uint32_t>(indexCount) };
 		//this->vertexArray->unbind();
 	}
 
+	GpuMesh_T::GpuMesh_T
+	(
+		RenderContext_T*             context,
+		GpuBuffer                    vertexBuffer,
+		GpuBuffer                    indexBuffer,
+		GeometryRange                vertices,
+		GeometryRange                indices,
+		MeshTopology                 topology,
+		GpuBuffer                    materialsBuffer,
+		GpuTexture                   materialsAtlas
+	) noexcept : context(context),
+		vertexBuffer(vertexBuffer),
+		indexBuffer(indexBuffer),
+		materialsBuffer(materialsBuffer),
+		materialsAtlas(materialsAtlas),
+		vertexCount(vertices.count),
+		indexCount(indices.count),
+		meshTopology(topology),
+		vertexRange(vertices),
+		indexRange(indices),
+		pooled(true)
+	{
+	}
+
 	GpuMesh_T::~GpuMesh_T()
 	{
 
@@ -331,6 +357,10 @@ namespace lunar::Render
 		return meshTopology;
 	}
 
+	/*
+		Pooled meshes share their vertex and index buffers with every other pooled
+		mesh; getVertexRange() and getIndexRange() tell which part is theirs.
+	*/
 	GpuBuffer GpuMesh_T::getVertexBuffer()
 	{
 		return vertexBuffer;
@@ -350,4 +380,39 @@ namespace lunar::Render
 	{
 		return materialsAtlas;
 	}
+
+	const Aabb& GpuMesh_T::getBounds() const
+	{
+		return bounds;
+	}
+
+	const BoundingSphere& GpuMesh_T::getBoundingSphere() const
+	{
+		return sphere;
+	}
+
+	bool GpuMesh_T::isPooled() const
+	{
+		return pooled;
+	}
+
+	GeometryRange GpuMesh_T::getVertexRange() const
+	{
+		return vertexRange;
+	}
+
+	GeometryRange GpuMesh_T::getIndexRange() const
+	{
+		return indexRange;
+	}
+
+	GeometryRange GpuMesh_T::getMaterialRange() const
+	{
+		return materialRange;
+	}
+
+	GeometryRange GpuMesh_T::getPrimitiveRange() const
+	{
+		return primitiveRange;
+	}
 }
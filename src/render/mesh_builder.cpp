@@ -4,6 +4,8 @@
 #include <fastgltf/core.hpp>
 #include <fastgltf/tools.hpp>
 #include <fastgltf/glm_element_traits.hpp>
+#include <algorithm>
+#include <cmath>
 
 namespace lunar::Render
 {
@@ -21,24 +23,15 @@ namespace lunar::Render
 
 	GpuMeshBuilder& GpuMeshBuilder::fromVertexArray(const std::span<const Vertex>& vertices)
 	{
-		this->vertexBuffer = context->createBuffer(
-			GpuBufferType::eVertex,
-			GpuBufferUsageFlagBits::eStatic,
-			vertices.size() * sizeof(Render::Vertex),
-			(void*)vertices.data()
-		);
+		computeBounds(vertices);
+
+		this->vertexRange = context->uploadVertices(vertices);
 		return *this;
 	}
 
 	GpuMeshBuilder& GpuMeshBuilder::fromIndexArray(const std::span<const uint32_t>& indices)
 	{
-		this->indexBuffer = context->createBuffer(
-			GpuBufferType::eIndex,
-			GpuBufferUsageFlagBits::eStatic,
-			indices.size() * sizeof(uint32_t),
-			(void*)indices.data()
-		);
-
+		this->indexRange = context->uploadIndices(indices);
 		return *this;
 	}
 
@@ -56,17 +49,16 @@ namespace lunar::Render
 		int                                    totalHeight = 1;
 		int                                    textures    = 0;
 		std::unique_ptr<MaterialTextureData[]> materials   = nullptr;
-		GpuTexture                             handle      = nullptr;
 	};
 
 	inline void CreateTextureAtlas
 	(
-		RenderContext_T*  context,
 		fastgltf::Asset&  asset,
-		TextureAtlasInfo& output
+		TextureAtlasInfo& output,
+		MeshData&         mesh
 	)
 	{
-		auto  colors    = std::vector<uint32_t>();
+		auto& colors    = mesh.atlasPixels;
 		auto& materials = asset.materials;
 
 		for (fastgltf::Material& material : materials)
@@ -104,21 +96,13 @@ namespace lunar::Render
 			i++;
 		}
 
-		output.handle = context->createTexture
-		(
-			output.totalWidth,
-			output.totalHeight,
-			colors.data(),
-			TextureFormat::eRGBA,
-			TextureDataFormat::eUnsignedByte,
-			TextureFormat::eRGBA,
-			TextureType::e2D,
-			TextureFiltering::eNearest,
-			TextureFiltering::eNearest,
-			TextureWrapping::eRepeat
-		);
+		mesh.atlasWidth  = output.totalWidth;
+		mesh.atlasHeight = output.totalHeight;
 	}
 
+	/* Materials slots at the start of the materials storage buffer, see pbr.frag. */
+	static constexpr size_t MATERIAL_SLOTS = 20;
+
 	struct MappedMaterial
 	{
 		glm::vec2  atlasBegin = { 0, 0 };
@@ -162,7 +146,7 @@ namespace lunar::Render
 		}
 	}
 
-	void GpuMeshBuilder::fromGltfFile(const Fs::Path& path)
+	inline bool DecodeGltfFile(const Fs::Path& path, MeshData& output)
 	{
 		auto options = fastgltf::Options::LoadGLBBuffers | 
 						fastgltf::Options::LoadExternalBuffers | 
@@ -173,14 +157,14 @@ namespace lunar::Render
 		if (data.error() != fastgltf::Error::None)
 		{
 			DEBUG_ERROR("Couldn't open GLTF file at '{}'.", path.generic_string());
-			return;
+			return false;
 		}
 
 		auto asset = parser.loadGltf(data.get(), path.parent_path(), options);
 		if (asset.error() != fastgltf::Error::None)
 		{
 			DEBUG_ERROR("Couldn't parse GLTF file at '{}'.", path.generic_string());
-			return;
+			return false;
 		}
 		// todo; error
 
@@ -189,21 +173,21 @@ namespace lunar::Render
 		if (meshes.size() <= 0)
 		{
 			DEBUG_WARN("File '{}' does not contain any meshes.", path.generic_string());
-			return;
+			return false;
 		}
 
 		TextureAtlasInfo atlas_info     = {};
-		MappedMaterial   materials[20]  = {};
+		MappedMaterial   materials[MATERIAL_SLOTS] = {};
 		size_t           material_count = 0;
 
-		CreateTextureAtlas(context, asset.get(), atlas_info);
+		CreateTextureAtlas(asset.get(), atlas_info, output);
 		MapMaterialData(asset.get(), atlas_info, materials, material_count);
 
 		auto& mesh = asset->meshes[0];
 
-		auto vertices         = std::vector<Vertex>();
-		auto indices          = std::vector<uint32_t>();
-		auto material_indices = std::vector<int>();
+		auto& vertices         = output.vertices;
+		auto& indices          = output.indices;
+		auto  material_indices = std::vector<int>();
 		vertices.reserve(mesh.primitives.size() * 5); 
 		indices.reserve(mesh.primitives.size() * 5);
 		material_indices.reserve(mesh.primitives.size());
@@ -272,51 +256,155 @@ namespace lunar::Render
 			}
 		}
 
-		this->vertexBuffer = context->createBuffer(
-			GpuBufferType::eVertex,
-			GpuBufferUsageFlagBits::eStatic,
-			vertices.size() * sizeof(Vertex),
-			vertices.data()
-		);
+		size_t buf_size = sizeof(MappedMaterial) * MATERIAL_SLOTS + (material_indices.size() * sizeof(int));
+		output.materials.resize(buf_size);
+		std::memcpy(output.materials.data(), materials, sizeof(MappedMaterial) * MATERIAL_SLOTS);
+		std::memcpy(output.materials.data() + sizeof(MappedMaterial) * MATERIAL_SLOTS, material_indices.data(), material_indices.size() * sizeof(int));
 
-		this->indexBuffer = context->createBuffer(
-			GpuBufferType::eIndex,
-			GpuBufferUsageFlagBits::eStatic,
-			indices.size() * sizeof(uint32_t),
-			indices.data()
-		);
+		return true;
+	}
+
+	bool DecodeMeshFile(const Fs::Path& path, MeshData& output)
+	{
+		auto extension = path.extension().generic_string();
+		if (extension.compare(".gltf") == 0 || extension.compare(".glb") == 0)
+			return DecodeGltfFile(path, output);
+
+		DEBUG_WARN("Unsupported mesh file format '{}'.", extension);
+		return false;
+	}
 
-		size_t buf_size    = sizeof(MappedMaterial) * 20 + (material_indices.size() * sizeof(int));
-		auto   data_buffer = std::make_unique<uint8_t[]>(buf_size);
-		std::memcpy(data_buffer.get(), materials, sizeof(MappedMaterial) * 20);
-		std::memcpy(data_buffer.get() + sizeof(MappedMaterial) * 20, material_indices.data(), material_indices.size() * sizeof(int));
+	GpuMeshBuilder& GpuMeshBuilder::fromMeshFile(const Fs::Path& path)
+	{
+		auto data = MeshData();
+		if (DecodeMeshFile(path, data))
+			fromMeshData(data);
+
+		return *this;
+	}
+
+	GpuMeshBuilder& GpuMeshBuilder::fromMeshData(const MeshData& data)
+	{
+		if (data.empty())
+			return *this;
+
+		computeBounds(data.vertices);
+
+		this->vertexRange = context->uploadVertices(data.vertices);
+		this->indexRange  = context->uploadIndices(data.indices);
 
 		this->materialsBuffer = context->createBuffer(
 			GpuBufferType::eShaderStorage,
 			GpuBufferUsageFlagBits::eStatic,
-			buf_size,
-			data_buffer.get()
+			data.materials.size(),
+			(void*)data.materials.data()
 		);
 
-		this->materialsAtlas = atlas_info.handle;
+		if (data.atlasWidth > 0)
+		{
+			this->materialsAtlas = context->createTexture
+			(
+				data.atlasWidth,
+				data.atlasHeight,
+				(void*)data.atlasPixels.data(),
+				TextureFormat::eRGBA,
+				TextureDataFormat::eUnsignedByte,
+				TextureFormat::eRGBA,
+				TextureType::e2D,
+				TextureFiltering::eNearest,
+				TextureFiltering::eNearest,
+				TextureWrapping::eRepeat,
+				TextureFlagBits::eBindless
+			);
+		}
+
+		poolMaterials(data);
+		return *this;
 	}
 
-	GpuMeshBuilder& GpuMeshBuilder::fromMeshFile(const Fs::Path& path)
+	/*
+		Copies the materials the mesh uses into the geometry pool, referencing the
+		atlas through its bindless handle, and rebases the per-triangle indices onto
+		the pool's materials. Instanced and multi-drawn batches read them from there
+		(see pbr_instanced.frag), so meshes with different materials still merge.
+		The per-mesh buffer stays for programs without an instanced variant.
+	*/
+	void GpuMeshBuilder::poolMaterials(const MeshData& data)
 	{
-		auto extension = path.extension().generic_string();
-		if (extension.compare(".gltf") == 0 || extension.compare(".glb") == 0)
-			fromGltfFile(path);
+		constexpr size_t header_size = sizeof(MappedMaterial) * MATERIAL_SLOTS;
+		if (data.materials.size() <= header_size)
+			return;
 
-		return *this;
+		const auto* mapped  = reinterpret_cast<const MappedMaterial*>(data.materials.data());
+		const auto* indices = reinterpret_cast<const int*>(data.materials.data() + header_size);
+		const auto  count   = (data.materials.size() - header_size) / sizeof(int);
+
+		auto primitives = std::vector<uint32_t>(count);
+		auto used       = size_t(1);
+		for (size_t i = 0; i < count; i++)
+		{
+			primitives[i] = static_cast<uint32_t>(std::clamp<int>(indices[i], 0, MATERIAL_SLOTS - 1));
+			used          = std::max<size_t>(used, primitives[i] + 1);
+		}
+
+		const uint64_t atlas     = materialsAtlas.exists() ? materialsAtlas->glGetBindlessHandle() : 0;
+		auto           materials = std::vector<imp::GpuMaterialData>(used);
+		for (size_t i = 0; i < used; i++)
+		{
+			materials[i] = imp::GpuMaterialData
+			{
+				.atlasBegin = mapped[i].atlasBegin,
+				.atlasEnd   = mapped[i].atlasEnd,
+				.metallic   = mapped[i].metallic,
+				.roughness  = mapped[i].roughness,
+				.ao         = mapped[i].ao,
+				.atlas      = atlas
+			};
+		}
+
+		this->materialRange = context->uploadMaterials(materials);
+		for (auto& primitive : primitives)
+			primitive += materialRange.first;
+
+		this->primitiveRange = context->uploadPrimitiveMaterials(primitives);
 	}
 
 	GpuMesh GpuMeshBuilder::build()
 	{
-		return context->createMesh(vertexBuffer, indexBuffer, MeshTopology::eTriangles, materialsBuffer, materialsAtlas);
+		GpuMesh mesh = context->createMesh(vertexRange, indexRange, MeshTopology::eTriangles, materialsBuffer, materialsAtlas);
+		mesh->bounds         = bounds;
+		mesh->sphere         = sphere;
+		mesh->materialRange  = materialRange;
+		mesh->primitiveRange = primitiveRange;
+		return mesh;
+	}
+
+	/*
+		The sphere is centered on the box rather than being the minimal one, but
+		its radius is measured to the farthest vertex, so it is usually much
+		tighter than the box's circumscribed sphere.
+	*/
+	void GpuMeshBuilder::computeBounds(const std::span<const Vertex>& vertices)
+	{
+		bounds = {};
+		sphere = {};
+		for (const auto& vertex : vertices)
+			bounds.expand(vertex.position);
+
+		if (bounds.isEmpty())
+			return;
+
+		float max_distance2 = 0.f;
+		sphere.center       = bounds.getCenter();
+		for (const auto& vertex : vertices)
+			max_distance2 = std::max(max_distance2, glm::dot(vertex.position - sphere.center, vertex.position - sphere.center));
+
+		sphere.radius = std::sqrt(max_distance2);
 	}
 
 	GpuMesh RenderContext_T::getMesh(MeshPrimitive primitive)
 	{
-		return make_handle(meshes, (size_t)primitive);
+		DEBUG_ASSERT(defaultMeshesBuilt, "Primitive meshes are built with the default resources.");
+		return primitiveMeshes[static_cast<size_t>(primitive)];
 	}
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <lunar/render/render_queue.hpp>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace lunar::Render::imp
+{
+	/* Non-negative floats keep their order when compared as integers; the top 24 bits suffice. */
+	uint64_t MakeSortKey(RenderPass pass, uint32_t program, uint32_t material, uint32_t mesh, float depth)
+	{
+		uint32_t depth_bits = 0;
+		depth = std::max(depth, 0.f);
+		std::memcpy(&depth_bits, &depth, sizeof(float));
+
+		return (static_cast<uint64_t>(pass)              << 62)
+			| (static_cast<uint64_t>(program  & 0xFFF)  << 50)
+			| (static_cast<uint64_t>(material & 0xFFF)  << 38)
+			| (static_cast<uint64_t>(mesh     & 0x3FFF) << 24)
+			| (static_cast<uint64_t>(depth_bits >> 8));
+	}
+
+	void RenderQueue::clear()
+	{
+		keys.clear();
+		items.clear();
+	}
+
+	void RenderQueue::reserve(size_t count)
+	{
+		keys.reserve(count);
+		items.reserve(count);
+	}
+
+	size_t RenderQueue::size() const
+	{
+		return keys.size();
+	}
+
+	void RenderQueue::push(uint64_t key, uint32_t item)
+	{
+		keys.push_back(key);
+		items.push_back(item);
+	}
+
+	/* All eight digit histograms are built in a single pass over the keys. */
+	void RenderQueue::sort()
+	{
+		const size_t count = keys.size();
+		if (count < 2)
+			return;
+
+		uint32_t histograms[8][256] = {};
+		for (uint64_t key : keys)
+			for (int digit = 0; digit < 8; digit++)
+				histograms[digit][(key >> (digit * 8)) & 0xFF]++;
+
+		keysScratch.resize(count);
+		itemsScratch.resize(count);
+
+		for (int digit = 0; digit < 8; digit++)
+		{
+			uint32_t* histogram = histograms[digit];
+			const int shift     = digit * 8;
+
+			if (histogram[(keys[0] >> shift) & 0xFF] == count)
+				continue;
+
+			uint32_t offset = 0;
+			for (int bucket = 0; bucket < 256; bucket++)
+				offset += std::exchange(histogram[bucket], offset);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				uint32_t destination = histogram[(keys[i] >> shift) & 0xFF]++;
+				keysScratch[destination]  = keys[i];
+				itemsScratch[destination] = items[i];
+			}
+
+			keys.swap(keysScratch);
+			items.swap(itemsScratch);
+		}
+	}
+
+	std::span<const uint32_t> RenderQueue::getItems() const
+	{
+		return items;
+	}
+
+	std::span<const uint64_t> RenderQueue::getKeys() const
+	{
+		return keys;
+	}
+}
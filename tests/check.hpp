@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+
+/*
+	Minimal checks for the test executables. A failed check reports where it
+	failed and the test keeps going, so one run lists every broken expectation;
+	main() returns CHECK_RESULT() to hand the outcome to ctest.
+*/
+inline int CheckFailures = 0;
+
+#define CHECK(condition)                                                                         \
+	do                                                                                           \
+	{                                                                                            \
+		if (!(condition))                                                                        \
+		{                                                                                        \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			CheckFailures++;                                                                     \
+		}                                                                                        \
+	} while (0)
+
+#define CHECK_RESULT() (CheckFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE)
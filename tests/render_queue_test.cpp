@@ -0,0 +1,137 @@
+#include <lunar/render/render_queue.hpp>
+#include "check.hpp"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace lunar;
+using namespace lunar::Render;
+using namespace lunar::Render::imp;
+
+/* Each field outranks every field after it, whatever their values. */
+static void TestKeyOrder()
+{
+	CHECK(MakeSortKey(RenderPass::eOpaque, 4095, 4095, 16383, 1e30f) < MakeSortKey(RenderPass::eTransparent, 0, 0, 0, 0.f));
+	CHECK(MakeSortKey(RenderPass::eOpaque, 1, 0, 0, 0.f) > MakeSortKey(RenderPass::eOpaque, 0, 4095, 16383, 1e30f));
+	CHECK(MakeSortKey(RenderPass::eOpaque, 0, 1, 0, 0.f) > MakeSortKey(RenderPass::eOpaque, 0, 0, 16383, 1e30f));
+	CHECK(MakeSortKey(RenderPass::eOpaque, 0, 0, 1, 0.f) > MakeSortKey(RenderPass::eOpaque, 0, 0, 0, 1e30f));
+
+	// Front to back, anything behind the camera counts as depth zero
+	CHECK(MakeSortKey(RenderPass::eOpaque, 0, 0, 0, 0.5f) < MakeSortKey(RenderPass::eOpaque, 0, 0, 0, 1.f));
+	CHECK(MakeSortKey(RenderPass::eOpaque, 0, 0, 0, 1.f)  < MakeSortKey(RenderPass::eOpaque, 0, 0, 0, 100.f));
+	CHECK(MakeSortKey(RenderPass::eOpaque, 0, 0, 0, -5.f) == MakeSortKey(RenderPass::eOpaque, 0, 0, 0, 0.f));
+
+	// Wide ids are truncated to their field and never spill into the one above
+	CHECK(MakeSortKey(RenderPass::eOpaque, 0x1001, 0, 0, 0.f) == MakeSortKey(RenderPass::eOpaque, 1, 0, 0, 0.f));
+	CHECK(MakeSortKey(RenderPass::eOpaque, 0, 0, 0x4001, 0.f) == MakeSortKey(RenderPass::eOpaque, 0, 0, 1, 0.f));
+}
+
+/* Sorts the queue and checks it against std::stable_sort of the same pairs. */
+static void CheckSorted(RenderQueue& queue, std::vector<std::pair<uint64_t, uint32_t>> expected)
+{
+	queue.sort();
+	std::stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	auto keys  = queue.getKeys();
+	auto items = queue.getItems();
+	CHECK(keys.size() == expected.size() && items.size() == expected.size());
+	if (keys.size() != expected.size() || items.size() != expected.size())
+		return;
+
+	bool matches = true;
+	for (size_t i = 0; i < expected.size(); i++)
+		matches &= keys[i] == expected[i].first && items[i] == expected[i].second;
+
+	CHECK(matches);
+}
+
+static void TestSort()
+{
+	auto random = std::mt19937_64(1234);
+	auto queue  = RenderQueue();
+	auto pairs  = std::vector<std::pair<uint64_t, uint32_t>>();
+
+	// Full-width keys exercise every digit
+	for (uint32_t i = 0; i < 10000; i++)
+		pairs.emplace_back(random(), i);
+
+	for (auto& [key, item] : pairs)
+		queue.push(key, item);
+
+	CHECK(queue.size() == pairs.size());
+	CheckSorted(queue, pairs);
+
+	// Realistic keys: few passes, programs and materials, so most digits are skipped and keys repeat
+	queue.clear();
+	pairs.clear();
+	CHECK(queue.size() == 0);
+
+	for (uint32_t i = 0; i < 10000; i++)
+	{
+		auto     pass     = random() % 4 == 0 ? RenderPass::eTransparent : RenderPass::eOpaque;
+		uint32_t program  = static_cast<uint32_t>(random() % 3);
+		uint32_t material = static_cast<uint32_t>(random() % 8);
+		uint32_t mesh     = static_cast<uint32_t>(random() % 16);
+		float    depth    = static_cast<float>(random() % 4);
+
+		pairs.emplace_back(MakeSortKey(pass, program, material, mesh, depth), i);
+		queue.push(pairs.back().first, i);
+	}
+
+	CheckSorted(queue, pairs);
+}
+
+/* Equal keys keep their submission order, also when every digit is skipped. */
+static void TestStability()
+{
+	auto queue = RenderQueue();
+	auto pairs = std::vector<std::pair<uint64_t, uint32_t>>();
+
+	for (uint32_t i = 0; i < 100; i++)
+	{
+		pairs.emplace_back(0xABCDull << 40, i);
+		queue.push(pairs.back().first, i);
+	}
+
+	CheckSorted(queue, pairs);
+
+	// Keys differing only in the top and bottom digits
+	queue.clear();
+	pairs.clear();
+	for (uint32_t i = 0; i < 100; i++)
+	{
+		uint64_t key = (static_cast<uint64_t>(i % 3) << 56) | (i % 5);
+		pairs.emplace_back(key, i);
+		queue.push(key, i);
+	}
+
+	CheckSorted(queue, pairs);
+}
+
+static void TestSmallQueues()
+{
+	auto queue = RenderQueue();
+	queue.sort();
+	CHECK(queue.size() == 0);
+	CHECK(queue.getItems().empty());
+
+	queue.push(42, 7);
+	queue.sort();
+	CHECK(queue.getKeys()[0] == 42 && queue.getItems()[0] == 7);
+
+	queue.push(1, 8);
+	queue.sort();
+	CHECK(queue.getKeys()[0] == 1 && queue.getItems()[0] == 8);
+	CHECK(queue.getKeys()[1] == 42 && queue.getItems()[1] == 7);
+}
+
+int main()
+{
+	TestKeyOrder();
+	TestSort();
+	TestStability();
+	TestSmallQueues();
+	return CHECK_RESULT();
+}
@@ -0,0 +1,153 @@
+#include <lunar/core/scene.hpp>
+#include "check.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace lunar;
+
+/* Counts live instances, so the components of deleted objects can be seen going away. */
+struct Marker : Component_T
+{
+	static inline int Alive = 0;
+
+	Marker()  noexcept { Alive++; }
+	~Marker() noexcept { Alive--; }
+};
+
+static vector<GameObject> MakeFamily(Scene& scene, GameObject parent, int children)
+{
+	auto family = vector<GameObject>();
+	for (int i = 0; i < children; i++)
+	{
+		auto child = scene.createGameObject("child" + std::to_string(i), parent.pointer());
+		child->addComponent<Marker>();
+		family.push_back(child);
+		family.push_back(scene.createGameObject("grandchild" + std::to_string(i), child.pointer()));
+	}
+	return family;
+}
+
+/* Deleting while iterating the hierarchy must neither skip nor revisit anything. */
+static void TestDeleteWhileIterating()
+{
+	auto scene   = Scene("deletion");
+	auto parent  = scene.createGameObject("parent");
+	auto family  = MakeFamily(scene, parent, 5);
+	auto deleted = std::vector<std::string>();
+	auto count   = scene.getGameObjects().size();
+
+	scene.addEventListener<Events::SceneObjectDeleted>([&](Events::SceneObjectDeleted& e) {
+		deleted.push_back(std::string(e.gameObject->getName()));
+	});
+
+	int visited = 0;
+	for (auto& c : parent->getChildren())
+	{
+		scene.deleteGameObject(c.getHandle());
+		visited++;
+	}
+
+	CHECK(visited == 5);
+	CHECK(deleted.size() == 10);
+	CHECK(!parent->isPendingDelete());
+
+	// Until the flush, deleted objects are still there, only marked
+	for (auto& object : family)
+	{
+		CHECK(object.valid());
+		CHECK(object->isPendingDelete());
+	}
+	CHECK(parent->getChildCount() == 5);
+	CHECK(scene.getGameObjects().size() == count);
+	CHECK(scene.getGameObject("child0") == nullptr);
+
+	// Deleting again is a no-op
+	scene.deleteGameObject(family[0]);
+	CHECK(deleted.size() == 10);
+
+	scene.flushDeletions();
+
+	for (auto& object : family)
+		CHECK(!object.valid());
+
+	CHECK(parent.valid());
+	CHECK(parent->getChildCount() == 0);
+	CHECK(scene.getGameObjects().size() == count - family.size());
+	CHECK(Marker::Alive == 0);
+}
+
+static void TestDeleteSubtree()
+{
+	auto scene  = Scene("subtree");
+	auto root   = scene.createGameObject("root");
+	auto family = MakeFamily(scene, root, 3);
+	auto other  = scene.createGameObject("other");
+	int  events = 0;
+
+	scene.addEventListener<Events::SceneObjectDeleted>([&](Events::SceneObjectDeleted&) { events++; });
+
+	scene.deleteGameObject(root);
+	CHECK(events == 7);
+
+	// A child attached after its parent was marked goes down with it
+	auto late = scene.createGameObject("late", root.pointer());
+	scene.flushDeletions();
+
+	CHECK(events == 8);
+	CHECK(!root.valid());
+	CHECK(!late.valid());
+	for (auto& object : family)
+		CHECK(!object.valid());
+
+	CHECK(other.valid());
+	CHECK(scene.getGameObjects().size() == 1);
+	CHECK(Marker::Alive == 0);
+}
+
+/* Freed slots are reused, but handles to the deleted objects never see the new ones. */
+static void TestSlotReuse()
+{
+	auto scene = Scene("reuse");
+	auto first = scene.createGameObject("first");
+	auto slot  = first.getId().index;
+
+	scene.deleteGameObject(first);
+	scene.flushDeletions();
+
+	auto second = scene.createGameObject("second");
+	CHECK(second.getId().index == slot);
+	CHECK(!first.valid());
+	CHECK(second.valid());
+	CHECK(scene.getGameObject("second") == second);
+	CHECK(scene.getGameObject("first") == nullptr);
+}
+
+/* Spawning and despawning many objects per frame keeps the storage bounded. */
+static void TestChurn()
+{
+	auto scene = Scene("churn");
+	for (int frame = 0; frame < 100; frame++)
+	{
+		auto spawned = vector<GameObject>();
+		for (int i = 0; i < 100; i++)
+			spawned.push_back(scene.createGameObject("bullet"));
+
+		for (auto& object : spawned)
+			scene.deleteGameObject(object);
+
+		scene.flushDeletions();
+	}
+
+	CHECK(scene.getGameObjects().empty());
+	CHECK(scene.getGameObjects().slotCount() == 100);
+}
+
+int main()
+{
+	TestDeleteWhileIterating();
+	TestDeleteSubtree();
+	TestSlotReuse();
+	TestChurn();
+	return CHECK_RESULT();
+}
@@ -0,0 +1,133 @@
+#include <lunar/core/scene.hpp>
+#include "check.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace lunar;
+
+static Fs::Path WriteFile(const std::string& name, const std::string& contents)
+{
+	auto path = std::filesystem::temp_directory_path() / name;
+	auto file = std::ofstream(path, std::ios::trunc);
+	file << contents;
+	return path;
+}
+
+static const char* FIRST_VERSION = R"({
+	"name": "Level",
+	"gameObjects": [
+		{ "name": "player", "id": "player", "transform": { "position": [0, 0, 0] } },
+		{ "name": "crate", "transform": { "position": [1, 0, 0] }, "children": [ { "name": "lid" } ] },
+		{ "name": "crate", "transform": { "position": [2, 0, 0] } },
+		{ "name": "doomed" }
+	]
+})";
+
+/* The player moves under the first crate and changes position, "doomed" goes, "spawned" is new. */
+static const char* SECOND_VERSION = R"({
+	"name": "Level",
+	"gameObjects": [
+		{ "name": "crate", "transform": { "position": [1, 0, 0] }, "children": [
+			{ "name": "lid" },
+			{ "name": "player", "id": "player", "transform": { "position": [0, 5, 0] } }
+		] },
+		{ "name": "crate", "transform": { "position": [2, 0, 0] } },
+		{ "name": "spawned" }
+	]
+})";
+
+static void TestIncrementalReload()
+{
+	auto scene  = Scene();
+	auto loader = SceneLoader();
+	auto path   = WriteFile("lunar_reload_test.json", FIRST_VERSION);
+
+	loader.destination(scene).reloadFile(path);
+	CHECK(scene.getName() == "Level");
+	CHECK(scene.getGameObjects().size() == 5);
+
+	auto player = scene.getGameObject("player");
+	auto lid    = scene.getGameObject("lid");
+	auto doomed = scene.getGameObject("doomed");
+	auto crates = scene.getGameObjectsByPrefix("crate");
+	CHECK(player.valid() && lid.valid() && doomed.valid());
+	CHECK(crates.size() == 2);
+	if (crates.size() != 2)
+		return;
+
+	// Same name under the same parent, told apart by their sibling index
+	CHECK(crates[0]->getStableId() != crates[1]->getStableId());
+
+	auto first_crate  = lid->getParent();
+	auto second_crate = crates[0] == first_crate ? crates[1] : crates[0];
+	auto crate_ids    = std::pair(first_crate->getStableId(), second_crate->getStableId());
+	auto lid_id       = lid->getStableId();
+	auto player_id    = player->getStableId();
+
+	WriteFile("lunar_reload_test.json", SECOND_VERSION);
+	loader.reloadFile(path);
+	scene.flushDeletions();
+
+	// Matched objects are updated in place, so every handle to them stays valid
+	CHECK(player.valid() && lid.valid() && first_crate.valid() && second_crate.valid());
+	CHECK(player->getStableId() == player_id);
+	CHECK(lid->getStableId() == lid_id);
+	CHECK(first_crate->getStableId() == crate_ids.first);
+	CHECK(second_crate->getStableId() == crate_ids.second);
+	CHECK(second_crate->getTransform().position == glm::vec3(2, 0, 0));
+
+	// An explicit id follows the object across the hierarchy
+	CHECK(player->getParent() == first_crate);
+	CHECK(player->getTransform().position == glm::vec3(0, 5, 0));
+
+	CHECK(!doomed.valid());
+	CHECK(scene.getGameObject("spawned").valid());
+	CHECK(scene.getGameObjects().size() == 5);
+
+	// Reloading an unchanged file changes nothing
+	auto spawned = scene.getGameObject("spawned");
+	loader.reloadFile(path);
+	scene.flushDeletions();
+	CHECK(spawned.valid() && player.valid());
+	CHECK(scene.getGameObjects().size() == 5);
+
+	std::filesystem::remove(path);
+}
+
+/* A binary file written from a loaded scene keeps the ids the objects were loaded with. */
+static void TestWrittenIds()
+{
+	auto scene  = Scene();
+	auto loader = SceneLoader();
+	auto json   = WriteFile("lunar_reload_ids.json", FIRST_VERSION);
+	auto binary = std::filesystem::temp_directory_path() / "lunar_reload_ids.lscene";
+
+	loader.destination(scene).reloadFile(json);
+	CHECK(SceneWriter().fromScene(scene).toFile(binary));
+
+	auto copy        = Scene();
+	auto copy_loader = SceneLoader();
+	copy_loader.destination(copy).reloadFile(binary);
+	CHECK(copy.getGameObjects().size() == scene.getGameObjects().size());
+
+	for (auto& object : scene.getGameObjects())
+	{
+		bool found = false;
+		for (auto& other : copy.getGameObjects())
+			found |= other.getStableId() == object.getStableId() && other.getName() == object.getName();
+
+		CHECK(found);
+	}
+
+	std::filesystem::remove(json);
+	std::filesystem::remove(binary);
+}
+
+int main()
+{
+	TestIncrementalReload();
+	TestWrittenIds();
+	return CHECK_RESULT();
+}
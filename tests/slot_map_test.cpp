@@ -0,0 +1,200 @@
+#include <lunar/utils/slot_map.hpp>
+#include <lunar/core/handle.hpp>
+#include "check.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace lunar;
+
+/* Counts live instances, so erase() and clear() can be seen destroying values. */
+struct Tracked
+{
+	static inline int Alive = 0;
+
+	int value = 0;
+
+	Tracked(int value) noexcept : value(value) { Alive++; }
+	Tracked(const Tracked& other) noexcept : value(other.value) { Alive++; }
+	~Tracked() noexcept { Alive--; }
+};
+
+static void TestInsertAndErase()
+{
+	auto map = SlotMap<std::string>();
+	auto a   = map.emplace("a");
+	auto b   = map.emplace("b");
+	auto c   = map.insert("c");
+
+	CHECK(map.size() == 3);
+	CHECK(map.contains(a) && map.contains(b) && map.contains(c));
+	CHECK(map[a] == "a" && map[b] == "b" && map[c] == "c");
+
+	map.erase(b);
+	CHECK(map.size() == 2);
+	CHECK(!map.contains(b));
+	CHECK(map.find(b) == nullptr);
+
+	// Erasing never moves the other elements
+	CHECK(map[a] == "a" && map[c] == "c");
+}
+
+static void TestStaleIds()
+{
+	auto map = SlotMap<std::string>();
+	auto a   = map.emplace("a");
+	map.erase(a);
+
+	// The freed slot is reused, but under a new generation
+	auto b = map.emplace("b");
+	CHECK(b.index == a.index);
+	CHECK(b.generation != a.generation);
+	CHECK(!map.contains(a));
+	CHECK(map.find(a) == nullptr);
+	CHECK(map.contains(b) && map[b] == "b");
+
+	CHECK(!map.contains(SlotId{}));
+	CHECK(SlotId{}.isNull());
+}
+
+static void TestIteration()
+{
+	auto map = SlotMap<int>();
+	auto ids = std::vector<SlotId>();
+	for (int i = 0; i < 10; i++)
+		ids.push_back(map.emplace(i));
+
+	for (int i = 0; i < 10; i += 2)
+		map.erase(ids[i]);
+
+	auto values = std::vector<int>(map.begin(), map.end());
+	CHECK((values == std::vector<int>{ 1, 3, 5, 7, 9 }));
+
+	const auto& view = map;
+	CHECK(std::distance(view.begin(), view.end()) == 5);
+	CHECK(map.slotCount() == 10);
+}
+
+static void TestLifetimes()
+{
+	{
+		auto map = SlotMap<Tracked>();
+		auto a   = map.emplace(1);
+		map.emplace(2);
+		map.emplace(3);
+		CHECK(Tracked::Alive == 3);
+
+		map.erase(a);
+		CHECK(Tracked::Alive == 2);
+
+		map.clear();
+		CHECK(Tracked::Alive == 0);
+		CHECK(map.empty());
+
+		map.emplace(4);
+	}
+
+	CHECK(Tracked::Alive == 0);
+}
+
+static void TestHandles()
+{
+	auto first  = SlotMap<std::string>();
+	auto second = SlotMap<std::string>();
+	auto a      = first.emplace("first");
+	auto b      = second.emplace("second");
+
+	// Both maps hand out slot 0, the map tag tells their ids apart
+	CHECK(a.index == b.index);
+	CHECK(a.map != b.map);
+	CHECK(!first.contains(b) && !second.contains(a));
+	CHECK(SlotMap<std::string>::FromId(a) == &first);
+	CHECK(SlotMap<std::string>::FromId(b) == &second);
+
+	auto handle = Handle<std::string>(first, a);
+	CHECK(handle.valid());
+	CHECK(handle.get() == "first");
+	CHECK(handle.pointer() == first.find(a));
+
+	first.erase(a);
+	CHECK(!handle.valid());
+	CHECK(handle.pointer() == nullptr);
+
+	// A new element in the same slot does not revive the old handle
+	auto c = first.emplace("third");
+	CHECK(c.index == a.index);
+	CHECK(!handle.valid());
+	CHECK(Handle<std::string>(first, c).valid());
+
+	CHECK(Handle<std::string>(nullptr) == nullptr);
+	CHECK(!Handle<std::string>(nullptr).valid());
+}
+
+static void TestDestroyedMap()
+{
+	auto handle = Handle<std::string>(nullptr);
+	{
+		auto map = SlotMap<std::string>();
+		handle   = Handle<std::string>(map, map.emplace("gone"));
+		CHECK(handle.valid());
+	}
+
+	// Handles into a destroyed map turn invalid rather than dangling
+	CHECK(!handle.valid());
+	CHECK(handle.pointer() == nullptr);
+}
+
+/* A map created after another one was destroyed may get its tag, but never its ids. */
+static void TestReusedTag()
+{
+	auto handle = Handle<std::string>(nullptr);
+	auto id     = SlotId();
+	{
+		auto map = SlotMap<std::string>();
+		id       = map.emplace("old scene object");
+		handle   = Handle<std::string>(map, id);
+	}
+
+	auto map = SlotMap<std::string>();
+	auto now = map.emplace("new scene object");
+	CHECK(now.getTag() == id.getTag());
+	CHECK(now.index == id.index && now.generation == id.generation);
+	CHECK(now.map != id.map);
+
+	CHECK(!map.contains(id));
+	CHECK(SlotMap<std::string>::FromId(id) == nullptr);
+	CHECK(!handle.valid());
+	CHECK(handle.pointer() == nullptr);
+	CHECK(Handle<std::string>(map, now).valid());
+}
+
+/* Generations use all 32 bits: a constantly reused slot must not wrap early. */
+static void TestGenerationRange()
+{
+	auto map   = SlotMap<int>();
+	auto first = map.emplace(0);
+	auto id    = first;
+	for (uint32_t i = 0; i < (1u << 24); i++)
+	{
+		map.erase(id);
+		id = map.emplace(0);
+	}
+
+	CHECK(id.index == first.index);
+	CHECK(id.generation == (1u << 24));
+	CHECK(!map.contains(first));
+}
+
+int main()
+{
+	TestInsertAndErase();
+	TestStaleIds();
+	TestIteration();
+	TestLifetimes();
+	TestHandles();
+	TestDestroyedMap();
+	TestReusedTag();
+	TestGenerationRange();
+	return CHECK_RESULT();
+}
@@ -0,0 +1,270 @@
+#include <lunar/core/spatial_index.hpp>
+#include "check.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace lunar;
+
+/* Boxes of 0.1 to 2 units scattered in a 100 unit cube, with a fixed seed. */
+struct Scatter
+{
+	std::mt19937 random = std::mt19937(1234);
+
+	float range(float low, float high) { return std::uniform_real_distribution<float>(low, high)(random); }
+
+	glm::vec3 point()
+	{
+		return glm::vec3(range(-50.f, 50.f), range(-50.f, 50.f), range(-50.f, 50.f));
+	}
+
+	Aabb box()
+	{
+		glm::vec3 min = point();
+		return Aabb{ min, min + glm::vec3(range(0.1f, 2.f), range(0.1f, 2.f), range(0.1f, 2.f)) };
+	}
+};
+
+/* The tree next to the proxies it handed out, indexed by user value. */
+struct Fixture
+{
+	DynamicAabbTree  tree    = DynamicAabbTree();
+	vector<uint32_t> proxies = {};
+	vector<bool>     live    = {};
+
+	Fixture(Scatter& scatter, uint32_t count)
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			proxies.push_back(tree.insert(scatter.box(), i));
+			live.push_back(true);
+		}
+	}
+
+	template<typename F>
+	std::vector<uint32_t> bruteForce(F&& predicate) const
+	{
+		auto result = std::vector<uint32_t>();
+		for (uint32_t i = 0; i < proxies.size(); i++)
+			if (live[i] && predicate(tree.getFatBounds(proxies[i])))
+				result.push_back(i);
+
+		return result;
+	}
+
+	std::vector<uint32_t> overlapping(const Aabb& box) const
+	{
+		auto result = std::vector<uint32_t>();
+		tree.queryOverlap(box, [&](uint32_t user) { result.push_back(user); return true; });
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+};
+
+static void TestOverlap()
+{
+	auto scatter = Scatter();
+	auto fixture = Fixture(scatter, 2000);
+	CHECK(fixture.tree.size() == 2000);
+
+	for (int i = 0; i < 200; i++)
+	{
+		Aabb query = scatter.box();
+		query.max += glm::vec3(scatter.range(0.f, 20.f));
+
+		auto expected = fixture.bruteForce([&](const Aabb& box) { return box.overlaps(query); });
+		CHECK(fixture.overlapping(query) == expected);
+	}
+
+	// Returning false stops the query
+	int calls = 0;
+	fixture.tree.queryOverlap(Aabb{ glm::vec3(-100.f), glm::vec3(100.f) }, [&](uint32_t) { calls++; return false; });
+	CHECK(calls == 1);
+}
+
+/* The AVL rotations keep the height logarithmic, even for sorted input. */
+static void TestBalance()
+{
+	auto scatter = Scatter();
+	auto fixture = Fixture(scatter, 4096);
+	CHECK(fixture.tree.getHeight() <= 2 * 12);
+
+	auto sorted = DynamicAabbTree();
+	for (uint32_t i = 0; i < 4096; i++)
+		sorted.insert(Aabb{ glm::vec3(float(i), 0.f, 0.f), glm::vec3(float(i) + 0.5f, 1.f, 1.f) }, i);
+
+	CHECK(sorted.getHeight() <= 2 * 12);
+}
+
+static void TestRemoveAndUpdate()
+{
+	auto scatter = Scatter();
+	auto fixture = Fixture(scatter, 1000);
+
+	for (uint32_t i = 0; i < 1000; i += 2)
+	{
+		fixture.tree.remove(fixture.proxies[i]);
+		fixture.live[i] = false;
+	}
+	CHECK(fixture.tree.size() == 500);
+
+	// Small moves stay inside the fat box and leave the tree alone, large ones reinsert
+	uint32_t proxy = fixture.proxies[1];
+	Aabb     fat   = fixture.tree.getFatBounds(proxy);
+	Aabb     moved = Aabb{ fat.min + glm::vec3(0.05f), fat.max - glm::vec3(0.05f) };
+	CHECK(!fixture.tree.update(proxy, moved));
+	CHECK(fixture.tree.getFatBounds(proxy) == fat);
+
+	for (uint32_t i = 1; i < 1000; i += 2)
+		fixture.tree.update(fixture.proxies[i], scatter.box());
+
+	Aabb far = Aabb{ glm::vec3(500.f), glm::vec3(501.f) };
+	CHECK(fixture.tree.update(proxy, far));
+	CHECK(fixture.tree.getUserData(proxy) == 1);
+	CHECK(fixture.overlapping(far) == std::vector<uint32_t>{ 1 });
+
+	for (int i = 0; i < 100; i++)
+	{
+		Aabb query = scatter.box();
+		query.max += glm::vec3(10.f);
+
+		auto expected = fixture.bruteForce([&](const Aabb& box) { return box.overlaps(query); });
+		CHECK(fixture.overlapping(query) == expected);
+	}
+
+	// Freed nodes are reused
+	for (uint32_t i = 0; i < 1000; i += 2)
+	{
+		fixture.proxies[i] = fixture.tree.insert(scatter.box(), i);
+		fixture.live[i]    = true;
+	}
+	CHECK(fixture.tree.size() == 1000);
+
+	fixture.tree.clear();
+	CHECK(fixture.tree.size() == 0);
+	CHECK(fixture.tree.getHeight() == 0);
+	CHECK(fixture.overlapping(Aabb{ glm::vec3(-1000.f), glm::vec3(1000.f) }).empty());
+}
+
+static void TestRaycast()
+{
+	auto scatter = Scatter();
+	auto fixture = Fixture(scatter, 2000);
+
+	for (int i = 0; i < 200; i++)
+	{
+		glm::vec3 origin = scatter.point();
+		glm::vec3 target = scatter.point();
+		Ray       ray    = Ray{ origin, target - origin };
+
+		glm::vec3 inverse_direction = 1.f / ray.direction;
+		float     expected          = 1000.f;
+		for (uint32_t proxy : fixture.proxies)
+		{
+			float distance = IntersectRay(ray, inverse_direction, fixture.tree.getFatBounds(proxy), 1000.f);
+			if (distance >= 0.f)
+				expected = std::min(expected, distance);
+		}
+
+		float closest = 1000.f;
+		fixture.tree.raycast(ray, 1000.f, [&](uint32_t, float distance) { closest = std::min(closest, distance); return closest; });
+		CHECK(closest == expected);
+	}
+}
+
+/* A ray parallel to a slab hits only if its origin lies between the slab's planes. */
+static void TestParallelRay()
+{
+	Aabb box = Aabb{ glm::vec3(2.f), glm::vec3(3.f) };
+
+	Ray above = Ray{ glm::vec3(0.f, 5.f, 2.5f), glm::vec3(1.f, 0.f, 0.f) };
+	CHECK(IntersectRay(above, 1.f / above.direction, box, 100.f) < 0.f);
+
+	Ray through = Ray{ glm::vec3(0.f, 2.5f, 2.5f), glm::vec3(1.f, 0.f, 0.f) };
+	CHECK(IntersectRay(through, 1.f / through.direction, box, 100.f) == 2.f);
+
+	// Grazing a face: 0 * inf must not turn into a NaN miss
+	Ray grazing = Ray{ glm::vec3(0.f, 2.f, 3.f), glm::vec3(1.f, 0.f, 0.f) };
+	CHECK(IntersectRay(grazing, 1.f / grazing.direction, box, 100.f) == 2.f);
+
+	Ray short_ray = Ray{ glm::vec3(0.f, 2.5f, 2.5f), glm::vec3(1.f, 0.f, 0.f) };
+	CHECK(IntersectRay(short_ray, 1.f / short_ray.direction, box, 1.f) < 0.f);
+
+	auto tree = DynamicAabbTree(0.f);
+	tree.insert(box, 7);
+
+	uint32_t hit = UINT32_MAX;
+	tree.raycast(grazing, 100.f, [&](uint32_t user, float distance) { hit = user; return distance; });
+	CHECK(hit == 7);
+}
+
+static void TestNearest()
+{
+	auto scatter = Scatter();
+	auto fixture = Fixture(scatter, 2000);
+	auto nearest = vector<std::pair<uint32_t, float>>();
+
+	for (int i = 0; i < 100; i++)
+	{
+		glm::vec3 point = scatter.point();
+
+		auto expected = std::vector<float>();
+		for (uint32_t proxy : fixture.proxies)
+			expected.push_back(fixture.tree.getFatBounds(proxy).getDistance2(point));
+
+		std::sort(expected.begin(), expected.end());
+		expected.resize(8);
+
+		nearest.clear();
+		fixture.tree.queryNearest(point, 8, nearest);
+		CHECK(nearest.size() == 8);
+		if (nearest.size() != 8)
+			continue;
+
+		// Ties may come in any order, so compare distances rather than ids
+		for (size_t n = 0; n < 8; n++)
+		{
+			CHECK(nearest[n].second == expected[n]);
+			CHECK(nearest[n].second == fixture.tree.getFatBounds(fixture.proxies[nearest[n].first]).getDistance2(point));
+		}
+	}
+
+	nearest.clear();
+	fixture.tree.queryNearest(glm::vec3(0.f), 5000, nearest);
+	CHECK(nearest.size() == 2000);
+}
+
+static void TestFrustumQuery()
+{
+	auto scatter = Scatter();
+	auto fixture = Fixture(scatter, 2000);
+
+	for (int i = 0; i < 50; i++)
+	{
+		glm::mat4 projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, scatter.range(10.f, 100.f));
+		glm::mat4 view       = glm::lookAt(scatter.point(), scatter.point(), glm::vec3(0.f, 1.f, 0.f));
+		Frustum   frustum    = Frustum::FromMatrix(projection * view);
+
+		auto visible = std::vector<uint32_t>();
+		fixture.tree.queryFrustum(frustum, [&](uint32_t user) { visible.push_back(user); return true; });
+		std::sort(visible.begin(), visible.end());
+
+		auto expected = fixture.bruteForce([&](const Aabb& box) { return TestFrustum(frustum, box) != FrustumTest::eOutside; });
+		CHECK(visible == expected);
+	}
+}
+
+int main()
+{
+	TestOverlap();
+	TestBalance();
+	TestRemoveAndUpdate();
+	TestRaycast();
+	TestParallelRay();
+	TestNearest();
+	TestFrustumQuery();
+	return CHECK_RESULT();
+}